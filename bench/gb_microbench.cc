@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+#include "gb_microbench.h"
+#include "gb_json.h"
+
+static volatile uint64_t g_microbench_sink;
+
+gb_microbench::gb_microbench(size_t samples, double min_sample_seconds)
+    : m_benchmarks(), m_samples(std::max(samples, static_cast<size_t>(1))), m_min_sample_seconds(min_sample_seconds)
+{
+}
+
+void gb_microbench::add(const std::string& name, gb_microbench_fn_t fn) {
+    m_benchmarks.push_back({name, fn});
+}
+
+std::vector<gb_microbench::gb_microbench_result_t> gb_microbench::run(const std::string& filter, std::ostream& progress) {
+    std::vector<gb_microbench_result_t> results;
+
+    write_table_header(progress);
+
+    for (const gb_microbench_entry_t& benchmark : m_benchmarks) {
+        if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) continue;
+
+        // Double the iterations until a sample is long enough for the clock's resolution not to matter
+        // This also warms up the caches and branch predictors before the real samples are taken
+        uint64_t iterations = 1;
+        while (_time(benchmark.fn, iterations) < m_min_sample_seconds && iterations < (1ull << 40)) iterations *= 2;
+
+        std::vector<double> ns_per_op;
+        for (size_t i = 0; i < m_samples; i++) {
+            ns_per_op.push_back(_time(benchmark.fn, iterations) * 1e9 / static_cast<double>(iterations));
+        }
+
+        std::sort(ns_per_op.begin(), ns_per_op.end());
+
+        gb_microbench_result_t result;
+        result.name = benchmark.name;
+        result.iterations = iterations;
+        result.samples = ns_per_op.size();
+        result.ns_min = ns_per_op.front();
+        result.ns_median = (ns_per_op.size() % 2 != 0) ? ns_per_op[ns_per_op.size() / 2]
+                                                        : (ns_per_op[ns_per_op.size() / 2 - 1] + ns_per_op[ns_per_op.size() / 2]) / 2.0;
+        result.ns_mean = std::accumulate(ns_per_op.begin(), ns_per_op.end(), 0.0) / static_cast<double>(ns_per_op.size());
+
+        double variance = 0.0;
+        for (double ns : ns_per_op) variance += (ns - result.ns_mean) * (ns - result.ns_mean);
+        result.ns_stddev = (ns_per_op.size() > 1) ? std::sqrt(variance / static_cast<double>(ns_per_op.size() - 1)) : 0.0;
+
+        write_table_row(progress, result);
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+void gb_microbench::write_table_header(std::ostream& os) {
+    char line[128];
+    snprintf(line, sizeof(line), "%-32s %12s %12s %10s %12s", "benchmark", "median ns/op", "min ns/op", "stddev %", "iterations");
+    os << line << std::endl;
+}
+
+void gb_microbench::write_table_row(std::ostream& os, const gb_microbench_result_t& result) {
+    char line[128];
+    double stddev_percent = (result.ns_mean > 0.0) ? 100.0 * result.ns_stddev / result.ns_mean : 0.0;
+    snprintf(line, sizeof(line), "%-32s %12.2f %12.2f %10.1f %12llu", result.name.c_str(), result.ns_median, result.ns_min,
+             stddev_percent, static_cast<unsigned long long>(result.iterations));
+    os << line << std::endl;
+}
+
+void gb_microbench::write_json(std::ostream& os, const std::vector<gb_microbench_result_t>& results) {
+    os << "[" << std::endl;
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const gb_microbench_result_t& result = results[i];
+        os << "  {\"name\": \"" << gb_json::escape(result.name) << "\""
+           << ", \"iterations\": " << result.iterations
+           << ", \"samples\": " << result.samples
+           << ", \"ns_min\": " << result.ns_min
+           << ", \"ns_median\": " << result.ns_median
+           << ", \"ns_mean\": " << result.ns_mean
+           << ", \"ns_stddev\": " << result.ns_stddev
+           << "}" << ((i + 1 < results.size()) ? "," : "") << std::endl;
+    }
+
+    os << "]" << std::endl;
+}
+
+void gb_microbench::do_not_optimize(uint64_t val) {
+    g_microbench_sink = val;
+}
+
+double gb_microbench::_time(const gb_microbench_fn_t& fn, uint64_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    fn(iterations);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_MICROBENCH_H_
+#define GB_MICROBENCH_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+
+// A minimal benchmark harness. Each benchmark is a function that runs its operation a given number of times
+// The iteration count is calibrated so one sample takes at least the minimum sample time, then the benchmark is
+// sampled repeatedly and the ns/op of each sample is summarized
+class gb_microbench {
+public:
+    using gb_microbench_fn_t = std::function<void(uint64_t iterations)>;
+
+    struct gb_microbench_result_t {
+        std::string name;
+        uint64_t    iterations; // Per sample
+        size_t      samples;
+        double      ns_min;
+        double      ns_median;
+        double      ns_mean;
+        double      ns_stddev;
+    };
+
+    gb_microbench(size_t samples, double min_sample_seconds);
+
+    // Benchmarks are run in the order they're added
+    void add(const std::string& name, gb_microbench_fn_t fn);
+
+    // Run every benchmark whose name contains the filter (all of them if it's empty)
+    // Results are printed to the progress stream as each benchmark finishes
+    std::vector<gb_microbench_result_t> run(const std::string& filter, std::ostream& progress);
+
+    static void write_table_header(std::ostream& os);
+    static void write_table_row(std::ostream& os, const gb_microbench_result_t& result);
+    static void write_json(std::ostream& os, const std::vector<gb_microbench_result_t>& results);
+
+    // Keep the compiler from optimizing away a value computed by a benchmark
+    static void do_not_optimize(uint64_t val);
+
+private:
+    struct gb_microbench_entry_t {
+        std::string        name;
+        gb_microbench_fn_t fn;
+    };
+
+    std::vector<gb_microbench_entry_t> m_benchmarks;
+    size_t                             m_samples;
+    double                             m_min_sample_seconds;
+
+    double _time(const gb_microbench_fn_t& fn, uint64_t iterations);
+};
+
+#endif // GB_MICROBENCH_H_
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <random>
+#include <stdexcept>
+
+#include "gb_microbench_fixture.h"
+#include "gb_null_renderer.h"
+#include "gb_io_defs.h"
+
+#define GB_MICROBENCH_ROM_SIZE   (0x10000)
+#define GB_MICROBENCH_CODE_ADDR  (0x0150)
+#define GB_MICROBENCH_BANK0_END  (0x3FF0)
+
+// LD SP,0xDFF0; LD HL,0xC000; LD A,0x0A; LD (0x0000),A (enable cartridge RAM)
+static const std::vector<uint8_t> g_microbench_setup = {0x31, 0xF0, 0xDF, 0x21, 0x00, 0xC0, 0x3E, 0x0A, 0xEA, 0x00, 0x00};
+
+static std::vector<uint8_t> _make_rom(const std::vector<uint8_t>& body) {
+    std::vector<uint8_t> rom (GB_MICROBENCH_ROM_SIZE, 0);
+
+    // JP 0x0150 at the entry point, then the header: MBC1+RAM+BATTERY, 64KB ROM, 8KB RAM
+    rom[0x100] = 0x00;
+    rom[0x101] = 0xC3;
+    rom[0x102] = GB_MICROBENCH_CODE_ADDR & 0xFF;
+    rom[0x103] = GB_MICROBENCH_CODE_ADDR >> 8;
+    const char title[] = "MICROBENCH";
+    std::copy(title, title + sizeof(title) - 1, rom.begin() + 0x134);
+    rom[0x147] = 0x03;
+    rom[0x148] = 0x01;
+    rom[0x149] = 0x02;
+
+    size_t addr = GB_MICROBENCH_CODE_ADDR;
+    std::copy(g_microbench_setup.begin(), g_microbench_setup.end(), rom.begin() + static_cast<long>(addr));
+    addr += g_microbench_setup.size();
+
+    size_t body_addr = addr;
+    while (addr + body.size() <= GB_MICROBENCH_BANK0_END) {
+        std::copy(body.begin(), body.end(), rom.begin() + static_cast<long>(addr));
+        addr += body.size();
+    }
+
+    // JP back to the first copy of the body
+    rom[addr] = 0xC3;
+    rom[addr + 1] = static_cast<uint8_t>(body_addr & 0xFF);
+    rom[addr + 2] = static_cast<uint8_t>(body_addr >> 8);
+
+    rom[GB_MICROBENCH_SUBROUTINE_ADDR] = 0xC9;
+
+    // Fill the switchable banks with something other than zeros so reads from them aren't all the same
+    for (size_t i = 0x4000; i < rom.size(); i++) rom[i] = static_cast<uint8_t>(i * 7);
+
+    return rom;
+}
+
+gb_microbench_fixture::gb_microbench_fixture(const std::vector<uint8_t>& body)
+    : gb_emulator(std::make_shared<gb_null_renderer>()), m_regs()
+{
+    if (body.empty() || body.size() > GB_MICROBENCH_BANK0_END - GB_MICROBENCH_CODE_ADDR - g_microbench_setup.size()) {
+        throw std::invalid_argument("gb_microbench_fixture::gb_microbench_fixture() - Invalid body size");
+    }
+
+    m_logger.set_level(GB_LOG_FATAL);
+    set_serial_echo(false);
+
+    std::vector<uint8_t> rom = _make_rom(body);
+    load_rom(rom.data(), rom.size());
+    boot(false);
+
+    // Run the setup code
+    while (m_cpu.get_pc() < GB_MICROBENCH_CODE_ADDR + g_microbench_setup.size()) m_cpu.step();
+}
+
+void gb_microbench_fixture::setup_ppu(uint32_t seed) {
+    std::mt19937 rng (seed);
+
+    // Turn the LCD off while VRAM is filled so nothing is rendered
+    write_byte(GB_LCDC_ADDR, 0x00);
+
+    for (uint16_t addr = GB_VIDEO_RAM_ADDR; addr < 0x9800; addr++) write_byte(addr, static_cast<uint8_t>(rng()));
+    for (uint16_t addr = 0x9800; addr < 0xA000; addr++) write_byte(addr, static_cast<uint8_t>(rng() % 0x80));
+
+    // 40 sprites spread over the screen so most lines have a few of them. Y and X are offset by 16 and 8
+    for (uint16_t i = 0; i < 40; i++) {
+        uint16_t entry = static_cast<uint16_t>(GB_PPU_OAM_ADDR + i * 4);
+        write_byte(entry, static_cast<uint8_t>(16 + rng() % 144));
+        write_byte(static_cast<uint16_t>(entry + 1), static_cast<uint8_t>(8 + rng() % 160));
+        write_byte(static_cast<uint16_t>(entry + 2), static_cast<uint8_t>(rng()));
+        write_byte(static_cast<uint16_t>(entry + 3), static_cast<uint8_t>(rng() & 0xF0));
+    }
+
+    write_byte(GB_PPU_BG_SCROLL_Y_ADDR, 5);
+    write_byte(GB_PPU_BG_SCROLL_X_ADDR, 3);
+    write_byte(GB_PPU_BGP_ADDR, 0xE4);
+    write_byte(GB_PPU_OBP0_ADDR, 0xD2);
+    write_byte(GB_PPU_OBP1_ADDR, 0x1B);
+    write_byte(GB_PPU_WIN_SCROLL_Y_ADDR, 72);
+    write_byte(GB_PPU_WIN_SCROLL_X_ADDR, 7 + 80);
+
+    // LCD on, window map at 0x9C00, window on, tile data at 0x8000, BG map at 0x9800, 8x16 sprites, sprites on, BG on
+    write_byte(GB_LCDC_ADDR, 0xF7);
+
+    m_regs = m_ppu->_get_registers();
+}
+
+void gb_microbench_fixture::run_frame_uncached() {
+    for (int cycles = 0; cycles < 70224; ) {
+        m_ppu->invalidate_tiles();
+        cycles += step(1);
+    }
+
+    m_ppu->flush();
+}
+
+void gb_microbench_fixture::draw_line(uint8_t ly) {
+    m_ppu->m_next_line = ly;
+    m_ppu->m_last_ly = ly;
+    m_ppu->_catch_up();
+}
+
+void gb_microbench_fixture::draw_background(uint8_t ly) {
+    m_ppu->_draw_background(m_regs, m_ppu->get_mem(), ly);
+}
+
+void gb_microbench_fixture::draw_window(uint8_t ly) {
+    m_ppu->_draw_window(m_regs, m_ppu->get_mem(), ly);
+}
+
+void gb_microbench_fixture::draw_sprites(uint8_t ly) {
+    m_ppu->m_line_sprite.fill(0);
+    m_ppu->_draw_sprites(m_regs, m_ppu->m_ppu_oam->get_mem(), ly);
+}
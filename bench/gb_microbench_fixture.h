@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_MICROBENCH_FIXTURE_H_
+#define GB_MICROBENCH_FIXTURE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "gb_emulator.h"
+
+// An emulator running a synthetic cartridge (MBC1, 64KB ROM, 8KB RAM) built in memory, with the internals exposed
+// so individual hot paths can be timed in isolation. Nothing is presented and the serial port isn't echoed
+class gb_microbench_fixture : public gb_emulator {
+public:
+    // The program at 0x0150 enables cartridge RAM, points SP at work RAM and HL at 0xC000 and then runs body repeated
+    // back to back until the end of bank 0, where it jumps back to the first copy. A RET is placed at
+    // GB_MICROBENCH_SUBROUTINE_ADDR for bodies that call it. The CPU is stepped up to the first copy of the body
+    gb_microbench_fixture(const std::vector<uint8_t>& body = {0x18, 0xFE});
+
+    uint8_t read_byte(uint16_t addr) {
+        return m_memory_map.read_byte(addr);
+    }
+
+    void write_byte(uint16_t addr, uint8_t val) {
+        m_memory_map.write_byte(addr, val);
+    }
+
+    int step_cpu() {
+        return m_cpu.step();
+    }
+
+    void update_interrupts(int cycles) {
+        m_interrupt_controller.update(cycles);
+    }
+
+    bool update_dma(int cycles) {
+        return m_dma->update(cycles);
+    }
+
+    gb_input& get_input() {
+        return m_renderer->get_input();
+    }
+
+    gb_framebuffer& get_framebuffer() {
+        return m_renderer->get_framebuffer();
+    }
+
+    size_t get_memory_size() const {
+        return m_memory_manager.get_size();
+    }
+
+    // Render the background with the palette implementation for simd_level instead of the best one for the host
+    void set_simd_level(gb_ppu_simd::gb_simd_level_t simd_level) {
+        m_ppu->m_apply_palette = gb_ppu_simd::get_apply_palette(simd_level);
+    }
+
+    // Fill VRAM with random tiles and maps and OAM with random sprites, and turn on the background, window and sprites
+    // The window covers the bottom right quarter of the screen
+    void setup_ppu(uint32_t seed);
+
+    // Run a frame like run_frames(1) but with the tile cache dropped before every instruction, so every tile is decoded
+    // from VRAM as it's drawn
+    void run_frame_uncached();
+
+    // Draw a single scanline, or a single layer of it, with the registers as they were when setup_ppu was called
+    void draw_line(uint8_t ly);
+    void draw_background(uint8_t ly);
+    void draw_window(uint8_t ly);
+    void draw_sprites(uint8_t ly);
+
+private:
+    gb_ppu::gb_ppu_registers_t m_regs;
+};
+
+#define GB_MICROBENCH_SUBROUTINE_ADDR (0x3FF8)
+
+#endif // GB_MICROBENCH_FIXTURE_H_
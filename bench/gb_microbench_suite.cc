@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <memory>
+
+#include "gb_microbench_suite.h"
+#include "gb_microbench_fixture.h"
+#include "gb_io_defs.h"
+
+using gb_microbench_fixture_ptr = std::shared_ptr<gb_microbench_fixture>;
+
+// Reads and writes cycle through the region so they don't all hit the same byte
+struct gb_microbench_region_t {
+    const char* name;
+    uint16_t    start_addr;
+    uint16_t    mask;
+};
+
+static const gb_microbench_region_t g_read_regions[] = {
+    {"rom0", 0x0000, 0x3FFF},
+    {"romx", 0x4000, 0x3FFF},
+    {"vram", 0x8000, 0x1FFF},
+    {"eram", 0xA000, 0x1FFF},
+    {"wram", 0xC000, 0x1FFF},
+    {"oam",  0xFE00, 0x007F},
+    {"io",   0xFF40, 0x0007},
+    {"hram", 0xFF80, 0x003F}
+};
+
+// Writes to the ROM go to the MBC, cycling through the ROM bank register values
+static const gb_microbench_region_t g_write_regions[] = {
+    {"mbc",  0x2000, 0x0003},
+    {"vram", 0x8000, 0x1FFF},
+    {"eram", 0xA000, 0x1FFF},
+    {"wram", 0xC000, 0x1FFF},
+    {"oam",  0xFE00, 0x007F},
+    {"io",   0xFF42, 0x0001},
+    {"hram", 0xFF80, 0x003F}
+};
+
+struct gb_microbench_opcodes_t {
+    const char*          name;
+    std::vector<uint8_t> body;
+};
+
+// One benchmark per class of instruction, the body is repeated to fill bank 0 so nearly every step is one of these
+// HL points at work RAM. LD B,B isn't used since it's commonly treated as a debug breakpoint
+static const gb_microbench_opcodes_t g_opcode_classes[] = {
+    {"nop",       {0x00}},
+    {"ld_r_r",    {0x41, 0x4A, 0x53}},
+    {"ld_r_d8",   {0x06, 0x12, 0x0E, 0x34}},
+    {"ld_r_hl",   {0x7E, 0x46}},
+    {"ld_hl_r",   {0x77, 0x70}},
+    {"ldh",       {0xE0, 0x80, 0xF0, 0x81}},
+    {"alu",       {0x80, 0x91, 0xA2, 0xB3, 0xA9, 0xBC}},
+    {"alu_d8",    {0xC6, 0x01, 0xE6, 0x7F, 0xFE, 0x10}},
+    {"inc_dec",   {0x04, 0x0D, 0x03, 0x1B}},
+    {"add16",     {0x09, 0x19, 0x29}},
+    {"jr",        {0x18, 0x00}},
+    {"jr_cc",     {0x20, 0x00, 0x38, 0x00}},
+    {"call_ret",  {0xCD, GB_MICROBENCH_SUBROUTINE_ADDR & 0xFF, GB_MICROBENCH_SUBROUTINE_ADDR >> 8}},
+    {"push_pop",  {0xC5, 0xD5, 0xD1, 0xC1}},
+    {"rotate",    {0x07, 0x17, 0x0F, 0x1F}},
+    {"cb",        {0xCB, 0x11, 0xCB, 0x7F, 0xCB, 0x37, 0xCB, 0xC0}}
+};
+
+static void _add_memory_benchmarks(gb_microbench& bench) {
+    gb_microbench_fixture_ptr fixture = std::make_shared<gb_microbench_fixture>();
+
+    for (const gb_microbench_region_t& region : g_read_regions) {
+        bench.add(std::string("memory_map/read/") + region.name, [fixture, region](uint64_t iterations) {
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < iterations; i++) {
+                sum += fixture->read_byte(static_cast<uint16_t>(region.start_addr + (i & region.mask)));
+            }
+            gb_microbench::do_not_optimize(sum);
+        });
+    }
+
+    for (const gb_microbench_region_t& region : g_write_regions) {
+        bench.add(std::string("memory_map/write/") + region.name, [fixture, region](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                uint16_t offset = static_cast<uint16_t>(i & region.mask);
+                fixture->write_byte(static_cast<uint16_t>(region.start_addr + offset), static_cast<uint8_t>(offset + 1));
+            }
+        });
+    }
+}
+
+static void _add_cpu_benchmarks(gb_microbench& bench) {
+    for (const gb_microbench_opcodes_t& opcodes : g_opcode_classes) {
+        gb_microbench_fixture_ptr fixture = std::make_shared<gb_microbench_fixture>(opcodes.body);
+
+        bench.add(std::string("cpu/step/") + opcodes.name, [fixture](uint64_t iterations) {
+            uint64_t cycles = 0;
+            for (uint64_t i = 0; i < iterations; i++) {
+                cycles += static_cast<uint64_t>(fixture->step_cpu());
+            }
+            gb_microbench::do_not_optimize(cycles);
+        });
+    }
+}
+
+static void _add_ppu_benchmarks(gb_microbench& bench) {
+    gb_microbench_fixture_ptr fixture = std::make_shared<gb_microbench_fixture>();
+    fixture->setup_ppu(1);
+
+    // Every benchmark cycles through all 144 visible lines
+    bench.add("ppu/draw_background", [fixture](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) fixture->draw_background(static_cast<uint8_t>(i % 144));
+    });
+
+    bench.add("ppu/draw_window", [fixture](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) fixture->draw_window(static_cast<uint8_t>(i % 144));
+    });
+
+    bench.add("ppu/draw_sprites", [fixture](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) fixture->draw_sprites(static_cast<uint8_t>(i % 144));
+    });
+
+    bench.add("ppu/draw_line", [fixture](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) fixture->draw_line(static_cast<uint8_t>(i % 144));
+    });
+}
+
+static void _add_device_benchmarks(gb_microbench& bench) {
+    gb_microbench_fixture_ptr fixture = std::make_shared<gb_microbench_fixture>();
+    fixture->setup_ppu(1);
+
+    // 4 cycles is the shortest instruction, which is how often these are called when running
+    bench.add("interrupt_controller/update", [fixture](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) fixture->update_interrupts(4);
+    });
+
+    bench.add("dma/update/idle", [fixture](uint64_t iterations) {
+        uint64_t active = 0;
+        for (uint64_t i = 0; i < iterations; i++) active += fixture->update_dma(4);
+        gb_microbench::do_not_optimize(active);
+    });
+
+    // A transfer takes 160 bytes at 4 cycles each, start a new one from work RAM as soon as the last one is done
+    bench.add("dma/update/active", [fixture](uint64_t iterations) {
+        uint64_t active = 0;
+        for (uint64_t i = 0; i < iterations; i++) {
+            if ((i % 162) == 0) fixture->write_byte(GB_DMA_ADDR, 0xC0);
+            active += fixture->update_dma(4);
+        }
+        gb_microbench::do_not_optimize(active);
+    });
+}
+
+void gb_microbench_suite::add_all(gb_microbench& bench) {
+    _add_memory_benchmarks(bench);
+    _add_cpu_benchmarks(bench);
+    _add_ppu_benchmarks(bench);
+    _add_device_benchmarks(bench);
+}
+
+std::string gb_microbench_suite::get_subsystem(const std::string& name) {
+    return name.substr(0, name.find('/'));
+}
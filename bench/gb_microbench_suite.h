@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_MICROBENCH_SUITE_H_
+#define GB_MICROBENCH_SUITE_H_
+
+#include <string>
+
+#include "gb_microbench.h"
+
+// The emulator's micro-benchmarks, shared by goodboy-microbench and goodboy-perf-gate. Names are
+// <subsystem>/<operation>[/<variant>], i.e. cpu/step/alu or memory_map/read/vram
+namespace gb_microbench_suite {
+    // Add every benchmark, throws if a fixture can't be set up
+    void add_all(gb_microbench& bench);
+
+    // The part of a benchmark's name before the first '/'
+    std::string get_subsystem(const std::string& name);
+}
+
+#endif // GB_MICROBENCH_SUITE_H_
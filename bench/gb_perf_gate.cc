@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "gb_perf_gate.h"
+#include "gb_microbench.h"
+#include "gb_microbench_fixture.h"
+#include "gb_microbench_suite.h"
+#include "gb_input_script.h"
+#include "gb_json.h"
+
+#define GB_PERF_GATE_SCRIPT_FRAMES (64)
+#define GB_PERF_GATE_HOST_RUNS     (5)
+#define GB_PERF_GATE_HOST_LOOPS    (1u << 22)
+
+static volatile uint64_t g_perf_gate_sink;
+
+// Loads, ALU ops, 16-bit ops, the stack, a CALL/RET and HRAM, without touching HL so every write stays in work RAM
+static const std::vector<uint8_t> g_cpu_body = {
+    0x41, 0x4A, 0x80, 0x91, 0xA2, 0xB3, 0x06, 0x12, 0x7E, 0x77, 0x04, 0x0D, 0x03, 0xC5, 0xD1, 0xE0, 0x80, 0xF0, 0x81,
+    0xCB, 0x11, 0xCB, 0x7F, 0x20, 0x00, 0xCD, GB_MICROBENCH_SUBROUTINE_ADDR & 0xFF, GB_MICROBENCH_SUBROUTINE_ADDR >> 8
+};
+
+// Select the directions then the buttons and read them back, like a game's input routine
+static const std::vector<uint8_t> g_joypad_body = {
+    0x3E, 0x20, 0xE0, 0x00, 0xF0, 0x00, 0xF0, 0x00, 0x47, 0x3E, 0x10, 0xE0, 0x00, 0xF0, 0x00, 0xF0, 0x00, 0xA0, 0x4F
+};
+
+// Start an OAM DMA from work RAM then wait out the 640 cycles it takes
+static std::vector<uint8_t> _make_dma_body() {
+    std::vector<uint8_t> body = {0x3E, 0xC0, 0xE0, 0x46};
+    body.insert(body.end(), 160, 0x00);
+    return body;
+}
+
+static const std::vector<gb_perf_gate::gb_workload_t> g_workloads = {
+    {"cpu",    g_cpu_body,      false, ""},
+    {"ppu",    g_cpu_body,      true,  ""},
+    {"joypad", g_joypad_body,   false, "0 -\n8 A\n16 A+RIGHT\n24 START\n32 DOWN+B\n48 -\n"},
+    {"dma",    _make_dma_body(), true,  ""}
+};
+
+const std::vector<gb_perf_gate::gb_workload_t>& gb_perf_gate::get_workloads() {
+    return g_workloads;
+}
+
+static double _median(std::vector<double> vals) {
+    if (vals.empty()) return 0.0;
+
+    std::sort(vals.begin(), vals.end());
+    size_t mid = vals.size() / 2;
+    return (vals.size() % 2 != 0) ? vals[mid] : (vals[mid - 1] + vals[mid]) / 2.0;
+}
+
+double gb_perf_gate::measure_host() {
+    std::vector<uint8_t> table (0x10000);
+    std::vector<double> ns;
+
+    for (unsigned int run = 0; run < GB_PERF_GATE_HOST_RUNS; run++) {
+        auto start = std::chrono::steady_clock::now();
+
+        // An xorshift picks the table entry and which way to branch, close enough to an interpreter's dispatch loop
+        uint32_t x = 2463534242u;
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < GB_PERF_GATE_HOST_LOOPS; i++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+
+            uint8_t& entry = table[x & 0xFFFF];
+            switch (x >> 30) {
+                case 0:  entry = static_cast<uint8_t>(entry + 1); break;
+                case 1:  sum += entry; break;
+                case 2:  entry = static_cast<uint8_t>(entry ^ (x >> 8)); break;
+                default: sum += static_cast<uint64_t>(entry) << 1; break;
+            }
+        }
+        g_perf_gate_sink = sum;
+
+        ns.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    return _median(ns);
+}
+
+double gb_perf_gate::run_workload(const gb_workload_t& workload, uint64_t frames, uint64_t warmup_frames) {
+    gb_microbench_fixture fixture (workload.body);
+    if (workload.ppu) fixture.setup_ppu(1);
+
+    gb_input_script script;
+    script.parse(workload.script, workload.name);
+
+    gb_input& input = fixture.get_input();
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint64_t frame = 0; frame < warmup_frames + frames; frame++) {
+        if (frame == warmup_frames) start = std::chrono::steady_clock::now();
+        if (!script.empty()) input.set_buttons(script.get_buttons(frame % GB_PERF_GATE_SCRIPT_FRAMES));
+        fixture.run_frames(1);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (seconds > 0.0) ? static_cast<double>(frames) / seconds : 0.0;
+}
+
+gb_perf_gate::gb_measurements_t gb_perf_gate::measure(const gb_gate_config_t& config, std::ostream& progress) {
+    gb_measurements_t measurements;
+
+    measurements.host_ns = measure_host();
+    progress << "host: " << static_cast<uint64_t>(measurements.host_ns) << "ns" << std::endl;
+
+    // Runs are interleaved so a burst of load from something else on the machine is spread across the workloads
+    std::vector<std::vector<double>> fps (g_workloads.size());
+    for (unsigned int run = 0; run < config.runs; run++) {
+        for (size_t i = 0; i < g_workloads.size(); i++) fps[i].push_back(run_workload(g_workloads[i], config.frames, config.warmup_frames));
+    }
+
+    for (size_t i = 0; i < g_workloads.size(); i++) {
+        measurements.frames_per_sec[g_workloads[i].name] = _median(fps[i]);
+        progress << g_workloads[i].name << ": " << measurements.frames_per_sec[g_workloads[i].name] << " frames/s" << std::endl;
+    }
+
+    gb_microbench bench (config.samples, config.sample_seconds);
+    gb_microbench_suite::add_all(bench);
+
+    for (const gb_microbench::gb_microbench_result_t& result : bench.run(std::string(), progress)) {
+        measurements.ns_per_op[result.name] = result.ns_median;
+    }
+
+    return measurements;
+}
+
+gb_perf_gate::gb_measurements_t gb_perf_gate::load(const std::string& filename) {
+    std::ifstream file (filename);
+    if (!file) throw std::runtime_error("gb_perf_gate::load() - Can't read file: " + filename);
+
+    std::string text ((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::map<std::string, double> numbers = gb_json::parse_numbers(text, filename);
+
+    gb_measurements_t measurements;
+    measurements.host_ns = 0.0;
+
+    const std::string fps_prefix = "frames_per_sec.";
+    const std::string ns_prefix = "ns_per_op.";
+
+    for (const auto& number : numbers) {
+        const std::string& key = number.first;
+
+        if (key == "host_ns") {
+            measurements.host_ns = number.second;
+        } else if (key.compare(0, fps_prefix.size(), fps_prefix) == 0) {
+            measurements.frames_per_sec[key.substr(fps_prefix.size())] = number.second;
+        } else if (key.compare(0, ns_prefix.size(), ns_prefix) == 0) {
+            measurements.ns_per_op[key.substr(ns_prefix.size())] = number.second;
+        }
+    }
+
+    return measurements;
+}
+
+static void _write_object(std::ostream& os, const char* name, const std::map<std::string, double>& values, bool last) {
+    os << "  \"" << name << "\": {" << std::endl;
+
+    size_t i = 0;
+    for (const auto& value : values) {
+        os << "    \"" << gb_json::escape(value.first) << "\": " << value.second << ((++i < values.size()) ? "," : "") << std::endl;
+    }
+
+    os << "  }" << (last ? "" : ",") << std::endl;
+}
+
+void gb_perf_gate::save(std::ostream& os, const gb_measurements_t& measurements) {
+    os << "{" << std::endl;
+    os << "  \"host_ns\": " << static_cast<uint64_t>(measurements.host_ns) << "," << std::endl;
+    _write_object(os, "frames_per_sec", measurements.frames_per_sec, false);
+    _write_object(os, "ns_per_op", measurements.ns_per_op, true);
+    os << "}" << std::endl;
+}
+
+static double _change_percent(double from, double to) {
+    return (from > 0.0) ? 100.0 * (to - from) / from : 0.0;
+}
+
+bool gb_perf_gate::compare(std::ostream& os, const gb_measurements_t& baseline, const gb_measurements_t& current, double threshold_percent, bool scale) {
+    char line[128];
+    bool passed = true;
+
+    // How much slower this host is than the baseline's, the baseline is adjusted by it before comparing
+    double host_factor = (scale && baseline.host_ns > 0.0 && current.host_ns > 0.0) ? current.host_ns / baseline.host_ns : 1.0;
+    if (scale) {
+        snprintf(line, sizeof(line), "host speed: %.2fx the baseline's", 1.0 / host_factor);
+        os << line << std::endl << std::endl;
+    }
+
+    snprintf(line, sizeof(line), "%-16s %14s %14s %10s", "workload", "expected fps", "median fps", "change");
+    os << line << std::endl;
+
+    for (const auto& fps : current.frames_per_sec) {
+        auto expected = baseline.frames_per_sec.find(fps.first);
+        if (expected == baseline.frames_per_sec.end()) {
+            snprintf(line, sizeof(line), "%-16s %14s %14.1f %10s", fps.first.c_str(), "-", fps.second, "new");
+            os << line << std::endl;
+            continue;
+        }
+
+        double expected_fps = expected->second / host_factor;
+        double change = _change_percent(expected_fps, fps.second);
+        bool regressed = change < -threshold_percent;
+        passed = passed && !regressed;
+
+        snprintf(line, sizeof(line), "%-16s %14.1f %14.1f %+9.1f%%%s", fps.first.c_str(), expected_fps, fps.second, change, regressed ? "  FAIL" : "");
+        os << line << std::endl;
+    }
+
+    // Every micro-benchmark change is a ratio of times, so a subsystem's change is their geometric mean
+    struct gb_subsystem_t {
+        double      log_sum;
+        size_t      count;
+        std::string slowest;
+        double      slowest_change;
+    };
+
+    std::map<std::string, gb_subsystem_t> subsystems;
+    for (const auto& ns : current.ns_per_op) {
+        auto expected = baseline.ns_per_op.find(ns.first);
+        if (expected == baseline.ns_per_op.end() || expected->second <= 0.0 || ns.second <= 0.0) continue;
+
+        double expected_ns = expected->second * host_factor;
+        double change = _change_percent(expected_ns, ns.second);
+
+        auto it = subsystems.find(gb_microbench_suite::get_subsystem(ns.first));
+        if (it == subsystems.end()) {
+            it = subsystems.insert({gb_microbench_suite::get_subsystem(ns.first), {0.0, 0, ns.first, change}}).first;
+        }
+
+        gb_subsystem_t& subsystem = it->second;
+        subsystem.log_sum += std::log(ns.second / expected_ns);
+        subsystem.count++;
+        if (change > subsystem.slowest_change) {
+            subsystem.slowest = ns.first;
+            subsystem.slowest_change = change;
+        }
+    }
+
+    os << std::endl;
+    snprintf(line, sizeof(line), "%-24s %10s   %-32s %10s", "subsystem (ns/op)", "change", "slowest benchmark", "change");
+    os << line << std::endl;
+
+    for (const auto& it : subsystems) {
+        const gb_subsystem_t& subsystem = it.second;
+        double change = 100.0 * (std::exp(subsystem.log_sum / static_cast<double>(subsystem.count)) - 1.0);
+        bool slower = change > threshold_percent || subsystem.slowest_change > threshold_percent;
+
+        snprintf(line, sizeof(line), "%-24s %+9.1f%%   %-32s %+9.1f%%%s", it.first.c_str(), change, subsystem.slowest.c_str(),
+                 subsystem.slowest_change, slower ? "  SLOWER" : "");
+        os << line << std::endl;
+    }
+
+    return passed;
+}
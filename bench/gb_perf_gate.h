@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_PERF_GATE_H_
+#define GB_PERF_GATE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+// A performance regression gate: runs a fixed set of synthetic workloads several times each and compares the median
+// frames/sec against a baseline. The micro-benchmarks are measured too so a regression can be traced to a subsystem
+namespace gb_perf_gate {
+    struct gb_workload_t {
+        const char*          name;
+        std::vector<uint8_t> body;   // Repeated to fill bank 0 of gb_microbench_fixture's cartridge
+        bool                 ppu;    // Draw random tiles, a window and sprites on every line
+        const char*          script; // Input script, looped every 64 frames. Empty for no input
+    };
+
+    struct gb_gate_config_t {
+        unsigned int runs;          // Runs of each workload, the median is kept
+        uint64_t     frames;        // Timed frames per run
+        uint64_t     warmup_frames; // Run before timing starts
+        size_t       samples;       // Micro-benchmark samples
+        double       sample_seconds;
+    };
+
+    // The results of a gate run, which is also what a baseline holds
+    struct gb_measurements_t {
+        double                        host_ns;        // Time taken by a fixed host workload, see measure_host()
+        std::map<std::string, double> frames_per_sec; // Median by workload
+        std::map<std::string, double> ns_per_op;      // Median by micro-benchmark
+    };
+
+    const std::vector<gb_workload_t>& get_workloads();
+
+    // Time a fixed table lookup and branch heavy loop that doesn't touch the emulator. Comparing it with the baseline's
+    // gives a rough idea of how much faster or slower this machine is than the one the baseline was recorded on
+    double measure_host();
+
+    // Run a workload on the calling thread and return its frames/sec, throws if the fixture can't be set up
+    double run_workload(const gb_workload_t& workload, uint64_t frames, uint64_t warmup_frames);
+
+    // Measure everything, writing progress as it goes
+    gb_measurements_t measure(const gb_gate_config_t& config, std::ostream& progress);
+
+    // Read or write measurements as JSON, throws std::runtime_error on errors
+    gb_measurements_t load(const std::string& filename);
+    void save(std::ostream& os, const gb_measurements_t& measurements);
+
+    // Compare against a baseline and print a table per workload and per subsystem. Returns false if any workload's
+    // frames/sec dropped by more than threshold_percent. If scale is true the baseline is first scaled by the
+    // difference in host speed
+    bool compare(std::ostream& os, const gb_measurements_t& baseline, const gb_measurements_t& current, double threshold_percent, bool scale);
+}
+
+#endif // GB_PERF_GATE_H_
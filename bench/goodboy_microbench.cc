@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "gb_microbench.h"
+#include "gb_microbench_suite.h"
+
+#define GB_MICROBENCH_DEFAULT_SAMPLES   (10)
+#define GB_MICROBENCH_DEFAULT_SAMPLE_MS (20)
+
+static void _print_usage(const char* program_name) {
+    std::cout << "usage: " << program_name << " [options]" << std::endl
+              << std::endl << "Options and arguments:" << std::endl
+              << "-h          : Print this help and exit" << std::endl
+              << "-f filter   : Only run benchmarks whose name contains the filter" << std::endl
+              << "-n samples  : Number of timed samples per benchmark (default: " << GB_MICROBENCH_DEFAULT_SAMPLES << ")" << std::endl
+              << "-t ms       : Minimum time per sample in milliseconds (default: " << GB_MICROBENCH_DEFAULT_SAMPLE_MS << ")" << std::endl
+              << "-o file     : Also write the results to a JSON file" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::string filter;
+    std::string output_filename;
+    unsigned long samples = GB_MICROBENCH_DEFAULT_SAMPLES;
+    unsigned long sample_ms = GB_MICROBENCH_DEFAULT_SAMPLE_MS;
+
+    for (int c = 0; (c = getopt(argc, argv, "hf:n:t:o:")) != -1; ) {
+        try {
+            switch (c) {
+                case 'f': filter = optarg; break;
+                case 'n': samples = std::stoul(optarg); break;
+                case 't': sample_ms = std::stoul(optarg); break;
+                case 'o': output_filename = optarg; break;
+                case 'h': _print_usage(argv[0]); return EXIT_SUCCESS;
+                default: _print_usage(argv[0]); return EXIT_FAILURE;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << argv[0] << ": invalid argument '" << optarg << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    gb_microbench bench (samples, static_cast<double>(sample_ms) / 1000.0);
+
+    try {
+        gb_microbench_suite::add_all(bench);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<gb_microbench::gb_microbench_result_t> results = bench.run(filter, std::cout);
+
+    if (!output_filename.empty()) {
+        std::ofstream output_file (output_filename);
+        if (!output_file) {
+            std::cerr << argv[0] << ": can't open '" << output_filename << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+        gb_microbench::write_json(output_file, results);
+    }
+
+    return EXIT_SUCCESS;
+}
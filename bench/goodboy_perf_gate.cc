@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "gb_perf_gate.h"
+
+#define GB_PERF_GATE_DEFAULT_RUNS      (5)
+#define GB_PERF_GATE_DEFAULT_FRAMES    (300)
+#define GB_PERF_GATE_DEFAULT_WARMUP    (60)
+#define GB_PERF_GATE_DEFAULT_THRESHOLD (10.0)
+#define GB_PERF_GATE_SAMPLES           (5)
+#define GB_PERF_GATE_SAMPLE_MS         (10)
+
+static void _print_usage(const char* program_name) {
+    std::cout << "usage: " << program_name << " [options] baseline" << std::endl
+              << std::endl << "Options and arguments:" << std::endl
+              << "-h          : Print this help and exit" << std::endl
+              << "-r runs     : Runs of each workload, the median frames/sec is compared (default: " << GB_PERF_GATE_DEFAULT_RUNS << ")" << std::endl
+              << "-n frames   : Number of frames to time per run (default: " << GB_PERF_GATE_DEFAULT_FRAMES << ")" << std::endl
+              << "-t percent  : Fail if a workload's frames/sec drops by more than this (default: " << GB_PERF_GATE_DEFAULT_THRESHOLD << ")" << std::endl
+              << "-s          : Scale the baseline by the difference in host speed, for baselines recorded on another machine" << std::endl
+              << "-u          : Write the measurements to the baseline instead of comparing against it" << std::endl
+              << "-o file     : Also write the measurements to a JSON file" << std::endl
+              << "-v          : Print each measurement as it's taken" << std::endl
+              << "baseline    : JSON file written by -u" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    gb_perf_gate::gb_gate_config_t config = {GB_PERF_GATE_DEFAULT_RUNS, GB_PERF_GATE_DEFAULT_FRAMES, GB_PERF_GATE_DEFAULT_WARMUP,
+                                             GB_PERF_GATE_SAMPLES, GB_PERF_GATE_SAMPLE_MS / 1000.0};
+    double threshold = GB_PERF_GATE_DEFAULT_THRESHOLD;
+    bool scale = false;
+    bool update = false;
+    bool verbose = false;
+    std::string output_filename;
+
+    for (int c = 0; (c = getopt(argc, argv, "hr:n:t:suo:v")) != -1; ) {
+        try {
+            switch (c) {
+                case 'r': config.runs = static_cast<unsigned int>(std::stoul(optarg)); break;
+                case 'n': config.frames = std::stoull(optarg); break;
+                case 't': threshold = std::stod(optarg); break;
+                case 's': scale = true; break;
+                case 'u': update = true; break;
+                case 'o': output_filename = optarg; break;
+                case 'v': verbose = true; break;
+                case 'h': _print_usage(argv[0]); return EXIT_SUCCESS;
+                default: _print_usage(argv[0]); return EXIT_FAILURE;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << argv[0] << ": invalid argument '" << optarg << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc) {
+        std::cerr << argv[0] << ": 'baseline' must be specified" << std::endl;
+        _print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (config.runs == 0 || config.frames == 0) {
+        std::cerr << argv[0] << ": runs and frames must be at least 1" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string baseline_filename = argv[optind];
+    gb_perf_gate::gb_measurements_t baseline, current;
+
+    try {
+        // Read the baseline first so a bad path fails before spending time measuring
+        if (!update) baseline = gb_perf_gate::load(baseline_filename);
+
+        std::ostringstream quiet;
+        current = gb_perf_gate::measure(config, verbose ? std::cout : quiet);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (update) output_filename = baseline_filename;
+
+    if (!output_filename.empty()) {
+        std::ofstream output_file (output_filename);
+        if (!output_file) {
+            std::cerr << argv[0] << ": can't open '" << output_filename << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+        gb_perf_gate::save(output_file, current);
+    }
+
+    if (update) {
+        std::cout << "Baseline written to " << baseline_filename << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    bool passed = gb_perf_gate::compare(std::cout, baseline, current, threshold, scale);
+    std::cout << std::endl << (passed ? "PASSED: no workload's" : "FAILED: a workload's") << " median frames/sec dropped by more than "
+              << threshold << "%" << std::endl;
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_BOOTROM_H_
+#define GB_BOOTROM_H_
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+#include "gb_memory_mapped_device.h"
+
+// The bootrom is mapped over the start of the cartridge ROM while the boot sequence runs
+// The memory map can't map anything smaller than 2KB at 0x0000 so reads past the end of the bootrom are forwarded to the cartridge ROM
+// This leaves the cartridge ROM untouched, which matters since it's shared between clones
+class gb_bootrom : public gb_memory_mapped_device {
+public:
+    gb_bootrom(gb_memory_manager& memory_manager, gb_memory_mapped_device_ptr rom, const std::vector<uint8_t>& bootrom);
+    virtual ~gb_bootrom() override;
+
+    virtual uint8_t* get_mem() override;
+    virtual uint8_t read_byte(uint16_t addr) override;
+    virtual void write_byte(uint16_t addr, uint8_t val) override;
+    virtual unsigned long get_current_bank() const override;
+
+private:
+    gb_memory_mapped_device_ptr m_rom;
+    std::vector<uint8_t>        m_bootrom;
+};
+
+using gb_bootrom_ptr = std::shared_ptr<gb_bootrom>;
+
+#endif // GB_BOOTROM_H_
@@ -7,58 +7,78 @@
 #ifndef GB_BREAKPOINT_H_
 #define GB_BREAKPOINT_H_
 
-#include <unordered_set>
-#include <functional>
+#include <cstdint>
+#include <array>
+#include <set>
 #include <exception>
 #include <string>
 
+// Breakpoints that aren't qualified with a bank number match in every bank
+#define GB_BREAKPOINT_ANY_BANK (0xFFFFu)
+
+// Reasons the emulator may stop executing before it has run the requested number of cycles
+enum gb_stop_reason_t {
+    GB_STOP_NONE,
+    GB_STOP_BREAKPOINT,
+    GB_STOP_WATCHPOINT,
+    GB_STOP_MAGIC_BREAKPOINT
+};
+
+// Only used internally by the CPU to unwind out of an instruction when a watchpoint is hit mid-instruction
 class gb_breakpoint_exception : public std::exception {
 public:
     gb_breakpoint_exception(std::string msg, unsigned int val);
     gb_breakpoint_exception(unsigned int val);
-    gb_breakpoint_exception(unsigned int val, int cycles);
 
     virtual char const * what() const noexcept;
-    int get_last_cycle_count() const noexcept;
     unsigned int get_val() const noexcept;
 
 private:
     std::string  m_msg;
     unsigned int m_val;
-    int          m_last_cycle_count;
 };
 
 using gb_watchpoint_exception = gb_breakpoint_exception;
 
 // This class provides routines to add/remove and check if a breakpoint was hit
+// Every 16-bit address has a bit in a bitmap so the common case (no breakpoint at this address) is a single load.
+// Bank qualified breakpoints also set the address bit and are resolved against the set only when the bit is set.
 class gb_breakpoint {
 friend class gb_debugger;
 public:
     gb_breakpoint();
 
-    // Add a breakpoint
-    void add(unsigned int bp);
+    // Add a breakpoint, optionally only matching when the given bank is mapped at the address
+    void add(unsigned int bp, unsigned int bank = GB_BREAKPOINT_ANY_BANK);
 
     // Remove the specified breakpoint
-    void remove(unsigned int bp);
+    void remove(unsigned int bp, unsigned int bank = GB_BREAKPOINT_ANY_BANK);
 
     // Remove all breakpoints
     void clear();
 
-    // Given a value and N cycles, check if the value matches any of the registered breakpoints.
-    // If so this will throw an exception of type gb_breakpoint_exception with the cycle count.
-    // This is useful for the debugger to keep an accurate cycle count since the exception will be thrown
-    // before the CPU returns the cycle count of the previous instruction to the breakpoint
-    void match(unsigned int val, int cycles);
+    // Check if there are any breakpoints registered
+    bool empty() const;
 
-    // Given a value, check if it matches any of the registered breakpoints.
-    // If so this will throw an exception of type gb_breakpoint_exception
-    void match(unsigned int val);
+    // Check the bitmap to see if any breakpoint (in any bank) is registered at the given address
+    // This is called for every instruction so it's kept inline
+    bool test(unsigned int val) const {
+        return ((m_bitmap[(val >> 6) & 0x3ff] >> (val & 0x3f)) & 0x1) != 0;
+    }
+
+    // Given an address and the bank currently mapped there, check if it matches any of the registered breakpoints
+    // Only worth calling if test() returns true
+    bool match(unsigned int val, unsigned int bank) const;
 
 private:
-    using gb_breakpoint_set_t = std::unordered_set<unsigned int>;
+    // Breakpoints are stored as (bank << 16) | address
+    using gb_breakpoint_set_t    = std::set<unsigned int>;
+    using gb_breakpoint_bitmap_t = std::array<uint64_t, 0x10000/64>;
+
+    gb_breakpoint_set_t    m_breakpoints;
+    gb_breakpoint_bitmap_t m_bitmap;
 
-    gb_breakpoint_set_t m_breakpoints;
+    void _update_bitmap(unsigned int bp);
 };
 
 using gb_watchpoint = gb_breakpoint;
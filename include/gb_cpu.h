@@ -14,19 +14,44 @@
 
 #include "gb_memory_map.h"
 #include "gb_breakpoint.h"
+#include "gb_guest_profiler.h"
 
 class gb_cpu {
 friend class gb_debugger;
 public:
+    struct registers_t {
+        union { struct { uint8_t f; uint8_t a; }; uint16_t af; };
+        union { struct { uint8_t c; uint8_t b; }; uint16_t bc; };
+        union { struct { uint8_t e; uint8_t d; }; uint16_t de; };
+        union { struct { uint8_t l; uint8_t h; }; uint16_t hl; };
+        uint16_t sp;
+        uint16_t pc;
+    };
+
     gb_cpu(gb_memory_map& memory_map);
     ~gb_cpu();
 
     void dump_registers() const;
     uint16_t get_pc() const;
     void set_pc(uint16_t pc);
+    registers_t get_registers() const;
     int step();
     bool handle_interrupt(uint16_t jump_address);
 
+    // Save or restore the registers and interrupt/halt state. Breakpoints and watchpoints aren't part of the state
+    void save_state(gb_state_writer& state) const;
+    void load_state(gb_state_reader& state);
+
+    // Stop on LD B,B, the software breakpoint test ROMs (i.e. mooneye-gb) execute when they're done
+    void set_magic_breakpoint(bool enabled);
+
+    // Check if the last step hit a breakpoint or watchpoint and the address that triggered it
+    gb_stop_reason_t get_stop_reason() const;
+    uint16_t get_stop_addr() const;
+
+    // Report every instruction, call, return and interrupt to the profiler, nullptr turns profiling off
+    void set_guest_profiler(gb_guest_profiler_ptr guest_profiler);
+
 private:
     struct instruction_t;
 
@@ -36,15 +61,6 @@ private:
     using op_exec_func_t       = std::function<int(const instruction_t&)>;
     using gb_instruction_map_t = std::array<instruction_t, 256>;
 
-    struct registers_t {
-        union { struct { uint8_t f; uint8_t a; }; uint16_t af; };
-        union { struct { uint8_t c; uint8_t b; }; uint16_t bc; };
-        union { struct { uint8_t e; uint8_t d; }; uint16_t de; };
-        union { struct { uint8_t l; uint8_t h; }; uint16_t hl; };
-        uint16_t sp;
-        uint16_t pc;
-    };
-
     enum flags_t {
         FLAGS_C = 0x10,
         FLAGS_H = 0x20,
@@ -73,13 +89,18 @@ private:
     const gb_instruction_map_t m_cb_instructions;
     registers_t                m_registers;
     gb_memory_map&             m_memory_map;
+    gb_logger&                 m_logger;
     eidiflag_t                 m_eidi_flag;
     bool                       m_interrupt_enable;
     bool                       m_halted;
     bool                       m_bp_enabled;
     bool                       m_wp_enabled;
+    bool                       m_magic_bp_enabled;
     gb_breakpoint              m_bp;
     gb_watchpoint              m_wp;
+    gb_stop_reason_t           m_stop_reason;
+    uint16_t                   m_stop_addr;
+    gb_guest_profiler_ptr      m_guest_profiler;
 
     // read and write to memory with watchpoint checking
     uint8_t _read_byte(uint16_t addr);
@@ -9,6 +9,7 @@
 
 #include <unordered_map>
 #include <functional>
+#include <vector>
 
 #include "gb_emulator.h"
 #include "gb_ppu.h"
@@ -32,6 +33,7 @@ private:
     using command_doc_t      = std::vector<std::array<std::string, 2>>;
 
     gb_emulator&        m_emulator;
+    gb_logger&          m_logger;
     const key_map_t     m_key_map;
     const command_doc_t m_command_doc;
     ncurses_stream_ptr  m_nstream;
@@ -40,14 +42,22 @@ private:
     bool                m_continue;
     gb_ppu_ptr          m_ppu;
 
+    // In-memory save state slot used by the 'v' command when no file is given
+    std::vector<uint8_t> m_state;
+
     void _debugger_help();
     void _debugger_step_once();
+    void _debugger_stop(gb_stop_reason_t stop_reason);
     void _debugger_dump_registers();
     void _debugger_modify_register();
     void _debugger_access_memory();
     void _debugger_breakpoints();
     void _debugger_watchpoints();
     void _debugger_save_trace();
+    void _debugger_state();
+    void _debugger_rewind();
+    void _debugger_memory_profile();
+    void _debugger_perf_counters();
     void _debugger_sprite_viewer();
     void _debugger_tile_map_viewer();
     void _debugger_scroll_up_half_pg();
@@ -16,6 +16,8 @@ public:
 
     virtual void write_byte(uint16_t addr, uint8_t val) override;
     virtual bool update(int cycles);
+    virtual void save_state(gb_state_writer& state) const override;
+    virtual void load_state(gb_state_reader& state) override;
 
 private:
     gb_memory_map&              m_memory_map;
@@ -7,36 +7,238 @@
 #ifndef GB_EMULATOR_H_
 #define GB_EMULATOR_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
+#include <memory>
+#include <chrono>
+#include <fstream>
 
+#include "gb_logger.h"
 #include "gb_memory_map.h"
 #include "gb_interrupt_controller.h"
 #include "gb_cpu.h"
+#include "gb_ppu.h"
 #include "gb_renderer.h"
 #include "gb_dma.h"
+#include "gb_serial_io.h"
+#include "gb_state.h"
+#include "gb_rewind.h"
+#include "gb_movie.h"
+#include "gb_host_profiler.h"
+#include "gb_guest_profiler.h"
+
+// Frames between rewind snapshots by default, rewinding plays back at this many times normal speed
+#define GB_EMULATOR_REWIND_INTERVAL (2)
+
+class gb_emulator;
+
+using gb_emulator_ptr = std::shared_ptr<gb_emulator>;
 
 class gb_emulator {
 friend class gb_debugger;
 public:
-    gb_emulator();
+    // The renderer is used to present the framebuffer every frame and decides when go() stops
+    gb_emulator(gb_renderer_ptr renderer);
     ~gb_emulator();
 
     void load_rom(const std::string& rom_filename);
+
+    // Load a ROM image that is already in memory, the image is copied so it doesn't need to outlive the call
+    void load_rom(const uint8_t* rom_data, size_t rom_data_size);
+
+    // Run the DMG bootrom if use_bootrom is set and DMG_ROM.bin is in the current directory, otherwise skip to PC=0x0100
+    void boot(bool use_bootrom = true);
+
     int step(int num_cycles);
+
+    // Same as above but stops early if a breakpoint or watchpoint is hit
+    // step_cycles is set to the number of cycles actually run
+    gb_stop_reason_t step(int num_cycles, int& step_cycles);
+
+    // boot() and then run() until the renderer is closed
     void go();
+    void run();
+
+    // Run up to num_frames frames, presenting each one to the renderer. Stops early if the renderer is closed
+    // Returns the number of frames that were run
+    unsigned long run_frames(unsigned long num_frames);
+
+    // Emulated CPU cycles since power on (part of the save state). Instructions retired are in get_perf_counters()
+    uint64_t get_cycle_count() const;
+
+    // Get a pointer to the memory backing the device mapped at addr (i.e. work RAM at 0xC000)
+    // size is set to the number of bytes from addr to the end of the device's address range
+    // The pointer points into the memory manager and is valid until another ROM is loaded
+    // VRAM and OAM are found even while the LCD has them unmapped from the CPU (modes 2 and 3)
+    uint8_t* get_mem(uint16_t addr, size_t& size);
+
+    // The PPU caches decoded tiles and only notices VRAM writes made by the CPU. Call this after writing tile data
+    // through get_mem so the tiles are decoded again
+    void invalidate_vram();
+
+    // The logger used by this instance and all of its devices
+    gb_logger& get_logger();
+
+    // Print serial output to the logger line by line (enabled by default)
+    void set_serial_echo(bool enabled);
+
+    // Everything the ROM has sent out over the serial port
+    const std::string& get_serial_output() const;
+
+    // Make step() stop with GB_STOP_MAGIC_BREAKPOINT when LD B,B is run, test ROMs use it to signal they're done
+    void set_magic_breakpoint(bool enabled);
+
+    // A copy of the CPU registers, i.e. to check the result a test ROM left in them
+    gb_cpu::registers_t get_cpu_registers() const;
+
+    // Append a snapshot of the complete machine state to the buffer
+    // Most of the state is the memory manager's arena which is copied with a single memcpy
+    void save_state(std::vector<uint8_t>& state);
+
+    // Same as above but written straight into a buffer of at least get_state_size() bytes. Returns the number of bytes
+    // written, throws std::runtime_error if the buffer is too small
+    size_t save_state(uint8_t* state, size_t state_size);
+
+    // Size of a snapshot of the loaded cartridge, every snapshot of it is the same size
+    size_t get_state_size() const;
+
+    // Restore a snapshot taken with save_state. The same ROM must be loaded
+    // Throws std::runtime_error if the state is from a different version of the format or another cartridge, or is
+    // the wrong size. A state that is rejected leaves the machine as it was
+    void load_state(const uint8_t* state, size_t state_size);
+
+    // Same as above but to and from a file
+    void save_state(const std::string& filename);
+    void load_state(const std::string& filename);
+
+    // Create an independent copy of this emulator, i.e. to branch off a search or rollout from the current state
+    // The clone shares the read-only ROM with this emulator, all of the devices are rebuilt and the rest of the memory is copied
+    // Frames are presented to the given renderer or to a gb_null_renderer if none is given. The buttons currently pressed are copied
+    // Breakpoints, watchpoints and serial output from before the clone was made aren't copied
+    gb_emulator_ptr clone(gb_renderer_ptr renderer = nullptr);
+
+    // Keep a snapshot every interval frames in a ring of the given size in bytes, a capacity of 0 turns rewinding off
+    // While the renderer's rewind hotkey is held run_frames() steps backwards through the snapshots instead of running
+    // Snapshots cost a save state plus a delta encode, see gb_rewind. Clones don't inherit the ring
+    void enable_rewind(size_t capacity, unsigned int interval = GB_EMULATOR_REWIND_INTERVAL);
+
+    // Restore the most recent snapshot and drop it from the ring. Returns false if there is nothing to rewind to
+    bool rewind();
+
+    // Present the frame num_frames ahead of the real one to hide the game's input lag, 0 turns run-ahead off
+    // Every frame the machine is saved, run num_frames further with the current input, presented, then restored
+    // Only the presented frame is drawn, the real frame and the other extra frames run without drawing, and the
+    // framebuffer keeps the presented frame. The extra frames aren't recorded for rewinding, added to the serial output
+    // or counted in the performance counters, the trace or the guest profile
+    void set_run_ahead(unsigned int num_frames);
+
+    // Average host time in microseconds spent per frame on run-ahead (saving, running the extra frames and restoring)
+    double get_run_ahead_cost() const;
+
+    // Start recording the buttons held every frame into the movie, beginning with the current state. nullptr stops recording
+    void record_movie(gb_movie_ptr movie);
+
+    // Load the movie's start state and drive the buttons from the movie instead of the renderer from the next frame on
+    // Throws std::runtime_error if the movie was recorded with a different ROM. Rewinding is disabled while a movie is active
+    void play_movie(gb_movie_ptr movie);
+
+    // Hash of the loaded ROM image, used to check that a movie belongs to it
+    uint64_t get_rom_hash();
+
+    // Export the guest memory access profile to a CSV or JSON file (requires a build with GOODBOY_MEMORY_PROFILER)
+    void save_memory_profile(const std::string& filename);
+
+    // Log a breakdown of the host time spent in the CPU, each interrupt source, DMA and the renderer every num_frames frames
+    // as a table or a single line of JSON, 0 turns it off (requires a build with GOODBOY_HOST_PROFILER)
+    void set_host_profile_interval(unsigned long num_frames, bool json = false);
+
+    // Profile the code running on the emulated CPU, nullptr stops profiling. Frames run ahead aren't profiled
+    // Loading a state clears the profiler's shadow call stack. Clones don't inherit the profiler
+    void set_guest_profiler(gb_guest_profiler_ptr guest_profiler);
+
+    // The performance counters of this instance; they can be reset at any time
+    gb_perf_counters& get_perf_counters();
+
+    // Write the performance counters as a line of JSON to a file every num_frames frames. An empty filename stops the dump
+    // after writing a last line if any frames were run since the previous one. Throws std::runtime_error if the file can't be opened
+    void set_perf_counters_dump(const std::string& filename, unsigned long num_frames);
+
+    // Record a timeline of frames, scanlines, LCD modes, interrupts, DMA, bank switches and HALT, nullptr stops tracing
+    // Frames run ahead aren't traced. Clones don't inherit the tracer
+    void set_tracer(gb_tracer_ptr tracer);
 
 protected:
-    gb_renderer              m_renderer;
+    gb_renderer_ptr          m_renderer;
+    gb_logger                m_logger;
     gb_memory_manager        m_memory_manager;
     gb_memory_map            m_memory_map;
     gb_cpu                   m_cpu;
     gb_interrupt_controller  m_interrupt_controller;
+    gb_ppu_ptr               m_ppu;
     gb_dma_ptr               m_dma;
-    uint64_t                 m_cycles;
+    gb_serial_io_ptr         m_serial_io;
+    bool                     m_serial_echo;
+
+    // Devices with state outside of the memory manager, saved and loaded in this order
+    std::vector<gb_memory_mapped_device_ptr> m_state_devices;
+
+    // OAM is kept here as well as in the PPU since the LCD takes it out of the memory map during modes 2 and 3
+    gb_memory_mapped_device_ptr m_oam;
+
+    // Size of a save state of the loaded cartridge and where the arena's size is in it, so a state can be checked
+    // before any of it is loaded. Every component saves a fixed amount so these only change with the cartridge
+    size_t                   m_state_size;
+    size_t                   m_state_arena_offset;
+
+    gb_rewind_ptr            m_rewind;
+    unsigned int             m_rewind_interval;
+    unsigned int             m_rewind_frames;
+    std::vector<uint8_t>     m_rewind_state;
+
+    unsigned int             m_run_ahead_frames;
+    std::vector<uint8_t>     m_run_ahead_state;
+    uint64_t                 m_run_ahead_count;
+    std::chrono::nanoseconds m_run_ahead_time;
+
+    gb_movie_ptr             m_movie;
+    bool                     m_movie_playing;
+    uint64_t                 m_movie_frame;
+
+    gb_guest_profiler_ptr    m_guest_profiler;
+    gb_tracer_ptr            m_tracer;
+
+    std::ofstream            m_perf_counters_file;
+    unsigned long            m_perf_counters_interval;
+    unsigned long            m_perf_counters_frames;
+
+#ifdef GB_HOST_PROFILER
+    gb_host_profiler         m_host_profiler;
+    unsigned long            m_host_profile_interval;
+    bool                     m_host_profile_json;
+
+    // Called at the end of every frame, logs and restarts the profile every m_host_profile_interval frames
+    void _report_host_profile();
+#endif
 
     bool _run_bootrom();
+
+    // Called at the end of every frame, pushes a snapshot into the rewind ring every m_rewind_interval frames
+    void _record_rewind();
+
+    // Called at the start of every frame, records or plays back the buttons for the frame
+    void _movie_frame();
+
+    // Called at the end of every frame while dumping the performance counters, writes them every m_perf_counters_interval frames
+    void _dump_perf_counters();
+
+    // Run and present the frames ahead of the current one and then restore the machine
+    void _run_ahead();
+    void _add_devices(gb_memory_mapped_device_ptr mbc);
+
+    // Write the state with the writer, the header's size is the one counted when the ROM was loaded
+    void _save_state(gb_state_writer& writer);
 };
 
 #endif // GB_EMULATOR_H_
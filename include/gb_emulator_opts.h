@@ -7,17 +7,35 @@
 #ifndef GB_EMULATOR_OPTS_H_
 #define GB_EMULATOR_OPTS_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <functional>
 #include <array>
 
+#include <getopt.h>
+
 class gb_emulator_opts {
 public:
     std::string m_program_name;
     std::string m_rom_filename;
     bool        m_debugger;
     bool        m_tracing;
+    std::string m_memory_profile_filename;
+    unsigned long m_host_profile_interval;
+    bool        m_headless;
+    uint64_t    m_max_frames;
+    std::string m_load_state_filename;
+    std::string m_save_state_filename;
+    size_t      m_rewind_size;
+    unsigned int m_run_ahead_frames;
+    std::string m_record_filename;
+    std::string m_replay_filename;
+    std::string m_guest_profile_name;
+    std::string m_sym_filename;
+    std::string m_trace_filename;
+    std::string m_perf_counters_filename;
 
     gb_emulator_opts(int argc, char **argv);
     ~gb_emulator_opts();
@@ -29,16 +47,31 @@ public:
 private:
     using opt_handler_t = std::function<bool()>;
     using opt_map_t     = std::unordered_map<int, opt_handler_t>;
-    using opt_doc_t     = std::array<std::string, 4>;
+    using opt_doc_t     = std::array<std::string, 17>;
+    using opt_long_t    = std::array<struct option, 7>;
 
     int               m_argc;
     char**            m_argv;
     const std::string m_opt_str;
+    const opt_long_t  m_long_opts;
     const opt_doc_t   m_opt_doc;
     const opt_map_t   m_opt_map;
 
     bool _opt_set_tracing_flag();
     bool _opt_set_debugger_flag();
+    bool _opt_set_memory_profile_filename();
+    bool _opt_set_host_profile_interval();
+    bool _opt_set_headless_frames();
+    bool _opt_set_load_state_filename();
+    bool _opt_set_save_state_filename();
+    bool _opt_set_rewind_size();
+    bool _opt_set_run_ahead_frames();
+    bool _opt_set_record_filename();
+    bool _opt_set_replay_filename();
+    bool _opt_set_guest_profile_name();
+    bool _opt_set_sym_filename();
+    bool _opt_set_trace_filename();
+    bool _opt_set_perf_counters_filename();
     bool _opt_print_doc();
 };
 
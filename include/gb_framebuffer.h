@@ -7,9 +7,11 @@
 #ifndef GB_FRAMEBUFFER_H_
 #define GB_FRAMEBUFFER_H_
 
+#include <cstdint>
 #include <array>
 
-#include <SFML/Graphics.hpp>
+#define GB_WIDTH  (160)
+#define GB_HEIGHT (144)
 
 // Gameboy has four colours
 // 00 - White
@@ -23,21 +25,31 @@ enum gb_colour_t {
     GB_COLOUR3 = 3
 };
 
-class gb_framebuffer : public sf::Image {
+// The framebuffer stores one gb_colour_t per pixel (one byte each). It's up to the renderer to translate
+// the colours to something that can be used on modern GPUs
+class gb_framebuffer {
 public:
     gb_framebuffer();
 
-    // Set a pixel with the specified colour. The colour is translated to something
-    // that can be used on modern GPUs
+    // Set a pixel with the specified colour
     void set_pixel(unsigned int x, unsigned int y, gb_colour_t colour);
 
     // Get a pixel colour at the specified framebuffer location
-    gb_colour_t get_pixel(unsigned int x, unsigned int y);
+    gb_colour_t get_pixel(unsigned int x, unsigned int y) const;
+
+    // Copy a complete scanline (GB_WIDTH pixels) of colours into the framebuffer
+    void set_line(unsigned int y, const uint8_t* colours);
+
+    // Get a pointer to the GB_WIDTH*GB_HEIGHT pixels, row by row
+    const uint8_t* get_pixels() const;
+
+    // 64-bit XXH64 hash (seed 0) of the pixels, used to compare frames across runs and against golden frames
+    uint64_t get_hash() const;
 
 private:
-    using gb_colour_map_t = std::array<sf::Color, 4>;
+    using gb_pixels_t = std::array<uint8_t, GB_WIDTH * GB_HEIGHT>;
 
-    gb_colour_map_t m_colour_map;
+    alignas(32) gb_pixels_t m_pixels;
 };
 
 #endif // GB_FRAMEBUFFER_H_
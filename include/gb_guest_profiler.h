@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_GUEST_PROFILER_H_
+#define GB_GUEST_PROFILER_H_
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <string>
+#include <ostream>
+#include <memory>
+
+// Shadow call stacks deeper than this are assumed to be runaway (i.e. code that calls but never returns) and are cut short
+#define GB_GUEST_PROFILER_MAX_DEPTH (256)
+
+// Profiles the code running on the emulated CPU. Every instruction's cycles are added to a histogram of PCs per bank and to
+// the function on top of a shadow call stack, which follows CALL, RST, RET, RETI and interrupt entry. Returns are matched
+// against the stack pointer at the time of the call so code that drops or fakes return addresses doesn't corrupt the stack
+// Functions are named after the symbol at their entry point from an RGBDS .sym file if one is loaded, otherwise BB:AAAA
+class gb_guest_profiler {
+public:
+    gb_guest_profiler();
+    ~gb_guest_profiler();
+
+    // Called by the CPU around every instruction, so a CALL is charged to the caller and a RET to the callee
+    void begin_instruction(uint16_t pc, unsigned long bank);
+    void end_instruction(int cycles);
+    void record_halt(int cycles);
+
+    // Called by the CPU. sp is the stack pointer pointing at the return address, i.e. after a call's push or before a return's pop
+    void record_call(uint16_t addr, unsigned long bank, uint16_t sp);
+    void record_interrupt(uint16_t addr, uint16_t sp);
+    void record_return(uint16_t sp);
+
+    // Forget the shadow call stack, i.e. after a save state is loaded. The counts are kept
+    void clear_stack();
+    void reset();
+
+    // Load labels from an RGBDS .sym file ("BB:AAAA Label" per line, ';' starts a comment)
+    // Throws std::runtime_error if the file can't be opened
+    void load_symbols(const std::string& filename);
+
+    // One line per calling context: the function names from the outermost call in, separated by ';', and the cycles spent
+    // in the innermost function. This is the format flamegraph.pl, speedscope and inferno take
+    void export_folded(std::ostream& os) const;
+
+    // Cycles spent in each function itself and including everything it calls, and the number of calls, most expensive first
+    void export_functions(std::ostream& os) const;
+
+    // Executions and cycles per instruction address with the nearest preceding label, as CSV
+    void export_histogram(std::ostream& os) const;
+
+    // Export to a file; the format is picked based on the file extension (.folded, .csv for the histogram, otherwise functions)
+    void export_to_file(const std::string& filename) const;
+
+private:
+    // Functions and symbols are identified by (bank << 16) | address
+    using gb_function_t = uint32_t;
+
+    struct gb_pc_counts_t {
+        uint64_t executions;
+        uint64_t cycles;
+    };
+
+    // A node in the calling context tree, one per distinct path of calls from the root
+    struct gb_node_t {
+        gb_function_t function;
+        uint32_t      parent;
+        uint64_t      self_cycles;
+        uint64_t      calls;
+    };
+
+    struct gb_frame_t {
+        uint32_t node;
+        uint16_t sp;
+    };
+
+    using gb_pc_histogram_t  = std::vector<gb_pc_counts_t>;
+    using gb_node_list_t     = std::vector<gb_node_t>;
+    using gb_node_children_t = std::unordered_map<uint64_t, uint32_t>;
+    using gb_symbol_map_t    = std::map<gb_function_t, std::string>;
+
+    // Switchable ROM banks are stored one after the other, everything from 0x8000 up is stored separately without a bank
+    gb_pc_histogram_t       m_rom_pcs;
+    gb_pc_histogram_t       m_ram_pcs;
+
+    gb_node_list_t          m_nodes;
+    gb_node_children_t      m_children;
+    std::vector<gb_frame_t> m_stack;
+    uint32_t                m_node;
+
+    // The histogram entry and calling context of the instruction being executed
+    gb_pc_counts_t*         m_cur_pc;
+    uint32_t                m_cur_node;
+
+    gb_symbol_map_t         m_symbols;
+
+    void _push(gb_function_t function, uint16_t sp);
+    void _pop_to(uint16_t sp);
+    uint32_t _get_child(uint32_t parent, gb_function_t function);
+
+    // Name of the function starting at the given address, and the nearest label at or before an address (i.e. "Label+0x3")
+    std::string _get_function_name(gb_function_t function) const;
+    std::string _get_label(gb_function_t function) const;
+};
+
+using gb_guest_profiler_ptr = std::shared_ptr<gb_guest_profiler>;
+
+#endif // GB_GUEST_PROFILER_H_
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_HOST_PROFILER_H_
+#define GB_HOST_PROFILER_H_
+
+#include <cstdint>
+#include <array>
+#include <chrono>
+#include <ostream>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <x86intrin.h>
+#define GB_HOST_PROFILER_TSC
+#endif
+
+// Time a block of code against one of the profiler's sections. Compiles to nothing unless built with GB_HOST_PROFILER
+// defined (-DGOODBOY_HOST_PROFILER=ON) so the profiler object doesn't even need to exist in normal builds
+#ifdef GB_HOST_PROFILER
+#define GB_HOST_PROFILE_SCOPE(profiler, section) gb_host_profiler::gb_scope _gb_host_profile_scope ((profiler), (section))
+#else
+#define GB_HOST_PROFILE_SCOPE(profiler, section)
+#endif
+
+// Accumulates the host time and number of calls spent in each part of the emulator loop
+// Time is measured with the TSC where available (converted to ns using the steady clock) and the steady clock otherwise
+class gb_host_profiler {
+public:
+    // The interrupt sources come first, in the order of their flag bits, so they can be looked up by flag mask
+    enum gb_section_t {
+        GB_SECTION_PPU,
+        GB_SECTION_LCD,
+        GB_SECTION_TIMER,
+        GB_SECTION_SERIAL,
+        GB_SECTION_JOYPAD,
+        GB_SECTION_INTERRUPTS,
+        GB_SECTION_CPU,
+        GB_SECTION_DMA,
+        GB_SECTION_RENDERER,
+        GB_SECTION_COUNT
+    };
+
+    // Adds the time between construction and destruction to a section
+    class gb_scope {
+    public:
+        gb_scope(gb_host_profiler& profiler, gb_section_t section)
+            : m_profiler(profiler), m_section(section), m_start(now())
+        {
+        }
+
+        ~gb_scope() {
+            m_profiler.add(m_section, now() - m_start);
+        }
+
+    private:
+        gb_host_profiler& m_profiler;
+        gb_section_t      m_section;
+        uint64_t          m_start;
+    };
+
+    gb_host_profiler();
+    ~gb_host_profiler();
+
+    static uint64_t now() {
+#ifdef GB_HOST_PROFILER_TSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // The interrupt source section for the given interrupt flag mask
+    static gb_section_t get_interrupt_section(uint8_t flag_mask);
+
+    void add(gb_section_t section, uint64_t ticks) {
+        m_sections[section].ticks += ticks;
+        m_sections[section].calls++;
+    }
+
+    void end_frame();
+    unsigned long get_frames() const;
+
+    // Start a new measurement window
+    void reset();
+
+    // Print a table of the time spent in each section since the last reset. Time not spent in any section is reported as
+    // "other" (frame overhead like rewind snapshots and run-ahead save states, the frame limiter and the profiler itself)
+    void report(std::ostream& os) const;
+    void export_json(std::ostream& os) const;
+
+private:
+    struct gb_section_counts_t {
+        uint64_t ticks;
+        uint64_t calls;
+    };
+
+    struct gb_section_times_t {
+        double   ns;
+        uint64_t calls;
+    };
+
+    using gb_section_list_t = std::array<gb_section_counts_t, GB_SECTION_COUNT>;
+    using gb_section_times_list_t = std::array<gb_section_times_t, GB_SECTION_COUNT>;
+
+    gb_section_list_t                     m_sections;
+    unsigned long                         m_frames;
+    uint64_t                              m_start_ticks;
+    std::chrono::steady_clock::time_point m_start_time;
+
+    // Ticks measured by an empty scope, subtracted from every call so short sections aren't swamped by the clock reads
+    uint64_t                              m_overhead_ticks;
+
+    void _calibrate();
+
+    // Convert the counts since the last reset to ns, returns the total time of the window
+    double _get_times(gb_section_times_list_t& times) const;
+};
+
+#endif // GB_HOST_PROFILER_H_
@@ -7,10 +7,10 @@
 #ifndef GB_INPUT_H_
 #define GB_INPUT_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <array>
 
-#include <SFML/Window/Keyboard.hpp>
-
 enum gb_button_t {
     GB_BUTTON_DOWN   = 0,
     GB_BUTTON_UP     = 1,
@@ -22,18 +22,34 @@ enum gb_button_t {
     GB_BUTTON_A      = 7
 };
 
+// Keys that control the emulator itself rather than the game, the joypad never sees these
+enum gb_hotkey_t {
+    GB_HOTKEY_REWIND = 0
+};
+
+// Button state shared between the renderer (or whatever is generating input) and the joypad
+// Renderers translate their own key codes to gb_button_t
 class gb_input {
 public:
     gb_input();
 
-    void set_pressed(sf::Keyboard::Key code);
-    void set_released(sf::Keyboard::Key code);
+    void set_pressed(gb_button_t button);
+    void set_released(gb_button_t button);
     bool is_pressed(gb_button_t button);
 
+    // Set or get the state of all buttons at once, bit N is set if button N (gb_button_t) is pressed
+    void set_buttons(uint8_t mask);
+    uint8_t get_buttons();
+
+    void set_hotkey(gb_hotkey_t hotkey, bool pressed);
+    bool is_hotkey_pressed(gb_hotkey_t hotkey);
+
 private:
     using gb_button_state_t = std::array<bool, 8>;
+    using gb_hotkey_state_t = std::array<bool, 1>;
 
     gb_button_state_t m_button_state;
+    gb_hotkey_state_t m_hotkey_state;
 };
 
 #endif // GB_INPUT_H_
@@ -12,6 +12,7 @@
 #include "gb_memory_map.h"
 #include "gb_interrupt_source.h"
 #include "gb_cpu.h"
+#include "gb_host_profiler.h"
 
 class gb_interrupt_controller {
 public:
@@ -21,6 +22,11 @@ public:
     void add_interrupt_source(const gb_interrupt_source_ptr& interrupt_source);
     void update(int cycles);
 
+#ifdef GB_HOST_PROFILER
+    // Time spent in each interrupt source's update and in dispatching interrupts is added to the profiler
+    void set_host_profiler(gb_host_profiler* host_profiler);
+#endif
+
 private:
     class gb_interrupt_register : public gb_memory_mapped_device {
     public:
@@ -42,6 +48,10 @@ private:
 
     // List of interrupt sources to update every iteration
     std::vector<gb_interrupt_source_ptr> m_interrupt_sources;
+
+#ifdef GB_HOST_PROFILER
+    gb_host_profiler*                    m_host_profiler;
+#endif
 };
 
 #endif // GB_INTERRUPT_CONTROLLER_H_
@@ -9,7 +9,6 @@
 
 #include "gb_memory_map.h"
 #include "gb_interrupt_source.h"
-#include "gb_renderer.h"
 
 class gb_lcd : public gb_memory_mapped_device, public gb_interrupt_source {
 public:
@@ -18,6 +17,8 @@ public:
 
     virtual void write_byte(uint16_t addr, uint8_t val) override;
     virtual bool update(int cycles) override;
+    virtual void save_state(gb_state_writer& state) const override;
+    virtual void load_state(gb_state_reader& state) override;
 
 private:
     class gb_lcd_ly_register : public gb_memory_mapped_device {
@@ -41,11 +42,18 @@ private:
     gb_lcd_ly_register_ptr      m_lcd_ly;
 
     gb_memory_map&              m_memory_map;
+    // Set while OAM (mode 2 and 3) and VRAM (mode 3) are unmapped so they can be mapped back
     gb_memory_mapped_device_ptr m_oam;
     gb_memory_mapped_device_ptr m_vram;
 
     // Scanline clock counter
     int                         m_scanline_counter;
+
+    // Hide a device from the CPU, keeping it in device so it can be mapped back, or map it back
+    void _set_unmapped(gb_memory_mapped_device_ptr& device, uint16_t addr, uint16_t size, bool unmapped);
+
+    // Start new scanline and LCD mode spans in the trace if they changed this update
+    void _trace(gb_tracer& tracer, uint8_t prev_ly, uint8_t ly, uint8_t prev_mode, uint8_t mode);
 };
 
 using gb_lcd_ptr = std::shared_ptr<gb_lcd>;
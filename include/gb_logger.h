@@ -7,9 +7,16 @@
 #ifndef GB_LOGGER_H_
 #define GB_LOGGER_H_
 
+#include <cstddef>
+#include <atomic>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 
-#define GB_LOGGER(x) if ((x > gb_logger::instance().get_level()) && !(x == GB_LOG_TRACE && gb_logger::instance().is_tracing())) {} else gb_logger::instance()
+// The level is checked before anything is formatted, filtered messages cost a load and a compare
+#define GB_LOGGER(logger, x) if (!(logger).is_enabled(x)) {} else (logger)
 
 // Log levels
 // FATAL: These are events that cause the program to terminate
@@ -27,22 +34,67 @@ enum gb_logger_level_t {
     GB_LOG_TRACE
 };
 
+// Every emulator instance has its own logger. Messages are terminated by a flush (i.e. std::endl)
+// In asynchronous mode (the default) each completed message is copied into a lock-free single-producer/single-consumer
+// ring and written to the stream by a background thread, which is only started once something is logged.
+// In synchronous mode everything is written straight through to the stream on the calling thread
 class gb_logger : public std::ostream {
 public:
-    static gb_logger& instance();
+    gb_logger(std::ostream& o = std::cout);
+    virtual ~gb_logger() override;
+
     void set_stream(std::ostream& o);
     void set_level(gb_logger_level_t log_level);
     void enable_tracing(bool enabled);
     gb_logger_level_t get_level() const;
     bool is_tracing() const;
 
-protected:
-    gb_logger();
-    virtual ~gb_logger();
+    bool is_enabled(gb_logger_level_t log_level) const {
+        return (log_level == GB_LOG_TRACE) ? m_tracing : (log_level <= m_log_level);
+    }
+
+    // Switch between asynchronous and synchronous mode. Anything already queued is written out first
+    void set_async(bool async);
+
+    // Block until every queued message has been written to the stream
+    void drain();
 
 private:
-    gb_logger_level_t m_log_level;
-    bool              m_tracing;
+    class gb_logger_buf : public std::streambuf {
+    public:
+        gb_logger_buf(gb_logger& logger);
+
+    protected:
+        virtual int overflow(int c) override;
+        virtual std::streamsize xsputn(const char* s, std::streamsize n) override;
+        virtual int sync() override;
+
+    private:
+        gb_logger&  m_logger;
+        std::string m_message;
+    };
+
+    // Must be a power of 2
+    static constexpr size_t GB_LOGGER_QUEUE_SIZE = 0x10000;
+
+    gb_logger_buf           m_buf;
+    std::ostream*           m_stream;
+    std::mutex              m_stream_mutex;
+    gb_logger_level_t       m_log_level;
+    bool                    m_tracing;
+    bool                    m_async;
+
+    // The ring buffer is only allocated with the writer thread. The producer owns m_head, the writer owns m_tail
+    std::unique_ptr<char[]> m_queue;
+    std::atomic<size_t>     m_head;
+    std::atomic<size_t>     m_tail;
+    std::atomic<bool>       m_stop;
+    std::thread             m_writer;
+
+    void _write(const char* s, size_t n);
+    void _push(const char* s, size_t n);
+    void _writer();
+    void _stop_writer();
 };
 
 #endif // GB_LOGGER_H_
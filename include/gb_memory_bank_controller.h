@@ -7,6 +7,10 @@
 #ifndef GB_MEMORY_BANK_CONTROLLER_
 #define GB_MEMORY_BANK_CONTROLLER_
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
 #include "gb_memory_map.h"
 #include "gb_rom.h"
 #include "gb_ram.h"
@@ -14,6 +18,16 @@
 
 namespace gb_memory_bank_controller {
     gb_memory_mapped_device_ptr make_mbc(gb_memory_manager& memory_manager, gb_memory_map& memory_map, const std::string& rom_filename);
+
+    // Same as above but the ROM image is already in memory. The image is copied into the memory manager
+    gb_memory_mapped_device_ptr make_mbc(gb_memory_manager& memory_manager, gb_memory_map& memory_map, const uint8_t* rom_data, size_t rom_data_size);
+
+    // Same as above for the ROM that's already set in the memory manager (i.e. shared with the emulator being cloned)
+    gb_memory_mapped_device_ptr make_mbc(gb_memory_manager& memory_manager, gb_memory_map& memory_map);
+
+    // The MBCs map the cartridge RAM or RTC in and out of 0xA000 - 0xBFFF, so that is part of their state along with the bank numbers
+    void save_state(gb_state_writer& state, gb_memory_map& memory_map, const gb_rom_ptr& rom, const gb_ram_ptr& ram, const gb_rtc_ptr& rtc);
+    void load_state(gb_state_reader& state, gb_memory_map& memory_map, const gb_rom_ptr& rom, const gb_ram_ptr& ram, const gb_rtc_ptr& rtc);
 }
 
 class gb_mbc1 : public gb_memory_mapped_device {
@@ -22,6 +36,9 @@ public:
 
     virtual void write_byte(uint16_t addr, uint8_t val) override;
     virtual uint8_t read_byte(uint16_t addr) override;
+    virtual void save_state(gb_state_writer& state) const override;
+    virtual void load_state(gb_state_reader& state) override;
+    virtual unsigned long get_current_bank() const override;
 
 private:
     gb_memory_map& m_memory_map;
@@ -36,6 +53,8 @@ public:
 
     virtual void write_byte(uint16_t addr, uint8_t val) override;
     virtual uint8_t read_byte(uint16_t addr) override;
+    virtual void save_state(gb_state_writer& state) const override;
+    virtual void load_state(gb_state_reader& state) override;
 
 private:
     gb_memory_map& m_memory_map;
@@ -49,6 +68,9 @@ public:
 
     virtual void write_byte(uint16_t addr, uint8_t val) override;
     virtual uint8_t read_byte(uint16_t addr) override;
+    virtual void save_state(gb_state_writer& state) const override;
+    virtual void load_state(gb_state_reader& state) override;
+    virtual unsigned long get_current_bank() const override;
 
 private:
     gb_memory_map& m_memory_map;
@@ -64,6 +86,9 @@ public:
 
     virtual void write_byte(uint16_t addr, uint8_t val) override;
     virtual uint8_t read_byte(uint16_t addr) override;
+    virtual void save_state(gb_state_writer& state) const override;
+    virtual void load_state(gb_state_reader& state) override;
+    virtual unsigned long get_current_bank() const override;
 
 private:
     gb_memory_map& m_memory_map;
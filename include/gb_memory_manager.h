@@ -7,14 +7,23 @@
 #ifndef GB_MEMORY_MANAGER_H_
 #define GB_MEMORY_MANAGER_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
+#include <memory>
+
+#include "gb_state.h"
 
 // This is the class that manages all the memory allocation needed by gb_memory_mapped_device's
 // The idea is to have all gb_memory_mapped_device's memory be coalesced into one vector instead
 // of each gb_memory_mapped_device allocating it's own vectors. This should help with having all // gameboy memory accesses be temporally and spatially localized
+// The cartridge ROM is the exception; it's kept in a separate buffer that is never written after it's loaded
+// so it can be shared between an emulator and all of its clones
 class gb_memory_manager {
 public:
+    using gb_rom_data_t   = std::vector<uint8_t>;
+    using gb_rom_data_ptr = std::shared_ptr<gb_rom_data_t>;
+
     gb_memory_manager();
     ~gb_memory_manager();
 
@@ -32,10 +41,28 @@ public:
     uint8_t read_byte(unsigned long addr);
     void write_byte(unsigned long addr, uint8_t val);
 
+    // Set the ROM buffer, possibly shared with other memory managers
+    void set_rom(gb_rom_data_ptr rom);
+    gb_rom_data_ptr get_rom() const;
+    size_t get_rom_size() const;
+
+    // Same as get_mem/read_byte but addr is an offset into the ROM buffer
+    uint8_t* get_rom_mem(unsigned long addr);
+    uint8_t read_rom_byte(unsigned long addr) const;
+
+    // Total number of bytes allocated
+    size_t get_size() const;
+
+    // The whole arena is saved and restored with a single memcpy; the ROM isn't part of the state
+    // Loading fails if the state was saved with a different arena layout (i.e. another cartridge type)
+    void save_state(gb_state_writer& state) const;
+    void load_state(gb_state_reader& state);
+
 private:
     using gb_mem_t = std::vector<uint8_t>;
 
-    gb_mem_t m_mem;
+    gb_mem_t        m_mem;
+    gb_rom_data_ptr m_rom;
 };
 
 #endif // GB_MEMORY_MANAGER_H_
@@ -11,6 +11,10 @@
 #include <array>
 
 #include "gb_memory_mapped_device.h"
+#include "gb_memory_profiler.h"
+#include "gb_tracer.h"
+#include "gb_perf_counters.h"
+#include "gb_logger.h"
 
 #define GB_MEMORY_MAP_IO_BASE           (0xFF00)
 #define GB_MEMORY_MAP_SIZE              (0x10000)
@@ -27,7 +31,7 @@
 
 class gb_memory_map {
 public:
-    gb_memory_map();
+    gb_memory_map(gb_logger& logger);
     ~gb_memory_map();
 
     void add_readable_device(const gb_memory_mapped_device_ptr device, uint16_t start_addr, size_t size);
@@ -39,6 +43,43 @@ public:
     uint8_t read_byte(uint16_t addr);
     void write_byte(uint16_t addr, uint8_t val);
 
+    // Read for OAM DMA, which isn't the CPU so the read isn't added to the performance counters' reads
+    uint8_t read_byte_dma(uint16_t addr);
+
+    // Get the bank number mapped at the given address; ROM banks are numbered from the start of the cartridge ROM
+    unsigned long get_current_bank(uint16_t addr);
+
+    // The logger of the emulator instance this memory map belongs to
+    gb_logger& get_logger();
+
+    // Emulated time in CPU cycles, advanced by the emulator as instructions are run
+    // Devices that need the time of day (i.e. the MBC3 RTC) use this instead of the host clock so runs are reproducible
+    uint64_t get_cycles() const {
+        return m_cycles;
+    }
+
+    void add_cycles(int cycles) {
+        m_cycles += static_cast<uint64_t>(cycles);
+    }
+
+    void set_cycles(uint64_t cycles);
+
+    // The timeline tracer shared by the devices, nullptr if tracing is off. Bank switches are traced by the memory map itself
+    void set_tracer(gb_tracer_ptr tracer);
+
+    gb_tracer* get_tracer() const {
+        return m_tracer.get();
+    }
+
+    // The instance's performance counters, updated by the memory map and the devices that have a reference to it
+    gb_perf_counters& get_counters() {
+        return m_counters;
+    }
+
+#ifdef GB_MEMORY_PROFILER
+    gb_memory_profiler& get_profiler();
+#endif
+
 private:
     template <size_t S>
     using gb_device_map_t     = std::array<gb_memory_mapped_device_ptr, S>;
@@ -54,6 +95,22 @@ private:
     gb_device_map_t<GB_MEMORY_MAP_LOMEM_NUM_BUCKETS> m_lomem_writeable_devices;
     gb_device_map_t<GB_MEMORY_MAP_HIMEM_NUM_BUCKETS> m_himem_readable_devices;
     gb_device_map_t<GB_MEMORY_MAP_HIMEM_NUM_BUCKETS> m_himem_writeable_devices;
+    gb_logger&                                       m_logger;
+    uint64_t                                         m_cycles;
+    gb_tracer_ptr                                    m_tracer;
+    gb_perf_counters                                 m_counters;
+
+#ifdef GB_MEMORY_PROFILER
+    gb_memory_profiler m_profiler;
+
+    // Performs the write and counts any ROM or RAM bank switches caused by it
+    void _profile_write(const gb_memory_mapped_device_ptr& device, uint16_t addr, uint8_t val);
+#endif
+
+    unsigned long _get_current_bank(const gb_memory_mapped_device_ptr& device, uint16_t addr) const;
+
+    // Count and trace each bank that's different from the banks mapped before an MBC write
+    void _record_bank_switch(const gb_memory_mapped_device_ptr& mbc, unsigned long rom_bank, unsigned long ram_bank);
 
     template <size_t S>
     void _add_device_to_map(gb_device_map_t<S>& device_map, const gb_memory_mapped_device_ptr& device, uint16_t start_addr, size_t size, size_t bucket_size);
@@ -13,6 +13,7 @@
 #include <memory>
 
 #include "gb_memory_manager.h"
+#include "gb_state.h"
 
 using gb_address_range_t = std::tuple<uint16_t,size_t>;
 
@@ -27,6 +28,14 @@ public:
     virtual unsigned long translate(uint16_t addr) const;
     virtual uint8_t read_byte(uint16_t addr);
     virtual void write_byte(uint16_t addr, uint8_t val);
+    // Banked devices (i.e. cartridge ROM & RAM) return the bank currently mapped in, everything else is bank 0
+    // The MBCs return the cartridge RAM bank they have selected, even while the RAM isn't mapped
+    virtual unsigned long get_current_bank() const;
+
+    // Save and restore any state the device keeps outside of the memory manager (counters, bank numbers etc.)
+    // Memory backed by the memory manager is saved separately. The default implementation has nothing to save
+    virtual void save_state(gb_state_writer& state) const;
+    virtual void load_state(gb_state_reader& state);
 
 protected:
     uint16_t             m_start_addr;
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_MEMORY_PROFILER_H_
+#define GB_MEMORY_PROFILER_H_
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <string>
+#include <ostream>
+
+#define GB_MEMORY_PROFILER_PAGE_SIZE (0x100)
+#define GB_MEMORY_PROFILER_NUM_PAGES (0x10000/GB_MEMORY_PROFILER_PAGE_SIZE)
+
+// Counts guest memory accesses per 256 byte page and per ROM/RAM bank as well as the number of MBC bank switches per frame
+// The memory map and CPU only call into the profiler when built with GB_MEMORY_PROFILER defined (-DGOODBOY_MEMORY_PROFILER=ON)
+class gb_memory_profiler {
+public:
+    enum gb_bank_type_t {
+        GB_BANK_ROM,
+        GB_BANK_RAM
+    };
+
+    gb_memory_profiler();
+    ~gb_memory_profiler();
+
+    void record_read(uint16_t addr, unsigned long bank);
+    void record_write(uint16_t addr, unsigned long bank);
+    void record_execute(uint16_t addr, unsigned long bank);
+    void record_bank_switch(gb_bank_type_t bank_type);
+
+    // Close out the bank switch counts for the current frame
+    void end_frame();
+    void reset();
+
+    void export_csv(std::ostream& os) const;
+    void export_json(std::ostream& os) const;
+
+    // Export to a file; the format is picked based on the file extension (.json, otherwise csv)
+    void export_to_file(const std::string& filename) const;
+
+private:
+    struct gb_access_counts_t {
+        uint64_t reads;
+        uint64_t writes;
+        uint64_t executes;
+    };
+
+    struct gb_frame_bank_switches_t {
+        uint32_t rom;
+        uint32_t ram;
+    };
+
+    using gb_page_counts_t = std::array<gb_access_counts_t, GB_MEMORY_PROFILER_NUM_PAGES>;
+    using gb_bank_counts_t = std::vector<gb_access_counts_t>;
+
+    gb_page_counts_t                      m_pages;
+    gb_bank_counts_t                      m_rom_banks;
+    gb_bank_counts_t                      m_ram_banks;
+    gb_frame_bank_switches_t              m_cur_frame;
+    std::vector<gb_frame_bank_switches_t> m_frames;
+
+    // Returns nullptr for addresses that aren't banked (i.e. outside cartridge ROM and RAM)
+    gb_access_counts_t* _get_bank_counts(uint16_t addr, unsigned long bank);
+};
+
+#endif // GB_MEMORY_PROFILER_H_
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_MOVIE_H_
+#define GB_MOVIE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+// Bump this whenever the movie file layout changes
+#define GB_MOVIE_VERSION (1)
+
+// Movie files are a header (magic "GBMV", version, ROM hash, frame count, start state size) followed by the start state
+// and then the buttons as runs of [uint32 number of frames][uint8 button mask], all in host byte order
+#define GB_MOVIE_MAGIC   (0x564D4247u)
+
+// A recording of the buttons held on every frame, starting from a save state
+// The emulator is deterministic given its inputs so replaying a movie from its start state reproduces the run exactly
+// The button mask for a frame uses the same bits as gb_input::get_buttons and is sampled before the frame is run
+class gb_movie {
+public:
+    gb_movie();
+
+    // Clear the movie and start a new one from the given state
+    void start(uint64_t rom_hash, const std::vector<uint8_t>& start_state);
+
+    // Append the buttons held for the next frame
+    void add_frame(uint8_t buttons);
+
+    // Get the buttons held on the given frame, no buttons are held after the end of the movie
+    uint8_t get_buttons(uint64_t frame) const;
+
+    uint64_t get_frame_count() const;
+    uint64_t get_rom_hash() const;
+    const std::vector<uint8_t>& get_start_state() const;
+
+    // Throws std::runtime_error if the file can't be written or read or isn't a movie from this version
+    void save(const std::string& filename) const;
+    void load(const std::string& filename);
+
+    // 64-bit FNV-1a, used to tie movies to a ROM and to compare the final state of replays
+    static uint64_t hash(const uint8_t* data, size_t size);
+
+private:
+    struct gb_movie_run_t {
+        uint64_t first_frame;
+        uint8_t  buttons;
+    };
+
+    using gb_movie_runs_t = std::vector<gb_movie_run_t>;
+
+    uint64_t             m_rom_hash;
+    std::vector<uint8_t> m_start_state;
+    gb_movie_runs_t      m_runs;
+    uint64_t             m_frame_count;
+};
+
+using gb_movie_ptr = std::shared_ptr<gb_movie>;
+
+#endif // GB_MOVIE_H_
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_NULL_RENDERER_H_
+#define GB_NULL_RENDERER_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "gb_renderer.h"
+
+// A renderer without a window. The framebuffer is still drawn to by the PPU but nothing is presented and
+// there is no frame limiter so the emulator runs as fast as the host allows
+class gb_null_renderer : public gb_renderer {
+public:
+    // Close after max_frames updates, 0 never closes on its own
+    gb_null_renderer(uint64_t max_frames = 0);
+    virtual ~gb_null_renderer() override;
+
+    virtual bool is_open() override;
+    virtual void close() override;
+    virtual void update(bool draw_framebuffer) override;
+
+    // Number of times update has been called
+    uint64_t get_frame_count() const;
+
+private:
+    bool     m_open;
+    uint64_t m_max_frames;
+    uint64_t m_frame_count;
+};
+
+using gb_null_renderer_ptr = std::shared_ptr<gb_null_renderer>;
+
+#endif // GB_NULL_RENDERER_H_
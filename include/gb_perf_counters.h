@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_PERF_COUNTERS_H_
+#define GB_PERF_COUNTERS_H_
+
+#include <cstdint>
+#include <array>
+#include <ostream>
+
+// Memory regions in address order. Echo RAM is counted as work RAM, the unusable area after OAM as OAM and IE as IO
+enum gb_perf_region_t {
+    GB_PERF_REGION_ROM0,
+    GB_PERF_REGION_ROMX,
+    GB_PERF_REGION_VRAM,
+    GB_PERF_REGION_CART_RAM,
+    GB_PERF_REGION_WRAM,
+    GB_PERF_REGION_OAM,
+    GB_PERF_REGION_IO,
+    GB_PERF_REGION_HRAM,
+    GB_PERF_REGION_COUNT
+};
+
+#define GB_PERF_NUM_INTERRUPTS (5)
+
+// Event counts kept by the core of an emulator instance, like the hardware performance counters of a real CPU
+// They're plain integers updated inline by the memory map, CPU, DMA and emulator so they're always on. Frames run
+// ahead and thrown away aren't counted, and the counters aren't part of the save state
+struct gb_perf_counters {
+    using gb_region_counts_t    = std::array<uint64_t, GB_PERF_REGION_COUNT>;
+    using gb_interrupt_counts_t = std::array<uint64_t, GB_PERF_NUM_INTERRUPTS>;
+
+    // Instructions retired, idle steps while the CPU is halted are counted in halt_cycles instead
+    uint64_t              instructions;
+    uint64_t              cycles;
+    uint64_t              halt_cycles;
+
+    // Reads and writes by the CPU, OAM DMA source reads are only counted in dma_bytes
+    gb_region_counts_t    reads;
+    gb_region_counts_t    writes;
+    uint64_t              rom_bank_switches;
+    uint64_t              ram_bank_switches;
+
+    // Interrupts taken, in the order of their flag bits (VBlank, STAT, Timer, Serial, Joypad)
+    gb_interrupt_counts_t interrupts;
+    uint64_t              dma_bytes;
+    uint64_t              frames;
+
+    gb_perf_counters();
+
+    void reset();
+
+    static gb_perf_region_t get_region(uint16_t addr) {
+        static const uint8_t regions[] = {
+            GB_PERF_REGION_ROM0, GB_PERF_REGION_ROM0, GB_PERF_REGION_ROM0, GB_PERF_REGION_ROM0,
+            GB_PERF_REGION_ROMX, GB_PERF_REGION_ROMX, GB_PERF_REGION_ROMX, GB_PERF_REGION_ROMX,
+            GB_PERF_REGION_VRAM, GB_PERF_REGION_VRAM, GB_PERF_REGION_CART_RAM, GB_PERF_REGION_CART_RAM,
+            GB_PERF_REGION_WRAM, GB_PERF_REGION_WRAM, GB_PERF_REGION_WRAM, GB_PERF_REGION_WRAM
+        };
+
+        if (addr < 0xFE00) return static_cast<gb_perf_region_t>(regions[addr >> 12]);
+        if (addr < 0xFF00) return GB_PERF_REGION_OAM;
+        if (addr < 0xFF80 || addr == 0xFFFF) return GB_PERF_REGION_IO;
+        return GB_PERF_REGION_HRAM;
+    }
+
+    void record_read(uint16_t addr) {
+        reads[get_region(addr)]++;
+    }
+
+    void record_write(uint16_t addr) {
+        writes[get_region(addr)]++;
+    }
+
+    // A table with one counter per line
+    void report(std::ostream& os) const;
+
+    // A single line of JSON
+    void export_json(std::ostream& os) const;
+};
+
+#endif // GB_PERF_COUNTERS_H_
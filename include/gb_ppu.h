@@ -8,32 +8,81 @@
 #define GB_PPU_H_
 
 #include <array>
+#include <bitset>
 
 #include "gb_memory_map.h"
 #include "gb_interrupt_source.h"
 #include "gb_framebuffer.h"
+#include "gb_ppu_simd.h"
+
+#define GB_PPU_NUM_TILES (384)
 
 class gb_ppu : public gb_memory_mapped_device, public gb_interrupt_source {
 friend class gb_debugger;
+friend class gb_microbench_fixture;
 public:
     gb_ppu(gb_memory_manager& memory_manager, gb_memory_map& memory_map, gb_framebuffer& framebuffer);
     virtual ~gb_ppu() override;
 
+    virtual void write_byte(uint16_t addr, uint8_t val) override;
     virtual bool update(int cycles) override;
 
+    // Scanlines are rendered lazily; this draws any pending scanlines up to the current LY
+    // Call this before presenting the framebuffer in the middle of a frame
+    void flush();
+
+    // Mark every tile as changed, for VRAM written without going through write_byte
+    void invalidate_tiles();
+
+    // While rendering is off the scanlines are still counted but nothing is drawn, for frames that are never presented
+    void set_render(bool enabled);
+
+    // The framebuffer is saved along with the line counters so lines drawn earlier in the frame survive a load
+    // Loading invalidates the whole tile cache since VRAM is restored behind the PPU's back
+    virtual void save_state(gb_state_writer& state) const override;
+    virtual void load_state(gb_state_reader& state) override;
+
 private:
-    enum gb_ppu_pixel_type_t {
-        GB_PPU_BG_PIXEL,
-        GB_PPU_SPRITE_PIXEL
+    // Writes to any of the registers or memory used by the PPU force it to catch up on rendering
+    // all scanlines up to the current one before the write lands, so mid-frame raster effects still work
+    class gb_ppu_register : public gb_memory_mapped_device {
+    public:
+        gb_ppu_register(gb_memory_manager& memory_manager, gb_ppu& ppu, uint16_t start_addr, size_t size);
+        virtual ~gb_ppu_register() override;
+
+        virtual void write_byte(uint16_t addr, uint8_t val) override;
+
+    private:
+        gb_ppu& m_ppu;
     };
 
-    struct gb_ppu_pixel_t {
-        gb_ppu_pixel_type_t pixel_type;
-        uint8_t             colour_idx;
-        uint8_t             palette;
+    // The LCDC register belongs to the LCD controller. This forwards writes to the LCD after catching up the PPU
+    class gb_ppu_lcdc_register : public gb_memory_mapped_device {
+    public:
+        gb_ppu_lcdc_register(gb_memory_manager& memory_manager, gb_ppu& ppu, gb_memory_mapped_device_ptr lcd);
+        virtual ~gb_ppu_lcdc_register() override;
+
+        virtual void write_byte(uint16_t addr, uint8_t val) override;
+
+    private:
+        gb_ppu&                     m_ppu;
+        gb_memory_mapped_device_ptr m_lcd;
     };
 
-    using gb_ppu_linebuffer_t = std::array<gb_ppu_pixel_t, 160>;
+    using gb_ppu_register_ptr      = std::shared_ptr<gb_ppu_register>;
+    using gb_ppu_lcdc_register_ptr = std::shared_ptr<gb_ppu_lcdc_register>;
+
+    // Snapshot of the registers used to render a batch of scanlines
+    struct gb_ppu_registers_t {
+        uint8_t lcdc;
+        uint8_t scy;
+        uint8_t scx;
+        uint8_t bgp;
+        uint8_t obp0;
+        uint8_t obp1;
+        uint8_t wy;
+        uint8_t wx;
+    };
 
     // Registers used by the PPU
     // bg_scroll - SCY: BG Y Position SCX: BG X Position
@@ -43,27 +92,61 @@ private:
     // bits[3:2] = Colour1
     // bits[1:0] = Colour0
     // win_scroll - WY: Window Y Position (0-143) WX: Window X Position (-7; 0-166))
-    gb_memory_mapped_device_ptr m_ppu_bg_scroll;
-    gb_memory_mapped_device_ptr m_ppu_palette;
-    gb_memory_mapped_device_ptr m_ppu_win_scroll;
+    gb_ppu_register_ptr         m_ppu_bg_scroll;
+    gb_ppu_register_ptr         m_ppu_palette;
+    gb_ppu_register_ptr         m_ppu_win_scroll;
 
     // OAM - Object Attribute Memory used for sprites
     // This memory stores sprite information for 40 sprites
-    gb_memory_mapped_device_ptr m_ppu_oam;
+    gb_ppu_register_ptr         m_ppu_oam;
+
+    gb_ppu_lcdc_register_ptr    m_ppu_lcdc;
+    gb_memory_mapped_device_ptr m_lcd_ly;
 
     // Need a reference to the memory map to access LCD registers
     gb_memory_map&              m_memory_map;
 
     // Reference to framebuffer where pixels will be drawn
     gb_framebuffer&             m_framebuffer;
-    gb_ppu_linebuffer_t         m_linebuffer;
 
-    // Previous scanline
+    // Cache of the tiles in 0x8000 - 0x97FF decoded to 8x8 colour indices, plus copies flipped in X for sprites
+    // Tiles are decoded lazily and invalidated whenever VRAM tile data is written
+    using gb_ppu_tile_cache_t     = std::array<uint8_t, GB_PPU_NUM_TILES * 64>;
+    using gb_ppu_tile_dirty_t     = std::bitset<GB_PPU_NUM_TILES>;
+
+    gb_ppu_tile_cache_t         m_tile_cache;
+    gb_ppu_tile_cache_t         m_tile_cache_flipped;
+    gb_ppu_tile_dirty_t         m_tile_dirty;
+
+    // The linebuffer holds the background/window colour indices (with slack for tiles spilling off the right edge),
+    // the final shade of every pixel and whether a sprite pixel was drawn there (used for background priority)
+    using gb_ppu_bg_linebuffer_t  = std::array<uint8_t, 160 + 8>;
+    using gb_ppu_linebuffer_t     = std::array<uint8_t, 160>;
+
+    gb_ppu_bg_linebuffer_t      m_line_bg;
+    gb_ppu_linebuffer_t         m_line_shade;
+    gb_ppu_linebuffer_t         m_line_sprite;
+
+    // Palette lookup for a whole scanline, vectorized if supported by the host CPU
+    gb_ppu_simd::apply_palette_fn m_apply_palette;
+
+    bool                        m_render;
+
+    // Next scanline to be rendered and the last value of LY seen by update
     int                         m_next_line;
+    int                         m_last_ly;
+
+    // Render all the scanlines that are pending up to and including the current scanline
+    void _catch_up();
+    void _draw_lines(int first_line, int last_line);
+    gb_ppu_registers_t _get_registers();
+
+    void _decode_tile(unsigned int tile);
+    const uint8_t* _get_tile_row(unsigned int tile, unsigned int row, bool flip_x);
 
-    void _draw_background(uint8_t ly);
-    void _draw_window(uint8_t ly);
-    void _draw_sprites(uint8_t ly);
+    void _draw_background(const gb_ppu_registers_t& regs, const uint8_t* vram, uint8_t ly);
+    void _draw_window(const gb_ppu_registers_t& regs, const uint8_t* vram, uint8_t ly);
+    void _draw_sprites(const gb_ppu_registers_t& regs, const uint8_t* oam, uint8_t ly);
 };
 
 using gb_ppu_ptr = std::shared_ptr<gb_ppu>;
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_PPU_SIMD_H_
+#define GB_PPU_SIMD_H_
+
+#include <cstdint>
+#include <cstddef>
+
+// Vectorized helpers used by the PPU scanline renderer
+// On x86 the fastest implementation supported by the host CPU (AVX2, SSSE3 or SSE2) is picked at runtime
+// Every other platform uses the portable scalar implementation
+namespace gb_ppu_simd {
+    enum gb_simd_level_t {
+        GB_SIMD_SCALAR,
+        GB_SIMD_SSE2,
+        GB_SIMD_SSSE3,
+        GB_SIMD_AVX2
+    };
+
+    // Translate colour indices (0-3) into shades using a BGP/OBP style palette
+    using apply_palette_fn = void (*)(const uint8_t* colour_indices, uint8_t palette, uint8_t* shades, size_t size);
+
+    // Best SIMD level supported by the host CPU
+    gb_simd_level_t get_simd_level();
+
+    // Returns the palette implementation for the given SIMD level (clamped to what the host supports)
+    apply_palette_fn get_apply_palette(gb_simd_level_t simd_level);
+    apply_palette_fn get_apply_palette();
+
+    // Expand the two bitplanes of a tile row into 8 colour indices, left to right, and the same row flipped in X
+    void expand_tile_row(uint8_t tile_line_lo, uint8_t tile_line_hi, uint8_t* colour_indices, uint8_t* colour_indices_flipped);
+}
+
+#endif // GB_PPU_SIMD_H_
@@ -19,8 +19,10 @@ public:
 
     virtual unsigned long translate(uint16_t addr) const override;
     virtual uint8_t read_byte(uint16_t addr) override;
-    unsigned long get_current_bank() const;
+    virtual unsigned long get_current_bank() const override;
     void set_current_bank(unsigned long bank);
+    virtual void save_state(gb_state_writer& state) const override;
+    virtual void load_state(gb_state_reader& state) override;
 
 private:
     unsigned long m_ram_size;
@@ -9,19 +9,15 @@
 
 #include <memory>
 
-#include <SFML/Graphics.hpp>
-
 #include "gb_framebuffer.h"
 #include "gb_input.h"
 
-#define GB_WIDTH  (160)
-#define GB_HEIGHT (144)
-
+// The renderer owns the framebuffer the PPU draws into and the button state the joypad reads from
+// and is responsible for presenting the framebuffer every V-blank
 class gb_renderer {
 public:
-    // Create a window at the specified width*height
-    gb_renderer(unsigned int width, unsigned int height);
-    ~gb_renderer();
+    gb_renderer();
+    virtual ~gb_renderer();
 
     // Get a reference to the framebuffer
     gb_framebuffer& get_framebuffer();
@@ -29,23 +25,22 @@ public:
     // Get a reference to the input class
     gb_input& get_input();
 
-    // Check if the window is still open or if it has been closed
-    bool is_open();
+    // Check if the renderer is still open or if it has been closed
+    virtual bool is_open() = 0;
 
-    // Close the window
-    void close();
+    // Close the renderer
+    virtual void close() = 0;
 
     // Update should be called every V-blank
     // draw_framebuffer indicates whether to draw the current contents of the framebuffer or not
     // (depending on if the LCD is on or off)
-    void update(bool draw_framebuffer);
-
-private:
-    sf::RenderWindow m_window;
-    gb_framebuffer   m_framebuffer;
-    sf::Texture      m_texture;
-    sf::Sprite       m_sprite;
-    gb_input         m_input;
+    virtual void update(bool draw_framebuffer) = 0;
+
+protected:
+    gb_framebuffer m_framebuffer;
+    gb_input       m_input;
 };
 
+using gb_renderer_ptr = std::shared_ptr<gb_renderer>;
+
 #endif // GB_RENDERER_H_
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_REWIND_H_
+#define GB_REWIND_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <memory>
+
+// Every GB_REWIND_KEYFRAME_INTERVAL'th snapshot is a keyframe, the ones in between are stored as deltas against it
+#define GB_REWIND_KEYFRAME_INTERVAL (120)
+
+// A fixed-size ring of save states for rewinding
+// Keyframes are run-length encoded and every other snapshot is XOR'd against the last keyframe before being run-length encoded
+// Most of a save state doesn't change from frame to frame so deltas are usually only a few hundred bytes
+// When the ring is full the oldest keyframe is dropped along with all of the deltas that depend on it
+class gb_rewind {
+public:
+    gb_rewind(size_t capacity, unsigned int keyframe_interval = GB_REWIND_KEYFRAME_INTERVAL);
+
+    // Add a snapshot. Snapshots that don't fit in the ring at all are ignored
+    void push(const std::vector<uint8_t>& state);
+
+    // Remove the most recent snapshot and decode it into state. Returns false if the ring is empty
+    bool pop(std::vector<uint8_t>& state);
+
+    // Drop all snapshots
+    void clear();
+
+    // Number of snapshots and the number of bytes they take up in the ring
+    size_t get_count() const;
+    size_t get_size() const;
+    size_t get_capacity() const;
+
+private:
+    struct gb_rewind_entry_t {
+        size_t offset;
+        size_t size;
+        size_t state_size;
+        bool   keyframe;
+    };
+
+    using gb_rewind_ring_t    = std::vector<uint8_t>;
+    using gb_rewind_entries_t = std::deque<gb_rewind_entry_t>;
+
+    gb_rewind_ring_t     m_ring;
+    gb_rewind_entries_t  m_entries;
+    unsigned int         m_keyframe_interval;
+    unsigned int         m_since_keyframe;
+    size_t               m_size;
+
+    // The last keyframe pushed, decoded, so deltas can be encoded against it
+    std::vector<uint8_t> m_keyframe;
+    std::vector<uint8_t> m_scratch;
+
+    // Encode src (XOR ref if ref isn't null) as a list of [zero run length][literal length][literal bytes], lengths are LEB128
+    static void _encode(const uint8_t* src, const uint8_t* ref, size_t size, std::vector<uint8_t>& out);
+
+    // Decode an encoded snapshot into dst which must already hold the reference (or zeros)
+    static void _decode(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_size);
+
+    // Copy an encoded snapshot into the ring, dropping the oldest snapshots to make room
+    // Returns false if it doesn't fit or if it's a delta whose keyframe had to be dropped
+    bool _store(const std::vector<uint8_t>& encoded, size_t state_size, bool keyframe);
+    void _drop_oldest();
+};
+
+using gb_rewind_ptr = std::shared_ptr<gb_rewind>;
+
+#endif // GB_REWIND_H_
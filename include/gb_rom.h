@@ -11,18 +11,26 @@
 #include <string>
 
 #include "gb_memory_mapped_device.h"
+#include "gb_logger.h"
 
+// ROM devices are backed by the memory manager's ROM buffer instead of the arena
+// rom_offset and rom_size select the part of the cartridge ROM this device can bank in
 class gb_rom : public gb_memory_mapped_device {
 public:
-    gb_rom(gb_memory_manager& memory_manager, uint16_t start_addr, size_t size, size_t rom_size);
+    gb_rom(gb_memory_manager& memory_manager, gb_logger& logger, uint16_t start_addr, size_t size, size_t rom_offset, size_t rom_size);
     virtual ~gb_rom() override;
 
+    virtual uint8_t* get_mem() override;
     virtual unsigned long translate(uint16_t addr) const override;
+    virtual uint8_t read_byte(uint16_t addr) override;
     virtual void write_byte(uint16_t addr, uint8_t val) override;
-    unsigned long get_current_bank() const;
+    virtual unsigned long get_current_bank() const override;
     void set_current_bank(unsigned long bank);
+    virtual void save_state(gb_state_writer& state) const override;
+    virtual void load_state(gb_state_reader& state) override;
 
 private:
+    gb_logger&    m_logger;
     unsigned long m_num_banks;
     unsigned long m_cur_bank;
 };
@@ -8,15 +8,20 @@
 #define GB_RTC_H_
 
 #include "gb_memory_mapped_device.h"
+#include "gb_memory_map.h"
 
+// The clock starts at the host's time of day when it's created and then advances with emulated time (the memory map's
+// cycle count) rather than the host clock, so replays and save states see the same time regardless of how fast they run
 class gb_rtc : public gb_memory_mapped_device {
 public:
-    gb_rtc(gb_memory_manager& memory_manager, uint16_t start_addr, size_t size);
+    gb_rtc(gb_memory_manager& memory_manager, gb_memory_map& memory_map, uint16_t start_addr, size_t size);
 
     virtual uint8_t read_byte(uint16_t addr) override;
     virtual void write_byte(uint16_t addr, uint8_t val) override;
     void set_current_register(uint8_t reg);
     void update();
+    virtual void save_state(gb_state_writer& state) const override;
+    virtual void load_state(gb_state_reader& state) override;
 
 private:
     enum gb_rtc_register_t {
@@ -27,7 +32,11 @@ private:
         GB_RTC_DAY_HI  = 4
     };
 
+    gb_memory_map&    m_memory_map;
     gb_rtc_register_t m_current_register;
+
+    // Seconds since the epoch at emulated cycle 0
+    uint64_t          m_base_time;
 };
 
 using gb_rtc_ptr = std::shared_ptr<gb_rtc>;
@@ -11,18 +11,37 @@
 
 #include "gb_memory_mapped_device.h"
 #include "gb_interrupt_source.h"
+#include "gb_logger.h"
 
 class gb_serial_io : public gb_memory_mapped_device, public gb_interrupt_source {
 public:
-    gb_serial_io(gb_memory_manager& memory_manager);
+    gb_serial_io(gb_memory_manager& memory_manager, gb_logger& logger);
     virtual ~gb_serial_io() override;
 
     virtual void write_byte(uint16_t addr, uint8_t val) override;
     virtual bool update(int cycles) override;
 
+    // Only the transfer counter is saved, output already sent to the host isn't part of the machine state
+    virtual void save_state(gb_state_writer& state) const override;
+    virtual void load_state(gb_state_reader& state) override;
+
+    // Every byte transferred out since the device was created
+    const std::string& get_output() const;
+
+    // Print each line of output to the logger as it's completed (enabled by default)
+    void set_echo(bool enabled);
+
+    // Transfers started while capture is off still complete but the bytes aren't added to the output or echoed
+    // Used for frames that are run speculatively and then thrown away (enabled by default)
+    void set_capture(bool enabled);
+
 private:
+    gb_logger&  m_logger;
     std::string m_str;
+    std::string m_output;
     int         m_irq_counter;
+    bool        m_echo;
+    bool        m_capture;
 };
 
 using gb_serial_io_ptr = std::shared_ptr<gb_serial_io>;
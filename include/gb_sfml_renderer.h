@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_SFML_RENDERER_H_
+#define GB_SFML_RENDERER_H_
+
+#include <cstdint>
+#include <array>
+#include <memory>
+
+#include <SFML/Graphics.hpp>
+
+#include "gb_renderer.h"
+
+class gb_sfml_renderer : public gb_renderer {
+public:
+    // Create a window at the specified width*height
+    gb_sfml_renderer(unsigned int width, unsigned int height);
+    virtual ~gb_sfml_renderer() override;
+
+    // Check if the window is still open or if it has been closed
+    virtual bool is_open() override;
+
+    // Close the window
+    virtual void close() override;
+
+    // Poll window events, then present the framebuffer. The window is limited to 60 frames per second
+    virtual void update(bool draw_framebuffer) override;
+
+private:
+    using gb_colour_map_t = std::array<uint32_t, 4>;
+    using gb_rgba_pixels_t = std::array<uint32_t, GB_WIDTH * GB_HEIGHT>;
+
+    sf::RenderWindow m_window;
+    sf::Texture      m_texture;
+    sf::Sprite       m_sprite;
+
+    // The framebuffer colours are translated to RGBA8888 pixels every frame and uploaded to the texture
+    gb_colour_map_t  m_colour_map;
+    alignas(32) gb_rgba_pixels_t m_rgba_pixels;
+
+    void _set_key_state(sf::Keyboard::Key key, bool pressed);
+};
+
+#endif // GB_SFML_RENDERER_H_
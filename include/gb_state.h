@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_STATE_H_
+#define GB_STATE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <type_traits>
+
+// Bump this whenever the layout of any device's state changes; states from other versions are rejected
+#define GB_STATE_VERSION (4)
+
+// Save states are a header followed by each component's state in a fixed order, all in host byte order:
+// magic "GBST", version, the cartridge header (0x134 - 0x14F), CPU, memory manager arena, devices, cycle count
+#define GB_STATE_MAGIC   (0x54534247u)
+
+// Appends raw values to a byte buffer. Components write their fields in the same order they read them back
+class gb_state_writer {
+public:
+    gb_state_writer(std::vector<uint8_t>& buffer);
+
+    // Write into a fixed size buffer instead, throws std::runtime_error if it's too small
+    // With a null buffer nothing is written and the writer only counts the bytes
+    gb_state_writer(uint8_t* data, size_t size);
+
+    void write_bytes(const void* data, size_t size);
+
+    template <typename T>
+    void write(const T& val) {
+        static_assert(std::is_trivially_copyable<T>::value, "gb_state_writer::write - type must be trivially copyable");
+        write_bytes(&val, sizeof(T));
+    }
+
+    // Number of bytes written so far
+    size_t get_size() const;
+
+private:
+    std::vector<uint8_t>* m_buffer;
+    uint8_t*              m_data;
+    size_t                m_capacity;
+    size_t                m_size;
+};
+
+// Reads values back out of a state buffer, throws std::runtime_error if the state is truncated
+class gb_state_reader {
+public:
+    gb_state_reader(const uint8_t* data, size_t size);
+
+    void read_bytes(void* data, size_t size);
+
+    template <typename T>
+    void read(T& val) {
+        static_assert(std::is_trivially_copyable<T>::value, "gb_state_reader::read - type must be trivially copyable");
+        read_bytes(&val, sizeof(T));
+    }
+
+    template <typename T>
+    T read() {
+        T val;
+        read(val);
+        return val;
+    }
+
+    // Number of bytes that haven't been read yet
+    size_t remaining() const;
+
+private:
+    const uint8_t* m_data;
+    size_t         m_size;
+    size_t         m_pos;
+};
+
+#endif // GB_STATE_H_
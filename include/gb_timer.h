@@ -19,6 +19,8 @@ public:
 
     virtual void write_byte(uint16_t addr, uint8_t val) override;
     virtual bool update(int cycles) override;
+    virtual void save_state(gb_state_writer& state) const override;
+    virtual void load_state(gb_state_reader& state) override;
 
 private:
     using gb_timer_clk_select_tbl_t = std::array<int, 4>;
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_TRACER_H_
+#define GB_TRACER_H_
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+// Number of events buffered before they're handed to the writer thread
+#define GB_TRACER_CHUNK_SIZE (4096)
+
+// Each kind of event is shown on its own track (thread) in the trace viewer
+enum gb_trace_track_t {
+    GB_TRACE_TRACK_FRAME,
+    GB_TRACE_TRACK_SCANLINE,
+    GB_TRACE_TRACK_LCD_MODE,
+    GB_TRACE_TRACK_CPU,
+    GB_TRACE_TRACK_INTERRUPT,
+    GB_TRACE_TRACK_DMA,
+    GB_TRACE_TRACK_MBC,
+    GB_TRACE_TRACK_COUNT
+};
+
+// The interrupt events are in the order of their flag bits
+enum gb_trace_event_t {
+    GB_TRACE_FRAME,
+    GB_TRACE_SCANLINE,
+    GB_TRACE_MODE_HBLANK,
+    GB_TRACE_MODE_VBLANK,
+    GB_TRACE_MODE_OAM,
+    GB_TRACE_MODE_TRANSFER,
+    GB_TRACE_HALT,
+    GB_TRACE_IRQ_VBLANK,
+    GB_TRACE_IRQ_STAT,
+    GB_TRACE_IRQ_TIMER,
+    GB_TRACE_IRQ_SERIAL,
+    GB_TRACE_IRQ_JOYPAD,
+    GB_TRACE_DMA,
+    GB_TRACE_ROM_BANK,
+    GB_TRACE_RAM_BANK,
+    GB_TRACE_LOAD_STATE,
+    GB_TRACE_EVENT_COUNT
+};
+
+// Records a timeline of spans and instant events into a Chrome trace event JSON file (chrome://tracing, ui.perfetto.dev)
+// Timestamps are emulated time, converted from CPU cycles, so the trace shows what the guest does and not how long the
+// host took to emulate it. Events are appended as fixed-size records to a chunk, full chunks are converted to JSON and
+// written out by a background thread so recording an event is only a few stores
+// Every track holds at most one open span; starting a new span on a track ends the previous one
+class gb_tracer {
+public:
+    // Throws std::runtime_error if the file can't be opened
+    gb_tracer(const std::string& filename);
+    ~gb_tracer();
+
+    void begin(gb_trace_event_t event, uint64_t cycles, uint32_t arg = 0);
+    void end(gb_trace_track_t track, uint64_t cycles);
+    void instant(gb_trace_event_t event, uint64_t cycles, uint32_t arg = 0);
+
+    // The emulated clock jumped (i.e. a save state was loaded). Later timestamps are shifted so the trace keeps moving forward
+    void rebase(uint64_t old_cycles, uint64_t new_cycles);
+
+    // End all open spans, write out everything that's buffered and finish the file. Called by the destructor if not called before
+    void close(uint64_t cycles);
+
+private:
+    struct gb_trace_record_t {
+        uint64_t cycles;
+        uint32_t arg;
+        uint8_t  event;
+        uint8_t  phase;
+    };
+
+    using gb_trace_chunk_t = std::vector<gb_trace_record_t>;
+    using gb_trace_open_t  = std::array<int, GB_TRACE_TRACK_COUNT>;
+
+    std::ofstream                m_file;
+    gb_trace_chunk_t             m_chunk;
+    uint64_t                     m_offset;
+    uint64_t                     m_last_cycles;
+    bool                         m_closed;
+
+    // The event of the span open on each track, or -1
+    gb_trace_open_t              m_open;
+
+    // Full chunks waiting to be written and empty ones ready for reuse, protected by m_mutex
+    std::deque<gb_trace_chunk_t> m_full;
+    std::vector<gb_trace_chunk_t> m_free;
+    std::mutex                   m_mutex;
+    std::condition_variable      m_cond;
+    bool                         m_stop;
+    std::thread                  m_writer;
+
+    void _record(gb_trace_event_t event, char phase, uint64_t cycles, uint32_t arg) {
+        m_last_cycles = cycles + m_offset;
+        m_chunk.push_back({m_last_cycles, arg, static_cast<uint8_t>(event), static_cast<uint8_t>(phase)});
+        if (m_chunk.size() == GB_TRACER_CHUNK_SIZE) _flush();
+    }
+
+    // Hand the current chunk to the writer thread and start a new one
+    void _flush();
+    void _writer();
+    void _write_chunk(const gb_trace_chunk_t& chunk, std::string& json);
+};
+
+using gb_tracer_ptr = std::shared_ptr<gb_tracer>;
+
+#endif // GB_TRACER_H_
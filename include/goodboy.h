@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GOODBOY_H_
+#define GOODBOY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// C API for embedding the emulator (i.e. through FFI). Every instance is independent, instances may be driven
+// from different threads as long as a single instance is only used by one thread at a time.
+// None of the calls allocate after gb_load_rom_from_memory; buffers are returned as pointers straight into the
+// instance's memory and stay valid until the instance is destroyed
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GB_FRAMEBUFFER_WIDTH  (160)
+#define GB_FRAMEBUFFER_HEIGHT (144)
+
+// Button bits for gb_set_buttons, a set bit means the button is pressed
+#define GB_BUTTON_MASK_DOWN   (0x01u)
+#define GB_BUTTON_MASK_UP     (0x02u)
+#define GB_BUTTON_MASK_LEFT   (0x04u)
+#define GB_BUTTON_MASK_RIGHT  (0x08u)
+#define GB_BUTTON_MASK_START  (0x10u)
+#define GB_BUTTON_MASK_SELECT (0x20u)
+#define GB_BUTTON_MASK_B      (0x40u)
+#define GB_BUTTON_MASK_A      (0x80u)
+
+typedef enum {
+    GB_STATUS_OK               = 0,
+    GB_STATUS_ERROR            = 1,
+    GB_STATUS_INVALID_ARGUMENT = 2,
+    GB_STATUS_UNSUPPORTED      = 3
+} gb_status_t;
+
+typedef enum {
+    GB_RAM_WORK  = 0, // 8KB at 0xC000
+    GB_RAM_HIGH  = 1, // 127 bytes at 0xFF80
+    GB_RAM_VIDEO = 2, // 8KB at 0x8000
+    GB_RAM_OAM   = 3  // 160 bytes at 0xFE00
+} gb_ram_region_t;
+
+#define GB_PERF_COUNTERS_NUM_REGIONS    (8)
+#define GB_PERF_COUNTERS_NUM_INTERRUPTS (5)
+
+// Event counts of an instance since it was created or the counters were last reset. Frames run ahead aren't counted
+typedef struct {
+    uint64_t instructions;                                // Instructions retired, idle steps while halted aren't counted
+    uint64_t cycles;
+    uint64_t halt_cycles;
+    uint64_t reads[GB_PERF_COUNTERS_NUM_REGIONS];         // By the CPU per region: ROM0, ROMX, VRAM, cartridge RAM, WRAM, OAM, IO, HRAM
+    uint64_t writes[GB_PERF_COUNTERS_NUM_REGIONS];
+    uint64_t rom_bank_switches;
+    uint64_t ram_bank_switches;
+    uint64_t interrupts[GB_PERF_COUNTERS_NUM_INTERRUPTS]; // VBlank, STAT, Timer, Serial, Joypad
+    uint64_t dma_bytes;                                   // OAM DMA source reads aren't counted in reads
+    uint64_t frames;
+} gb_perf_counters_t;
+
+typedef struct gb_handle gb_handle_t;
+
+// Create an emulator instance without a window. The guest's serial output isn't echoed. Returns NULL on failure
+gb_handle_t* gb_create(void);
+
+// Create an independent copy of an instance with a ROM loaded. The copy shares the ROM with the original and starts
+// from its current state. Returns NULL on failure (see gb_get_error on the original)
+gb_handle_t* gb_clone(gb_handle_t* gb);
+
+// Destroy an instance created with gb_create or gb_clone
+void gb_destroy(gb_handle_t* gb);
+
+// Load a ROM image and reset the CPU to the state after the bootrom has run. The image is copied.
+// A ROM can only be loaded once per instance
+gb_status_t gb_load_rom_from_memory(gb_handle_t* gb, const uint8_t* rom_data, size_t rom_data_size);
+
+// Run num_frames frames (70224 cycles each) as fast as possible
+gb_status_t gb_run_frames(gb_handle_t* gb, unsigned int num_frames);
+
+// Set the state of all buttons, see GB_BUTTON_MASK_*
+void gb_set_buttons(gb_handle_t* gb, uint8_t mask);
+
+// Get the framebuffer, GB_FRAMEBUFFER_WIDTH*GB_FRAMEBUFFER_HEIGHT bytes row by row, each a colour from 0 (white) to 3 (black)
+const uint8_t* gb_get_framebuffer(gb_handle_t* gb);
+
+// Get a region of RAM. size is set to the size of the region. Returns NULL if no ROM is loaded
+// VRAM and OAM are returned even while the PPU has them locked from the CPU
+uint8_t* gb_get_ram(gb_handle_t* gb, gb_ram_region_t region, size_t* size);
+
+// The PPU keeps the tiles in VRAM decoded and only sees the emulated CPU's writes. Call this after writing tile data
+// through the GB_RAM_VIDEO pointer and before running, so the tiles are decoded again
+void gb_invalidate_vram(gb_handle_t* gb);
+
+// Save the emulator state straight into buf. state_size is always set to the number of bytes needed, which is the same
+// for every state of a ROM. If buf is NULL only the size is returned, if buf_size is too small GB_STATUS_INVALID_ARGUMENT
+// is returned
+gb_status_t gb_save_state(gb_handle_t* gb, uint8_t* buf, size_t buf_size, size_t* state_size);
+
+// Restore the emulator state from a buffer filled by gb_save_state for the same ROM
+gb_status_t gb_load_state(gb_handle_t* gb, const uint8_t* buf, size_t buf_size);
+
+// Copy the instance's performance counters into counters
+gb_status_t gb_get_perf_counters(gb_handle_t* gb, gb_perf_counters_t* counters);
+
+// Set all of the performance counters back to zero
+void gb_reset_perf_counters(gb_handle_t* gb);
+
+// Get a description of the last error returned by a call on this instance
+const char* gb_get_error(gb_handle_t* gb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GOODBOY_H_
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gb_bootrom.h"
+#include "gb_io_defs.h"
+#include "gb_memory_map.h"
+
+gb_bootrom::gb_bootrom(gb_memory_manager& memory_manager, gb_memory_mapped_device_ptr rom, const std::vector<uint8_t>& bootrom)
+    : gb_memory_mapped_device(memory_manager), m_rom(rom), m_bootrom(bootrom)
+{
+    m_start_addr = GB_ROM_ADDR;
+    m_size = GB_MEMORY_MAP_LOMEM_BUCKET_SIZE;
+
+    // The bootrom keeps it's own copy of the image, no memory is needed from the memory manager
+    m_mm_start_addr = 0;
+}
+
+gb_bootrom::~gb_bootrom() {
+}
+
+uint8_t* gb_bootrom::get_mem() {
+    return m_rom->get_mem();
+}
+
+uint8_t gb_bootrom::read_byte(uint16_t addr) {
+    translate(addr);
+    return (addr < m_bootrom.size()) ? m_bootrom[addr] : m_rom->read_byte(addr);
+}
+
+void gb_bootrom::write_byte(uint16_t addr, uint8_t val) {
+    m_rom->write_byte(addr, val);
+}
+
+unsigned long gb_bootrom::get_current_bank() const {
+    return m_rom->get_current_bank();
+}
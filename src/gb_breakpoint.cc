@@ -6,11 +6,14 @@
 
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 #include "gb_breakpoint.h"
 
+#define GB_BREAKPOINT_KEY(bp, bank) ((((bank) & 0xFFFFu) << 16) | ((bp) & 0xFFFFu))
+
 gb_breakpoint_exception::gb_breakpoint_exception(std::string msg, unsigned int val)
-    : std::exception(), m_val(val), m_last_cycle_count(0)
+    : std::exception(), m_val(val)
 {
     std::ostringstream sstr;
     sstr << msg << " 0x" << std::hex << std::setfill('0') << std::setw(4) << m_val;
@@ -22,44 +25,49 @@ gb_breakpoint_exception::gb_breakpoint_exception(unsigned int val)
 {
 }
 
-gb_breakpoint_exception::gb_breakpoint_exception(unsigned int val, int cycles)
-    : gb_breakpoint_exception(val)
-{
-    m_last_cycle_count = cycles;
-}
-
 char const * gb_breakpoint_exception::what() const noexcept {
     return m_msg.c_str();
 }
 
-int gb_breakpoint_exception::get_last_cycle_count() const noexcept {
-    return m_last_cycle_count;
-}
-
 unsigned int gb_breakpoint_exception::get_val() const noexcept {
     return m_val;
 }
 
 gb_breakpoint::gb_breakpoint()
-    : m_breakpoints()
+    : m_breakpoints(), m_bitmap()
 {
+    m_bitmap.fill(0);
 }
 
-void gb_breakpoint::add(unsigned int bp) {
-    m_breakpoints.insert(bp);
+void gb_breakpoint::_update_bitmap(unsigned int bp) {
+    bp &= 0xFFFFu;
+
+    // The address bit stays set as long as there is a breakpoint at that address in any bank
+    bool is_set = std::any_of(m_breakpoints.begin(), m_breakpoints.end(), [bp](unsigned int key) -> bool { return (key & 0xFFFFu) == bp; });
+    uint64_t mask = 1ull << (bp & 0x3f);
+    m_bitmap[bp >> 6] = is_set ? (m_bitmap[bp >> 6] | mask) : (m_bitmap[bp >> 6] & ~mask);
 }
 
-void gb_breakpoint::remove(unsigned int bp) {
-    m_breakpoints.erase(bp);
+void gb_breakpoint::add(unsigned int bp, unsigned int bank) {
+    m_breakpoints.insert(GB_BREAKPOINT_KEY(bp, bank));
+    _update_bitmap(bp);
+}
+
+void gb_breakpoint::remove(unsigned int bp, unsigned int bank) {
+    m_breakpoints.erase(GB_BREAKPOINT_KEY(bp, bank));
+    _update_bitmap(bp);
 }
 
 void gb_breakpoint::clear() {
     m_breakpoints.clear();
+    m_bitmap.fill(0);
 }
-void gb_breakpoint::match(unsigned int val, int cycles) {
-    if (m_breakpoints.count(val) > 0) throw gb_breakpoint_exception(val, cycles);
+
+bool gb_breakpoint::empty() const {
+    return m_breakpoints.empty();
 }
 
-void gb_breakpoint::match(unsigned int val) {
-    match(val, 0);
+bool gb_breakpoint::match(unsigned int val, unsigned int bank) const {
+    if (!test(val)) return false;
+    return (m_breakpoints.count(GB_BREAKPOINT_KEY(val, GB_BREAKPOINT_ANY_BANK)) > 0) || (m_breakpoints.count(GB_BREAKPOINT_KEY(val, bank)) > 0);
 }
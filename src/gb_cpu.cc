@@ -27,8 +27,8 @@
 #define FLAGS_SET_IF_C_BORROW(x,y)  { if ((x) > (y)) FLAGS_SET(FLAGS_C); }
 
 gb_cpu::gb_cpu(gb_memory_map& memory_map)
-    : m_instructions(INSTRUCTIONS_INIT), m_cb_instructions(CB_INSTRUCTIONS_INIT), m_memory_map(memory_map), m_eidi_flag(EIDI_NONE), m_interrupt_enable(true), m_halted(false),
-      m_bp_enabled(false), m_wp_enabled(false), m_bp(), m_wp()
+    : m_instructions(INSTRUCTIONS_INIT), m_cb_instructions(CB_INSTRUCTIONS_INIT), m_memory_map(memory_map), m_logger(memory_map.get_logger()), m_eidi_flag(EIDI_NONE), m_interrupt_enable(true), m_halted(false),
+      m_bp_enabled(false), m_wp_enabled(false), m_magic_bp_enabled(false), m_bp(), m_wp(), m_stop_reason(GB_STOP_NONE), m_stop_addr(0), m_guest_profiler()
 {
     m_registers.af = 0x01b0;
     m_registers.bc = 0x0013;
@@ -47,18 +47,56 @@ void gb_cpu::dump_registers() const {
         m_registers.a, m_registers.f, m_registers.b, m_registers.c, m_registers.d, m_registers.e, m_registers.h, m_registers.l, m_registers.sp, m_registers.pc,
         FLAGS_IS_SET(FLAGS_Z) ? 'Z' : '-', FLAGS_IS_SET(FLAGS_N) ? 'N' : '-', FLAGS_IS_SET(FLAGS_H) ? 'H' : '-', FLAGS_IS_SET(FLAGS_C) ? 'C' : '-');
 
-    GB_LOGGER(GB_LOG_TRACE) << buf << std::endl;
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << buf << std::endl;
 }
 
 uint16_t gb_cpu::get_pc() const {
     return m_registers.pc;
 }
 
+gb_cpu::registers_t gb_cpu::get_registers() const {
+    return m_registers;
+}
+
 void gb_cpu::set_pc(uint16_t pc) {
     m_registers.pc = pc;
 }
 
+void gb_cpu::save_state(gb_state_writer& state) const {
+    state.write(m_registers);
+    state.write(static_cast<uint8_t>(m_eidi_flag));
+    state.write(m_interrupt_enable);
+    state.write(m_halted);
+}
+
+void gb_cpu::load_state(gb_state_reader& state) {
+    state.read(m_registers);
+    m_eidi_flag = static_cast<eidiflag_t>(state.read<uint8_t>());
+    state.read(m_interrupt_enable);
+    state.read(m_halted);
+    m_stop_reason = GB_STOP_NONE;
+}
+
+void gb_cpu::set_magic_breakpoint(bool enabled) {
+    m_magic_bp_enabled = enabled;
+}
+
+gb_stop_reason_t gb_cpu::get_stop_reason() const {
+    return m_stop_reason;
+}
+
+uint16_t gb_cpu::get_stop_addr() const {
+    return m_stop_addr;
+}
+
+void gb_cpu::set_guest_profiler(gb_guest_profiler_ptr guest_profiler) {
+    m_guest_profiler = guest_profiler;
+}
+
 bool gb_cpu::handle_interrupt(uint16_t jump_address) {
+    gb_tracer* tracer = m_memory_map.get_tracer();
+    if (tracer != nullptr && m_halted) tracer->end(GB_TRACE_TRACK_CPU, m_memory_map.get_cycles());
+
     // Always break out of halted mode if an interrupt occurs
     m_halted = false;
 
@@ -73,17 +111,37 @@ bool gb_cpu::handle_interrupt(uint16_t jump_address) {
     // Jump to interrupt address
     m_registers.pc = jump_address;
 
+    if (m_guest_profiler != nullptr) m_guest_profiler->record_interrupt(jump_address, m_registers.sp);
+
+    // The interrupt vectors are 8 bytes apart starting at 0x40 in the order of their flag bits
+    int interrupt = (jump_address - 0x40) >> 3;
+    m_memory_map.get_counters().interrupts[static_cast<size_t>(interrupt)]++;
+    if (tracer != nullptr) tracer->instant(static_cast<gb_trace_event_t>(GB_TRACE_IRQ_VBLANK + interrupt), m_memory_map.get_cycles(), jump_address);
+
     return true;
 }
 
 int gb_cpu::step() {
+    m_stop_reason = GB_STOP_NONE;
+
     // Check if in halted mode, do nothing and return 4 CPU clock cycles (i.e. 1 system clock cycle)
-    if (m_halted) return 4;
+    if (m_halted) {
+        if (m_guest_profiler != nullptr) m_guest_profiler->record_halt(4);
+        m_memory_map.get_counters().halt_cycles += 4;
+        return 4;
+    }
 
     uint8_t opcode = m_memory_map.read_byte(m_registers.pc);
+    m_memory_map.get_counters().instructions++;
+
+#ifdef GB_MEMORY_PROFILER
+    m_memory_map.get_profiler().record_execute(m_registers.pc, m_memory_map.get_current_bank(m_registers.pc));
+#endif
 
     const instruction_t& instruction = m_instructions[opcode];
 
+    if (m_guest_profiler != nullptr) m_guest_profiler->begin_instruction(m_registers.pc, m_memory_map.get_current_bank(m_registers.pc));
+
     if (instruction.op_exec == nullptr) {
         std::string unknown_str ("UNKNOWN");
         _op_print_type0(unknown_str, m_registers.pc, 0, 0);
@@ -98,19 +156,31 @@ int gb_cpu::step() {
     m_eidi_flag = EIDI_NONE;
 
     // Execute instruction and catch any watchpoint exceptions
+    // Watchpoints are hit in the middle of an instruction so the exception is used to unwind out of it
     int cycles = 0;
     gb_cpu::registers_t saved_registers = m_registers;
     try {
         cycles = instruction.op_exec(instruction);
     } catch (const gb_watchpoint_exception& wp) {
-        // Rollback register state
+        // Rollback register state and report the watchpoint to the caller
         m_registers = saved_registers;
-        // Throw watchpoint exception with custom message
-        throw gb_watchpoint_exception("Watchpoing hit:", wp.get_val());
+        m_stop_reason = GB_STOP_WATCHPOINT;
+        m_stop_addr = static_cast<uint16_t>(wp.get_val());
+        return 0;
+    }
+
+    if (m_guest_profiler != nullptr) m_guest_profiler->end_instruction(cycles);
+
+    // Check for breakpoints; the bitmap test filters out almost every instruction before the bank is looked up
+    if (m_bp_enabled && m_bp.test(m_registers.pc) && m_bp.match(m_registers.pc, static_cast<unsigned int>(m_memory_map.get_current_bank(m_registers.pc)))) {
+        m_stop_reason = GB_STOP_BREAKPOINT;
+        m_stop_addr = m_registers.pc;
     }
 
-    // Check for breakpoints
-    if (m_bp_enabled) m_bp.match(m_registers.pc, cycles);
+    if (m_magic_bp_enabled && opcode == 0x40) {
+        m_stop_reason = GB_STOP_MAGIC_BREAKPOINT;
+        m_stop_addr = static_cast<uint16_t>(m_registers.pc - 1);
+    }
 
     return cycles;
 }
@@ -156,6 +226,9 @@ int gb_cpu::_op_exec_halt(const instruction_t& instruction) {
 
     m_halted = true;
 
+    gb_tracer* tracer = m_memory_map.get_tracer();
+    if (tracer != nullptr) tracer->begin(GB_TRACE_HALT, m_memory_map.get_cycles(), pc);
+
     instruction.op_print(instruction.disassembly, pc, 0, 0);
     return instruction.cycles_hi;
 }
@@ -328,6 +401,8 @@ int gb_cpu::_op_exec_call(const instruction_t& instruction) {
         instruction.set_operand(0, m_registers.pc);
         m_registers.pc = jump_pc;
         cycles = instruction.cycles_hi;
+
+        if (m_guest_profiler != nullptr) m_guest_profiler->record_call(jump_pc, m_memory_map.get_current_bank(jump_pc), m_registers.sp);
     }
 
     instruction.op_print(instruction.disassembly, pc, jump_pc, 0);
@@ -341,9 +416,12 @@ int gb_cpu::_op_exec_ret(const instruction_t& instruction) {
     uint16_t do_jump = instruction.get_operand2 == nullptr ? 1 : instruction.get_operand2();
 
     if (do_jump != 0) {
+        uint16_t sp = m_registers.sp;
         uint16_t jump_pc = instruction.get_operand1();
         instruction.set_operand(0, jump_pc);
         cycles = instruction.cycles_hi;
+
+        if (m_guest_profiler != nullptr) m_guest_profiler->record_return(sp);
     }
 
     instruction.op_print(instruction.disassembly, pc, 0, 0);
@@ -363,6 +441,8 @@ int gb_cpu::_op_exec_rst(const instruction_t& instruction) {
     instruction.set_operand(0, m_registers.pc);
     m_registers.pc = jump_pc;
 
+    if (m_guest_profiler != nullptr) m_guest_profiler->record_call(jump_pc, 0, m_registers.sp);
+
     instruction.op_print(instruction.disassembly, pc, jump_pc, 0);
     return instruction.cycles_hi;
 }
@@ -763,14 +843,14 @@ int gb_cpu::_op_exec_ei(const instruction_t& instruction) {
 
 uint8_t gb_cpu::_read_byte(uint16_t addr) {
     // Check for watchpoints
-    if (m_wp_enabled) m_wp.match(addr);
+    if (m_wp_enabled && m_wp.test(addr) && m_wp.match(addr, static_cast<unsigned int>(m_memory_map.get_current_bank(addr)))) throw gb_watchpoint_exception("Watchpoint hit:", addr);
 
     return m_memory_map.read_byte(addr);
 }
 
 void gb_cpu::_write_byte(uint16_t addr, uint8_t val) {
     // Check for watchpoints
-    if (m_wp_enabled) m_wp.match(addr);
+    if (m_wp_enabled && m_wp.test(addr) && m_wp.match(addr, static_cast<unsigned int>(m_memory_map.get_current_bank(addr)))) throw gb_watchpoint_exception("Watchpoint hit:", addr);
 
     m_memory_map.write_byte(addr, val);
 }
@@ -1054,18 +1134,24 @@ void gb_cpu::_operand_set_mem_sp_16(uint16_t addr, uint16_t val) {
 }
 
 void gb_cpu::_op_print_type0(const std::string& disassembly, uint16_t pc, uint16_t operand1, uint16_t operand2) const {
+    // Don't bother formatting the disassembly unless it's going to be logged
+    if (!m_logger.is_enabled(GB_LOG_TRACE)) return;
+
     char out[256];
     snprintf(out, 256, "%04x: %s", pc, disassembly.c_str());
     std::string fmt = out;
-    GB_LOGGER(GB_LOG_TRACE) << fmt << std::endl;
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << fmt << std::endl;
 }
 
 void gb_cpu::_op_print_type1(const std::string& disassembly, uint16_t pc, uint16_t operand1, uint16_t operand2) const {
+    // Don't bother formatting the disassembly unless it's going to be logged
+    if (!m_logger.is_enabled(GB_LOG_TRACE)) return;
+
     char buf[256], out[256];
     snprintf(buf, 256, disassembly.c_str(), operand1);
     snprintf(out, 256, "%04x: %s", pc, buf);
     std::string fmt = out;
-    GB_LOGGER(GB_LOG_TRACE) << fmt << std::endl;
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << fmt << std::endl;
 }
 
 void gb_cpu::_op_print_type2(const std::string& disassembly, uint16_t pc, uint16_t operand1, uint16_t operand2) const {
@@ -1073,11 +1159,14 @@ void gb_cpu::_op_print_type2(const std::string& disassembly, uint16_t pc, uint16
 }
 
 void gb_cpu::_op_print_type3(const std::string& disassembly, uint16_t pc, uint16_t operand1, uint16_t operand2) const {
+    // Don't bother formatting the disassembly unless it's going to be logged
+    if (!m_logger.is_enabled(GB_LOG_TRACE)) return;
+
     char buf[256], out[256];
     snprintf(buf, 256, disassembly.c_str(), operand2);
     snprintf(out, 256, "%04x: %s", pc, buf);
     std::string fmt = out;
-    GB_LOGGER(GB_LOG_TRACE) << fmt << std::endl;
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << fmt << std::endl;
 }
 
 void gb_cpu::_op_print_type4(const std::string& disassembly, uint16_t pc, uint16_t operand1, uint16_t operand2) const {
@@ -14,6 +14,7 @@
 #include <thread>
 #include <chrono>
 #include <bitset>
+#include <iterator>
 
 #include <ncurses.h>
 
@@ -28,11 +29,15 @@
     {"m", "Modify or view a single 8-bit or 16-bit register. Syntax: hl | hl=0xff00"},\
     {"r", "Dump all registers and flags"},\
     {"x", "Examine or modify a single 8-bit memory location. Syntax: 0xff80 | 0xff80=0xff"},\
-    {"b", "Set, clear, delete or list breakpoints. Sytanx: set 0xff80 | del 0xff80 | clear | list"},\
-    {"w", "Set, clear, delete or list watchpoints. Sytanx: set 0xff80 | del 0xff80 | clear | list"},\
+    {"b", "Set, clear, delete or list breakpoints. Sytanx: set [bank:]0xff80 | del [bank:]0xff80 | clear | list"},\
+    {"w", "Set, clear, delete or list watchpoints. Sytanx: set [bank:]0xff80 | del [bank:]0xff80 | clear | list"},\
     {"c", "Continue or halt execution of CPU with instruction tracing enabled"},\
     {"C", "Continue or halt execution of CPU with instruction tracing disabled. Halting will re-enable tracing"},\
+    {"p", "Save or reset the memory access profile. Syntax: save <file.csv|file.json> | reset"},\
+    {"k", "Show or reset the performance counters. Syntax: show | reset"},\
     {"s", "Save the last " GB_DEBUGGER_NWIN_MAX_LINES_STR " of the debugger trace to a file"},\
+    {"v", "Save or load the machine state, without a file the state is kept in memory. Syntax: save [file] | load [file]"},\
+    {"z", "Rewind to an earlier snapshot, requires rewind to be enabled with -r. Syntax: [count]"},\
     {"o", "Sprite viewer; examine the OAM and individual sprite tiles. Syntax: dump | see <0-39>"},\
     {"t", "Tile map viewer; examine the background and window maps and individual tiles. Syntax: dump bg | dump win | see <tile_num>"},\
     {"u", "Scroll up half a page"},\
@@ -55,7 +60,11 @@
     {'w', std::bind(&gb_debugger::_debugger_watchpoints, this)},\
     {'c', std::bind(&gb_debugger::_debugger_toggle_continue, this)},\
     {'C', std::bind(&gb_debugger::_debugger_toggle_continue_and_tracing, this)},\
+    {'p', std::bind(&gb_debugger::_debugger_memory_profile, this)},\
+    {'k', std::bind(&gb_debugger::_debugger_perf_counters, this)},\
     {'s', std::bind(&gb_debugger::_debugger_save_trace, this)},\
+    {'v', std::bind(&gb_debugger::_debugger_state, this)},\
+    {'z', std::bind(&gb_debugger::_debugger_rewind, this)},\
     {'o', std::bind(&gb_debugger::_debugger_sprite_viewer, this)},\
     {'t', std::bind(&gb_debugger::_debugger_tile_map_viewer, this)},\
     {'u', std::bind(&gb_debugger::_debugger_scroll_up_half_pg, this)},\
@@ -114,8 +123,9 @@ public:
     WINDOW*      m_win;
     WINDOW*      m_parent_win;
     ncurses_buf& m_nbuf;
+    gb_logger&   m_logger;
 
-    gb_pad(WINDOW* parent_win, ncurses_buf& nbuf);
+    gb_pad(WINDOW* parent_win, ncurses_buf& nbuf, gb_logger& logger);
     ~gb_pad();
 
     void update_scroll();
@@ -125,8 +135,8 @@ public:
     std::string get_string();
 };
 
-gb_pad::gb_pad(WINDOW* parent_win, ncurses_buf& nbuf)
-    : m_display_from_bottom(false), m_pos(0), m_parent_win(parent_win), m_nbuf(nbuf)
+gb_pad::gb_pad(WINDOW* parent_win, ncurses_buf& nbuf, gb_logger& logger)
+    : m_display_from_bottom(false), m_pos(0), m_parent_win(parent_win), m_nbuf(nbuf), m_logger(logger)
 {
     m_win = newpad(GB_DEBUGGER_NWIN_MAX_LINES, getmaxx(stdscr));
     m_nbuf.set_window(m_win);
@@ -156,7 +166,7 @@ void gb_pad::refresh() {
 }
 
 void gb_pad::wait() {
-    GB_LOGGER(GB_LOG_TRACE) << "Press ENTER to continue...";
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "Press ENTER to continue...";
     refresh();
     for (int c = wgetch(m_win); c != '\n' && c != '\r'; c = wgetch(m_win)) std::this_thread::sleep_for(std::chrono::milliseconds(GB_DEBUGGER_WAIT_MS));
     wmove(m_win, getcury(m_win), 0);
@@ -176,18 +186,18 @@ std::string gb_pad::get_string() {
             }
         } else {
             input.push_back(static_cast<char>(c));
-            GB_LOGGER(GB_LOG_TRACE) << input.back();
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << input.back();
         }
         refresh();
     }
-    GB_LOGGER(GB_LOG_TRACE) << std::endl;
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << std::endl;
     refresh();
     nodelay(m_win, true);
     return input;
 }
 
 gb_debugger::gb_debugger(gb_emulator& emulator)
-    : m_emulator(emulator), m_key_map(KEY_MAP_INIT), m_command_doc(COMMAND_DOC_LIST), m_frame_cycles(0), m_continue(false), m_ppu()
+    : m_emulator(emulator), m_logger(emulator.get_logger()), m_key_map(KEY_MAP_INIT), m_command_doc(COMMAND_DOC_LIST), m_frame_cycles(0), m_continue(false), m_ppu(), m_state()
 {
     // Initialize the ncurses library, disable line-buffering and disable character echoing
     // Enable blocking on getch()
@@ -200,11 +210,11 @@ gb_debugger::gb_debugger(gb_emulator& emulator)
     // https://stackoverflow.com/questions/20126649/ncurses-and-ostream-class-method
     m_nstream = std::make_unique<ncurses_stream>(std::cout, scr);
 
-    m_pad = std::make_unique<gb_pad>(scr, m_nstream->m_tbuf);
+    m_pad = std::make_unique<gb_pad>(scr, m_nstream->m_tbuf, m_logger);
     m_pad->refresh();
 
     // Get a pointer to the ppu
-    m_ppu = std::dynamic_pointer_cast<gb_ppu>(m_emulator.m_memory_map.get_readable_device(GB_VIDEO_RAM_ADDR));
+    m_ppu = m_emulator.m_ppu;
 }
 
 gb_debugger::~gb_debugger() {
@@ -213,17 +223,12 @@ gb_debugger::~gb_debugger() {
 }
 
 void gb_debugger::go() {
-    for(int c = wgetch(m_pad->m_win); c != 'q' && m_emulator.m_renderer.is_open(); c = wgetch(m_pad->m_win)) {
+    for(int c = wgetch(m_pad->m_win); c != 'q' && m_emulator.m_renderer->is_open(); c = wgetch(m_pad->m_win)) {
         if (m_continue) {
-            try {
-                m_frame_cycles += m_emulator.step(1000);
-            } catch (const gb_breakpoint_exception& bp) {
-                // Update cycle count from instruction prior to breakpoint
-                m_frame_cycles += bp.get_last_cycle_count();
-                m_continue = false;
-                gb_logger::instance().enable_tracing(true);
-                GB_LOGGER(GB_LOG_TRACE) << bp.what() << std::endl;
-            }
+            int step_cycles = 0;
+            gb_stop_reason_t stop_reason = m_emulator.step(1000, step_cycles);
+            m_frame_cycles += step_cycles;
+            _debugger_stop(stop_reason);
             m_pad->update_scroll();
         }
 
@@ -235,8 +240,13 @@ void gb_debugger::go() {
         m_pad->refresh();
 
         if (m_frame_cycles >= 70224 || !m_continue) {
+#ifdef GB_MEMORY_PROFILER
+            if (m_frame_cycles >= 70224) m_emulator.m_memory_map.get_profiler().end_frame();
+#endif
+            m_emulator.m_ppu->flush();
+            if (m_frame_cycles >= 70224) m_emulator._record_rewind();
             m_frame_cycles = 0;
-            m_emulator.m_renderer.update(((m_emulator.m_memory_map.read_byte(GB_LCDC_ADDR) & 0x80) != 0));
+            m_emulator.m_renderer->update(((m_emulator.m_memory_map.read_byte(GB_LCDC_ADDR) & 0x80) != 0));
         }
 
         if (!m_continue) std::this_thread::sleep_for(std::chrono::milliseconds(GB_DEBUGGER_WAIT_MS));
@@ -244,31 +254,36 @@ void gb_debugger::go() {
 }
 
 void gb_debugger::_debugger_help() {
-    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf);
+    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf, m_logger);
     pad.m_display_from_bottom = true;
 
     // Go through command documentation and print it starting at eos_y
     for (const std::array<std::string, 2>& command : m_command_doc) {
-        GB_LOGGER(GB_LOG_TRACE) << command[0] << "\t-" << command[1] << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << command[0] << "\t-" << command[1] << std::endl;
     }
 
     pad.wait();
 }
 
 void gb_debugger::_debugger_step_once() {
-    try {
-        m_frame_cycles += m_emulator.step(4);
-    } catch (const gb_breakpoint_exception& bp) {
-        // Update cycle count from instruction prior to breakpoint
-        m_frame_cycles += bp.get_last_cycle_count();
-        m_continue = false;
-        gb_logger::instance().enable_tracing(true);
-        GB_LOGGER(GB_LOG_TRACE) << bp.what() << std::endl;
-    }
+    int step_cycles = 0;
+    gb_stop_reason_t stop_reason = m_emulator.step(4, step_cycles);
+    m_frame_cycles += step_cycles;
+    _debugger_stop(stop_reason);
 
     m_pad->update_scroll();
 }
 
+void gb_debugger::_debugger_stop(gb_stop_reason_t stop_reason) {
+    if (stop_reason == GB_STOP_NONE) return;
+
+    m_continue = false;
+    m_logger.enable_tracing(true);
+
+    const char* msg = (stop_reason == GB_STOP_BREAKPOINT) ? "Breakpoint hit: " : (stop_reason == GB_STOP_WATCHPOINT) ? "Watchpoint hit: " : "LD B,B hit: ";
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << msg << "0x" << std::hex << std::setfill('0') << std::setw(4) << m_emulator.m_cpu.get_stop_addr() << std::endl;
+}
+
 void gb_debugger::_debugger_dump_registers() {
     m_emulator.m_cpu.dump_registers();
     m_pad->update_scroll();
@@ -280,10 +295,10 @@ void gb_debugger::_debugger_modify_register() {
     bool write = false;
 
     {
-        gb_pad pad (m_pad->m_win, m_nstream->m_tbuf);
+        gb_pad pad (m_pad->m_win, m_nstream->m_tbuf, m_logger);
         pad.m_display_from_bottom = true;
 
-        GB_LOGGER(GB_LOG_TRACE) << "Register: ";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "Register: ";
         pad.refresh();
 
         // Wait for input
@@ -298,7 +313,7 @@ void gb_debugger::_debugger_modify_register() {
             reg.erase(std::remove_if(reg.begin(), reg.end(), [] (char c) { return std::isspace(c); }), reg.end());
             std::transform(reg.begin(), reg.end(), reg.begin(), ::tolower);
         } catch (const std::exception& e) {
-            GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_modify_register() -- " << e.what() << std::endl;
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_modify_register() -- " << e.what() << std::endl;
             pad.wait();
             return;
         }
@@ -307,7 +322,7 @@ void gb_debugger::_debugger_modify_register() {
             try {
                 data = static_cast<uint16_t>(std::stoul(input.substr(pos+1), nullptr, 0));
             } catch (const std::exception& e) {
-                GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_modify_register() -- " << e.what() << std::endl;
+                GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_modify_register() -- " << e.what() << std::endl;
                 pad.wait();
                 return;
             }
@@ -349,17 +364,17 @@ void gb_debugger::_debugger_modify_register() {
         } else if (reg == "hl") {
             data = do_reg(std::bind(&gb_cpu::_operand_get_register_hl, &m_emulator.m_cpu), std::bind(&gb_cpu::_operand_set_register_hl, &m_emulator.m_cpu, 0, data));
         } else {
-            GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_modify_register() -- Unknown register: " << reg << std::endl;
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_modify_register() -- Unknown register: " << reg << std::endl;
             pad.wait();
             return;
         }
     }
 
     // Read or write data to a register
-    if (write) GB_LOGGER(GB_LOG_TRACE) << "write: ";
-    else GB_LOGGER(GB_LOG_TRACE) << "read: ";
+    if (write) GB_LOGGER(m_logger, GB_LOG_TRACE) << "write: ";
+    else GB_LOGGER(m_logger, GB_LOG_TRACE) << "read: ";
 
-    GB_LOGGER(GB_LOG_TRACE) << reg << " = " << "0x" << std::setfill('0') << std::setw(4) << std::hex << data << std::endl;
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << reg << " = " << "0x" << std::setfill('0') << std::setw(4) << std::hex << data << std::endl;
     m_pad->update_scroll();
 }
 
@@ -369,10 +384,10 @@ void gb_debugger::_debugger_access_memory() {
     bool write = false;
 
     {
-        gb_pad pad (m_pad->m_win, m_nstream->m_tbuf);
+        gb_pad pad (m_pad->m_win, m_nstream->m_tbuf, m_logger);
         pad.m_display_from_bottom = true;
 
-        GB_LOGGER(GB_LOG_TRACE) << "Address: ";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "Address: ";
         pad.refresh();
 
         // Wait for address input
@@ -386,7 +401,7 @@ void gb_debugger::_debugger_access_memory() {
         try {
             addr = std::stoul(input.substr(0, pos), nullptr, 0);
         } catch (const std::exception& e) {
-            GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_access_memory() -- " << e.what() << std::endl;
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_access_memory() -- " << e.what() << std::endl;
             pad.wait();
             return;
         }
@@ -395,7 +410,7 @@ void gb_debugger::_debugger_access_memory() {
             try {
                 data = std::stoul(input.substr(pos+1), nullptr, 0);
             } catch (const std::exception& e) {
-                GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_access_memory() -- " << e.what() << std::endl;
+                GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_access_memory() -- " << e.what() << std::endl;
                 pad.wait();
                 return;
             }
@@ -405,21 +420,21 @@ void gb_debugger::_debugger_access_memory() {
     // Read or write data to memory
     if (write) {
         m_emulator.m_memory_map.write_byte(static_cast<uint16_t>(addr), static_cast<uint8_t>(data));
-        GB_LOGGER(GB_LOG_TRACE) << "write: ";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "write: ";
     } else {
         data = m_emulator.m_memory_map.read_byte(static_cast<uint16_t>(addr));
-        GB_LOGGER(GB_LOG_TRACE) << "read: ";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "read: ";
     }
 
-    GB_LOGGER(GB_LOG_TRACE) << "0x" << std::setfill('0') << std::setw(4) << std::hex << addr << " = " << "0x" << std::setfill('0') << std::setw(2) << std::hex << data << std::endl;
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "0x" << std::setfill('0') << std::setw(4) << std::hex << addr << " = " << "0x" << std::setfill('0') << std::setw(2) << std::hex << data << std::endl;
     m_pad->update_scroll();
 }
 
 void gb_debugger::_debugger_breakpoints() {
-    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf);
+    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf, m_logger);
     pad.m_display_from_bottom = true;
 
-    GB_LOGGER(GB_LOG_TRACE) << "Breakpoints: ";
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "Breakpoints: ";
     pad.refresh();
 
     // Wait for command input
@@ -432,12 +447,16 @@ void gb_debugger::_debugger_breakpoints() {
     if (tokens.size() >= 1) std::transform(tokens[0].begin(), tokens[0].end(), tokens[0].begin(), ::tolower);
 
     unsigned int data = 0;
-    auto _try_strtoul = [&pad, &data, tokens] () -> bool {
+    unsigned int bank = GB_BREAKPOINT_ANY_BANK;
+    auto _try_strtoul = [this, &pad, &data, &bank, tokens] () -> bool {
         if (tokens.size() <= 1) return false;
         try {
-            data = static_cast<unsigned int>(std::stoul(tokens[1], nullptr, 0));
+            // The address can optionally be qualified with a bank number i.e. bank:address
+            size_t pos = tokens[1].find(':');
+            if (pos != std::string::npos) bank = static_cast<unsigned int>(std::stoul(tokens[1].substr(0, pos), nullptr, 0));
+            data = static_cast<unsigned int>(std::stoul(tokens[1].substr((pos != std::string::npos) ? pos + 1 : 0), nullptr, 0));
         } catch (const std::exception& e) {
-            GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_breakpoints() -- " << e.what() << std::endl;
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_breakpoints() -- " << e.what() << std::endl;
             pad.wait();
             return false;
         }
@@ -445,39 +464,43 @@ void gb_debugger::_debugger_breakpoints() {
     };
 
     auto _print_breakpoints = [this, &pad] () -> void {
-        GB_LOGGER(GB_LOG_TRACE) << "Active breakpoints: ";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "Active breakpoints: ";
         for (auto bp : m_emulator.m_cpu.m_bp.m_breakpoints) {
-            GB_LOGGER(GB_LOG_TRACE) << "0x" << std::hex << std::setfill('0') << std::setw(4) << bp << ", ";
+            unsigned int bank = bp >> 16;
+            if (bank != GB_BREAKPOINT_ANY_BANK) {
+                GB_LOGGER(m_logger, GB_LOG_TRACE) << std::dec << bank << ":";
+            }
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "0x" << std::hex << std::setfill('0') << std::setw(4) << (bp & 0xffff) << ", ";
         }
-        GB_LOGGER(GB_LOG_TRACE) << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::endl;
         pad.wait();
     };
 
     if (tokens.size() == 0) {
     } else if (tokens[0] == "set") {
         if (!_try_strtoul()) return;
-        m_emulator.m_cpu.m_bp.add(data);
+        m_emulator.m_cpu.m_bp.add(data, bank);
         m_emulator.m_cpu.m_bp_enabled = true;
     } else if (tokens[0] == "del") {
         if (!_try_strtoul()) return;
-        m_emulator.m_cpu.m_bp.remove(data);
-        m_emulator.m_cpu.m_bp_enabled = (m_emulator.m_cpu.m_bp.m_breakpoints.size() != 0);
+        m_emulator.m_cpu.m_bp.remove(data, bank);
+        m_emulator.m_cpu.m_bp_enabled = !m_emulator.m_cpu.m_bp.empty();
     } else if (tokens[0] == "clear") {
         m_emulator.m_cpu.m_bp.clear();
         m_emulator.m_cpu.m_bp_enabled = false;
     } else if (tokens[0] == "list") {
         _print_breakpoints();
     } else {
-        GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_breakpoints() -- Unknown command: " << tokens[0] << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_breakpoints() -- Unknown command: " << tokens[0] << std::endl;
         pad.wait();
     }
 }
 
 void gb_debugger::_debugger_watchpoints() {
-    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf);
+    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf, m_logger);
     pad.m_display_from_bottom = true;
 
-    GB_LOGGER(GB_LOG_TRACE) << "Watchpoints: ";
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "Watchpoints: ";
     pad.refresh();
 
     // Wait for command input
@@ -490,12 +513,16 @@ void gb_debugger::_debugger_watchpoints() {
     if (tokens.size() >= 1) std::transform(tokens[0].begin(), tokens[0].end(), tokens[0].begin(), ::tolower);
 
     unsigned int data = 0;
-    auto _try_strtoul = [&pad, &data, tokens] () -> bool {
+    unsigned int bank = GB_BREAKPOINT_ANY_BANK;
+    auto _try_strtoul = [this, &pad, &data, &bank, tokens] () -> bool {
         if (tokens.size() <= 1) return false;
         try {
-            data = static_cast<unsigned int>(std::stoul(tokens[1], nullptr, 0));
+            // The address can optionally be qualified with a bank number i.e. bank:address
+            size_t pos = tokens[1].find(':');
+            if (pos != std::string::npos) bank = static_cast<unsigned int>(std::stoul(tokens[1].substr(0, pos), nullptr, 0));
+            data = static_cast<unsigned int>(std::stoul(tokens[1].substr((pos != std::string::npos) ? pos + 1 : 0), nullptr, 0));
         } catch (const std::exception& e) {
-            GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_watchpoints() -- " << e.what() << std::endl;
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_watchpoints() -- " << e.what() << std::endl;
             pad.wait();
             return false;
         }
@@ -503,40 +530,43 @@ void gb_debugger::_debugger_watchpoints() {
     };
 
     auto _print_watchpoints = [this, &pad] () -> void {
-        GB_LOGGER(GB_LOG_TRACE) << "Active watchpoints: ";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "Active watchpoints: ";
         for (auto wp : m_emulator.m_cpu.m_wp.m_breakpoints) {
-            GB_LOGGER(GB_LOG_TRACE) << "0x" << std::hex << std::setfill('0') << std::setw(4) << wp << ", ";
+            unsigned int bank = wp >> 16;
+            if (bank != GB_BREAKPOINT_ANY_BANK) {
+                GB_LOGGER(m_logger, GB_LOG_TRACE) << std::dec << bank << ":";
+            }
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "0x" << std::hex << std::setfill('0') << std::setw(4) << (wp & 0xffff) << ", ";
         }
-        GB_LOGGER(GB_LOG_TRACE) << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::endl;
         pad.wait();
     };
 
     if (tokens.size() == 0) {
     } else if (tokens[0] == "set") {
         if (!_try_strtoul()) return;
-        m_emulator.m_cpu.m_wp.add(data);
+        m_emulator.m_cpu.m_wp.add(data, bank);
         m_emulator.m_cpu.m_wp_enabled = true;
     } else if (tokens[0] == "del") {
         if (!_try_strtoul()) return;
-        m_emulator.m_cpu.m_wp.add(data);
-        m_emulator.m_cpu.m_wp.remove(data);
-        m_emulator.m_cpu.m_wp_enabled = (m_emulator.m_cpu.m_wp.m_breakpoints.size() != 0);
+        m_emulator.m_cpu.m_wp.remove(data, bank);
+        m_emulator.m_cpu.m_wp_enabled = !m_emulator.m_cpu.m_wp.empty();
     } else if (tokens[0] == "clear") {
         m_emulator.m_cpu.m_wp.clear();
         m_emulator.m_cpu.m_wp_enabled = false;
     } else if (tokens[0] == "list") {
         _print_watchpoints();
     } else {
-        GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_watchpoints() -- Unknown command: " << tokens[0] << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_watchpoints() -- Unknown command: " << tokens[0] << std::endl;
         pad.wait();
     }
 }
 
 void gb_debugger::_debugger_save_trace() {
-    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf);
+    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf, m_logger);
     pad.m_display_from_bottom = true;
 
-    GB_LOGGER(GB_LOG_TRACE) << "Save file: ";
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "Save file: ";
     pad.refresh();
 
     // Wait for command input and attempt to open file
@@ -544,7 +574,7 @@ void gb_debugger::_debugger_save_trace() {
     std::ofstream file (input);
 
     if (!file) {
-        GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_save_trace() -- Can't open file: " << input << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_save_trace() -- Can't open file: " << input << std::endl;
         pad.wait();
         return;
     }
@@ -556,15 +586,167 @@ void gb_debugger::_debugger_save_trace() {
         file << buf << ((buf[c_cnt-1] == '\n' ? "" : "\n"));
     }
 
-    GB_LOGGER(GB_LOG_TRACE) << "Saved to file: " << input << std::endl;
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "Saved to file: " << input << std::endl;
+    pad.wait();
+}
+
+void gb_debugger::_debugger_state() {
+    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf, m_logger);
+    pad.m_display_from_bottom = true;
+
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "State: ";
+    pad.refresh();
+
+    // Wait for command input
+    std::string input = pad.get_string();
+
+    // Tokenize input on whitespace
+    std::istringstream iss (input);
+    std::vector<std::string> tokens;
+    std::copy(std::istream_iterator<std::string>(iss), std::istream_iterator<std::string>(), std::back_inserter(tokens));
+    if (tokens.size() >= 1) std::transform(tokens[0].begin(), tokens[0].end(), tokens[0].begin(), ::tolower);
+
+    if (tokens.size() == 0) return;
+
+    try {
+        if (tokens[0] == "save" && tokens.size() > 1) {
+            m_emulator.save_state(tokens[1]);
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "Saved to file: " << tokens[1] << std::endl;
+        } else if (tokens[0] == "save") {
+            m_state.clear();
+            m_emulator.save_state(m_state);
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "Saved " << std::dec << m_state.size() << " bytes" << std::endl;
+        } else if (tokens[0] == "load" && tokens.size() > 1) {
+            m_emulator.load_state(tokens[1]);
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "Loaded from file: " << tokens[1] << std::endl;
+        } else if (tokens[0] == "load" && !m_state.empty()) {
+            m_emulator.load_state(m_state.data(), m_state.size());
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "Loaded " << std::dec << m_state.size() << " bytes" << std::endl;
+        } else if (tokens[0] == "load") {
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_state() -- No state saved" << std::endl;
+        } else {
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_state() -- Unknown command: " << tokens[0] << std::endl;
+        }
+    } catch (const std::exception& e) {
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_state() -- " << e.what() << std::endl;
+    }
+
+    pad.wait();
+}
+
+void gb_debugger::_debugger_rewind() {
+    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf, m_logger);
+    pad.m_display_from_bottom = true;
+
+    if (m_emulator.m_rewind == nullptr) {
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_rewind() -- Rewind is not enabled" << std::endl;
+        pad.wait();
+        return;
+    }
+
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "Rewind (" << std::dec << m_emulator.m_rewind->get_count() << " snapshots): ";
+    pad.refresh();
+
+    // Wait for command input
+    std::string input = pad.get_string();
+
+    unsigned long count = 1;
+    try {
+        if (!input.empty()) count = std::stoul(input, nullptr, 0);
+    } catch (const std::exception& e) {
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_rewind() -- Invalid count: " << input << std::endl;
+        pad.wait();
+        return;
+    }
+
+    unsigned long rewound = 0;
+    try {
+        for (; rewound < count && m_emulator.rewind(); rewound++);
+    } catch (const std::exception& e) {
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_rewind() -- " << e.what() << std::endl;
+    }
+
+    m_frame_cycles = 0;
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "Rewound " << std::dec << rewound << " snapshots, PC=0x" << std::hex << m_emulator.m_cpu.get_pc() << std::endl;
+
     pad.wait();
 }
 
+void gb_debugger::_debugger_memory_profile() {
+    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf, m_logger);
+    pad.m_display_from_bottom = true;
+
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "Memory profile: ";
+    pad.refresh();
+
+    // Wait for command input
+    std::string input = pad.get_string();
+
+    // Tokenize input on whitespace
+    std::istringstream iss (input);
+    std::vector<std::string> tokens;
+    std::copy(std::istream_iterator<std::string>(iss), std::istream_iterator<std::string>(), std::back_inserter(tokens));
+    if (tokens.size() >= 1) std::transform(tokens[0].begin(), tokens[0].end(), tokens[0].begin(), ::tolower);
+
+#ifdef GB_MEMORY_PROFILER
+    if (tokens.size() == 0) {
+    } else if (tokens[0] == "save" && tokens.size() > 1) {
+        try {
+            m_emulator.save_memory_profile(tokens[1]);
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "Saved to file: " << tokens[1] << std::endl;
+        } catch (const std::exception& e) {
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_memory_profile() -- " << e.what() << std::endl;
+        }
+        pad.wait();
+    } else if (tokens[0] == "reset") {
+        m_emulator.m_memory_map.get_profiler().reset();
+    } else {
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_memory_profile() -- Unknown command: " << tokens[0] << std::endl;
+        pad.wait();
+    }
+#else
+    if (tokens.size() != 0) {
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_memory_profile() -- Memory profiler not enabled, rebuild with -DGOODBOY_MEMORY_PROFILER=ON" << std::endl;
+        pad.wait();
+    }
+#endif
+}
+
+void gb_debugger::_debugger_perf_counters() {
+    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf, m_logger);
+    pad.m_display_from_bottom = true;
+
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "Performance counters: ";
+    pad.refresh();
+
+    // Wait for command input
+    std::string input = pad.get_string();
+
+    // Tokenize input on whitespace
+    std::istringstream iss (input);
+    std::vector<std::string> tokens;
+    std::copy(std::istream_iterator<std::string>(iss), std::istream_iterator<std::string>(), std::back_inserter(tokens));
+    if (tokens.size() >= 1) std::transform(tokens[0].begin(), tokens[0].end(), tokens[0].begin(), ::tolower);
+
+    if (tokens.size() == 0) {
+    } else if (tokens[0] == "show") {
+        std::ostringstream sstr;
+        m_emulator.get_perf_counters().report(sstr);
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::endl << sstr.str();
+        pad.wait();
+    } else if (tokens[0] == "reset") {
+        m_emulator.get_perf_counters().reset();
+    } else {
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_perf_counters() -- Unknown command: " << tokens[0] << std::endl;
+        pad.wait();
+    }
+}
+
 void gb_debugger::_debugger_sprite_viewer() {
-    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf);
+    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf, m_logger);
     pad.m_display_from_bottom = true;
 
-    GB_LOGGER(GB_LOG_TRACE) << "Sprite viewer: ";
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "Sprite viewer: ";
     pad.refresh();
 
     // Wait for command input
@@ -577,12 +759,12 @@ void gb_debugger::_debugger_sprite_viewer() {
     if (tokens.size() >= 1) std::transform(tokens[0].begin(), tokens[0].end(), tokens[0].begin(), ::tolower);
 
     unsigned int data = 0;
-    auto _try_strtoul = [&pad, &data, tokens] () -> bool {
+    auto _try_strtoul = [this, &pad, &data, tokens] () -> bool {
         if (tokens.size() <= 1) return false;
         try {
             data = static_cast<unsigned int>(std::stoul(tokens[1], nullptr, 0));
         } catch (const std::exception& e) {
-            GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_sprite_viewer() -- " << e.what() << std::endl;
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_sprite_viewer() -- " << e.what() << std::endl;
             pad.wait();
             return false;
         }
@@ -593,25 +775,25 @@ void gb_debugger::_debugger_sprite_viewer() {
         return (flags & mask) ? t : std::string("-");
     };
 
-    auto _sprite_hdr = [] () -> void {
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(10) <<  std::setfill(' ') << "sprite";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(10) << "OAM";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(10) << "(x,y)";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(10) << "(x',y')";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(10) << "tile#";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(10) << "flags" << std::endl;
+    auto _sprite_hdr = [this] () -> void {
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(10) <<  std::setfill(' ') << "sprite";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(10) << "OAM";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(10) << "(x,y)";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(10) << "(x',y')";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(10) << "tile#";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(10) << "flags" << std::endl;
     };
 
-    auto _sprite= [&_flag_str] (unsigned int i, uint16_t oam_entry_addr, uint16_t x, uint16_t y, uint16_t tile_num, uint16_t flags) -> void {
+    auto _sprite= [this, &_flag_str] (unsigned int i, uint16_t oam_entry_addr, uint16_t x, uint16_t y, uint16_t tile_num, uint16_t flags) -> void {
         std::ostringstream oam_addr;
         oam_addr << "0x" << std::setw(4) << std::setfill('0') << std::hex << oam_entry_addr;
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(10) << std::dec << i;
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(10) << oam_addr.str();
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(10) << "(" + std::to_string(x) + "," + std::to_string(y) + ")";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(10) << "(" + std::to_string(x-8) + "," + std::to_string(y-16) + ")";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(10) << tile_num;
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(10) << _flag_str(flags, 0x80, "B") + _flag_str(flags, 0x40, "Y") + _flag_str(flags, 0x20, "X") + _flag_str(flags, 0x10, "P");
-        GB_LOGGER(GB_LOG_TRACE) << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(10) << std::dec << i;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(10) << oam_addr.str();
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(10) << "(" + std::to_string(x) + "," + std::to_string(y) + ")";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(10) << "(" + std::to_string(x-8) + "," + std::to_string(y-16) + ")";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(10) << tile_num;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(10) << _flag_str(flags, 0x80, "B") + _flag_str(flags, 0x40, "Y") + _flag_str(flags, 0x20, "X") + _flag_str(flags, 0x10, "P");
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::endl;
     };
 
     auto _dump_oam = [this, &pad, _sprite_hdr, _sprite] () -> void {
@@ -637,18 +819,18 @@ void gb_debugger::_debugger_sprite_viewer() {
 
         _sprite_hdr();
         _sprite(i, oam_entry_addr, x, y, tile_num, flags);
-        GB_LOGGER(GB_LOG_TRACE) << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::endl;
 
         uint16_t sprite_addr = GB_VIDEO_RAM_ADDR + (tile_num * 16);
         // Read the pixel data for the line
         uint8_t sprite_size = (m_emulator.m_memory_map.read_byte(GB_LCDC_ADDR) & 0x4) ? 16 : 8;
         uint8_t obj_palette = (flags & 0x10) ? m_ppu->m_ppu_palette->read_byte(GB_PPU_OBP1_ADDR) : m_ppu->m_ppu_palette->read_byte(GB_PPU_OBP0_ADDR);
 
-        GB_LOGGER(GB_LOG_TRACE) << "tile address: 0x" << std::hex << std::setw(4) << std::setfill('0') << sprite_addr << std::endl << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "tile address: 0x" << std::hex << std::setw(4) << std::setfill('0') << sprite_addr << std::endl << std::endl;
 
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(30) << std::setfill(' ') << "raw";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(30) << "index";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(30) << "colour" << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(30) << std::setfill(' ') << "raw";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(30) << "index";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(30) << "colour" << std::endl;
         for (uint8_t sy = 0 ; sy < sprite_size; sy++) {
             uint8_t line_offset = ((flags & 0x40) ? (sprite_size - 1) - sy : sy) * 2;
             uint8_t sprite_line_lo = m_ppu->read_byte(sprite_addr + line_offset);
@@ -671,7 +853,7 @@ void gb_debugger::_debugger_sprite_viewer() {
 
             std::ostringstream bits;
             bits << sprite_line_hi_bits << " " << sprite_line_lo_bits;
-            GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(30) << bits.str();
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(30) << bits.str();
 
             std::ostringstream indices;
             for (uint8_t sx = 0; sx < 8; sx++) {
@@ -680,7 +862,7 @@ void gb_debugger::_debugger_sprite_viewer() {
 
                 indices << std::bitset<2>(colour_idx) << " ";
             }
-            GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(30) << indices.str();
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(30) << indices.str();
 
             std::ostringstream o_colours;
             for (uint8_t sx = 0; sx < 8; sx++) {
@@ -700,7 +882,7 @@ void gb_debugger::_debugger_sprite_viewer() {
 
                 o_colours << colour_indicator << " ";
             }
-            GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(30) << o_colours.str() << std::endl;
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(30) << o_colours.str() << std::endl;
         }
 
         pad.wait();
@@ -710,7 +892,7 @@ void gb_debugger::_debugger_sprite_viewer() {
     } else if (tokens[0] == "see") {
         if (!_try_strtoul()) return;
         if (data > 39) {
-            GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_sprite_viewer() -- Invalid sprite #: " << data << std::endl;
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_sprite_viewer() -- Invalid sprite #: " << data << std::endl;
             pad.wait();
             return;
         }
@@ -718,16 +900,16 @@ void gb_debugger::_debugger_sprite_viewer() {
     } else if (tokens[0] == "dump") {
         _dump_oam();
     } else {
-        GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_sprite_viewer() -- Unknown command: " << tokens[0] << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_sprite_viewer() -- Unknown command: " << tokens[0] << std::endl;
         pad.wait();
     }
 }
 
 void gb_debugger::_debugger_tile_map_viewer() {
-    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf);
+    gb_pad pad (m_pad->m_win, m_nstream->m_tbuf, m_logger);
     pad.m_display_from_bottom = true;
 
-    GB_LOGGER(GB_LOG_TRACE) << "Tile map viewer: ";
+    GB_LOGGER(m_logger, GB_LOG_TRACE) << "Tile map viewer: ";
     pad.refresh();
 
     // Wait for command input
@@ -740,12 +922,12 @@ void gb_debugger::_debugger_tile_map_viewer() {
     if (tokens.size() >= 1) std::transform(tokens[0].begin(), tokens[0].end(), tokens[0].begin(), ::tolower);
 
     int data = 0;
-    auto _try_strtoul = [&pad, &data, tokens] () -> bool {
+    auto _try_strtoul = [this, &pad, &data, tokens] () -> bool {
         if (tokens.size() <= 1) return false;
         try {
             data = static_cast<int>(std::stoul(tokens[1], nullptr, 0));
         } catch (const std::exception& e) {
-            GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_tile_map_viewer() -- " << e.what() << std::endl;
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_tile_map_viewer() -- " << e.what() << std::endl;
             pad.wait();
             return false;
         }
@@ -757,11 +939,11 @@ void gb_debugger::_debugger_tile_map_viewer() {
         uint8_t palette = m_ppu->m_ppu_palette->read_byte(GB_PPU_BGP_ADDR);
         uint16_t tile_addr = static_cast<uint16_t>(tile_data_addr + ((unsigned_offset ? static_cast<uint8_t>(tile_num) : static_cast<int8_t>(tile_num)) * 16));
 
-        GB_LOGGER(GB_LOG_TRACE) << "tile address: 0x" << std::hex << std::setw(4) << std::setfill('0') << tile_addr << std::endl << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "tile address: 0x" << std::hex << std::setw(4) << std::setfill('0') << tile_addr << std::endl << std::endl;
 
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(30) << std::setfill(' ') << "raw";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(30) << "index";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(30) << "colour" << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(30) << std::setfill(' ') << "raw";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(30) << "index";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(30) << "colour" << std::endl;
         for (uint8_t sy = 0 ; sy < 8; sy++) {
             uint8_t line_offset = sy * 2;
             uint8_t line_lo = m_ppu->read_byte(tile_addr + line_offset);
@@ -769,7 +951,7 @@ void gb_debugger::_debugger_tile_map_viewer() {
 
             std::ostringstream bits;
             bits << std::bitset<8>(line_hi) << " " << std::bitset<8>(line_lo);
-            GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(30) << bits.str();
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(30) << bits.str();
 
             std::ostringstream indices;
             for (uint8_t sx = 0; sx < 8; sx++) {
@@ -778,7 +960,7 @@ void gb_debugger::_debugger_tile_map_viewer() {
 
                 indices << std::bitset<2>(colour_idx) << " ";
             }
-            GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(30) << indices.str();
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(30) << indices.str();
 
             std::ostringstream o_colours;
             for (uint8_t sx = 0; sx < 8; sx++) {
@@ -797,7 +979,7 @@ void gb_debugger::_debugger_tile_map_viewer() {
 
                 o_colours << colour_indicator << " ";
             }
-            GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(30) << o_colours.str() << std::endl;
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(30) << o_colours.str() << std::endl;
         }
 
         pad.wait();
@@ -808,43 +990,43 @@ void gb_debugger::_debugger_tile_map_viewer() {
         int16_t tx = x >> 3;
         int16_t ty = y >> 3;
 
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setfill(' ') << std::setw(20) << "tile map address";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setfill(' ') << std::setw(20) << "tile data address";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setfill(' ') << std::setw(20) << "map pixel location";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setfill(' ') << std::setw(20) << "map tile location";
-        GB_LOGGER(GB_LOG_TRACE) << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setfill(' ') << std::setw(20) << "tile map address";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setfill(' ') << std::setw(20) << "tile data address";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setfill(' ') << std::setw(20) << "map pixel location";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setfill(' ') << std::setw(20) << "map tile location";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::endl;
 
         std::ostringstream map_addr_str, tile_data_addr_str;
         map_addr_str << "0x" << std::setw(4) << std::hex << map_addr;
         tile_data_addr_str << "0x" << std::setw(4) << std::hex << tile_data_addr;
 
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(20) << map_addr_str.str();
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(20) << tile_data_addr_str.str();
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(20) << "(" + std::to_string(x) + "," + std::to_string(y) + ")";
-        GB_LOGGER(GB_LOG_TRACE) << std::left << std::setw(20) << "(" + std::to_string(tx) + "," + std::to_string(ty) + ")";
-        GB_LOGGER(GB_LOG_TRACE) << std::endl << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(20) << map_addr_str.str();
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(20) << tile_data_addr_str.str();
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(20) << "(" + std::to_string(x) + "," + std::to_string(y) + ")";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setw(20) << "(" + std::to_string(tx) + "," + std::to_string(ty) + ")";
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::endl << std::endl;
 
         wattron(pad.m_win, WA_BOLD);
         for (uint16_t i = 0; i < 32; i++) {
-            GB_LOGGER(GB_LOG_TRACE) << std::left << std::setfill(' ') << std::setw(5) << std::dec << static_cast<unsigned int>(i);
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setfill(' ') << std::setw(5) << std::dec << static_cast<unsigned int>(i);
         }
-        GB_LOGGER(GB_LOG_TRACE) << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::endl;
         wattroff(pad.m_win, WA_BOLD);
 
         for (int16_t i = 0; i < 32; i++) {
             for (int16_t j = 0; j < 32; j++) {
                 uint8_t tile_num = m_ppu->read_byte(map_addr + static_cast<uint16_t>(i)*32 + static_cast<uint16_t>(j));
                 if (map_visible && (((i >= ty && i < (ty + 18)) || (i < ((ty + 18) % 32) && wrap)) && ((j >= tx && j < (tx + 20)) || (j < ((tx + 20) % 32) && wrap)))) wattron(pad.m_win, WA_STANDOUT);
-                GB_LOGGER(GB_LOG_TRACE) << std::left << std::setfill(' ') << std::setw(5) << std::dec;
-                if (unsigned_offset) { GB_LOGGER(GB_LOG_TRACE) << static_cast<unsigned int>(tile_num); }
-                else { GB_LOGGER(GB_LOG_TRACE) << static_cast<int>(static_cast<int8_t>(tile_num)); }
+                GB_LOGGER(m_logger, GB_LOG_TRACE) << std::left << std::setfill(' ') << std::setw(5) << std::dec;
+                if (unsigned_offset) { GB_LOGGER(m_logger, GB_LOG_TRACE) << static_cast<unsigned int>(tile_num); }
+                else { GB_LOGGER(m_logger, GB_LOG_TRACE) << static_cast<int>(static_cast<int8_t>(tile_num)); }
                 wattroff(pad.m_win, WA_STANDOUT);
             }
             wattron(pad.m_win, WA_BOLD);
-            GB_LOGGER(GB_LOG_TRACE) <<  std::left << std::setfill(' ') << std::setw(5) << std::dec << static_cast<unsigned int>(i) << std::endl;
+            GB_LOGGER(m_logger, GB_LOG_TRACE) <<  std::left << std::setfill(' ') << std::setw(5) << std::dec << static_cast<unsigned int>(i) << std::endl;
             wattroff(pad.m_win, WA_BOLD);
         }
-        GB_LOGGER(GB_LOG_TRACE) << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << std::endl;
 
         pad.wait();
     };
@@ -856,7 +1038,7 @@ void gb_debugger::_debugger_tile_map_viewer() {
     } else if (tokens[0] == "see") {
         if (!_try_strtoul()) return;
         if (((tile_data_addr == 0x8000) ? !(data >= 0 && data < 256) : !(data >= -128 && data < 128))) {
-            GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_tile_map_viewer() -- Invalid tile #: " << data << std::endl;
+            GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_tile_map_viewer() -- Invalid tile #: " << data << std::endl;
             pad.wait();
             return;
         }
@@ -874,7 +1056,7 @@ void gb_debugger::_debugger_tile_map_viewer() {
         bool map_visible = (lcdc & 0x20) && (lcdc & 0x1) && (scx >=0 && scx < 167) && (scy >=0 && scy < 144);
         _dump_map(map_addr, tile_data_addr, scx-7, scy, map_visible, false);
     } else {
-        GB_LOGGER(GB_LOG_TRACE) << "gb_debugger::_debugger_tile_map_viewer() -- Unknown command: " << tokens[0] << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_TRACE) << "gb_debugger::_debugger_tile_map_viewer() -- Unknown command: " << tokens[0] << std::endl;
         pad.wait();
     }
 }
@@ -912,10 +1094,10 @@ void gb_debugger::_debugger_scroll_dn_one_line() {
 
 void gb_debugger::_debugger_toggle_continue() {
     m_continue = m_continue ? false : true;
-    gb_logger::instance().enable_tracing(true);
+    m_logger.enable_tracing(true);
 }
 
 void gb_debugger::_debugger_toggle_continue_and_tracing() {
     _debugger_toggle_continue();
-    gb_logger::instance().enable_tracing(!m_continue);
+    m_logger.enable_tracing(!m_continue);
 }
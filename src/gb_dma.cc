@@ -19,12 +19,14 @@ void gb_dma::write_byte(uint16_t addr, uint8_t val) {
         // DMA transfers trigger start/restart on every write
         m_bytes_transferred = 0;
         m_delay_cycles = 4;
+
+        gb_tracer* tracer = m_memory_map.get_tracer();
+        if (tracer != nullptr) tracer->begin(GB_TRACE_DMA, m_memory_map.get_cycles(), static_cast<uint32_t>(val << 8));
     }
     gb_memory_mapped_device::write_byte(addr, val);
 }
 
 bool gb_dma::update(int cycles) {
-    m_memory_map.read_byte(GB_DMA_ADDR);
     // If m_bytes is at 160 that means the previous transfer has completed
     if (m_bytes_transferred == 160) return false;
 
@@ -39,10 +41,26 @@ bool gb_dma::update(int cycles) {
     // For every four cycles transfer 1 byte from memory to the OAM
     // The DMA register contains the MSB of the source address
     uint16_t src_addr = static_cast<uint16_t>(read_byte(GB_DMA_ADDR) << 8);
+    int start = m_bytes_transferred;
+    // The source reads are only counted as DMA bytes, not as reads of the source region
     for (int i = n_cycles; i > 0 && m_bytes_transferred < 160; i -= 4, m_bytes_transferred++) {
-        uint8_t src_byte = m_memory_map.read_byte(static_cast<uint16_t>(src_addr + m_bytes_transferred));
+        uint8_t src_byte = m_memory_map.read_byte_dma(static_cast<uint16_t>(src_addr + m_bytes_transferred));
         m_oam->write_byte(static_cast<uint16_t>(GB_PPU_OAM_ADDR + m_bytes_transferred), src_byte);
     }
+    m_memory_map.get_counters().dma_bytes += static_cast<uint64_t>(m_bytes_transferred - start);
+
+    gb_tracer* tracer = m_memory_map.get_tracer();
+    if (tracer != nullptr && m_bytes_transferred == 160) tracer->end(GB_TRACE_TRACK_DMA, m_memory_map.get_cycles());
 
     return false;
 }
+
+void gb_dma::save_state(gb_state_writer& state) const {
+    state.write(m_bytes_transferred);
+    state.write(m_delay_cycles);
+}
+
+void gb_dma::load_state(gb_state_reader& state) {
+    state.read(m_bytes_transferred);
+    state.read(m_delay_cycles);
+}
@@ -7,7 +7,8 @@
 #include <stdexcept>
 #include <sstream>
 #include <fstream>
-#include <cstring>
+#include <iterator>
+#include <algorithm>
 
 #include "gb_emulator.h"
 #include "gb_memory_bank_controller.h"
@@ -18,13 +19,32 @@
 #include "gb_lcd.h"
 #include "gb_ppu.h"
 #include "gb_io_defs.h"
+#include "gb_bootrom.h"
+#include "gb_null_renderer.h"
 
-#define GB_RENDERER_WIDTH  (GB_WIDTH*5)
-#define GB_RENDERER_HEIGHT (GB_HEIGHT*5)
+// The cartridge header (title, licensee, cartridge type, ROM/RAM size and checksums) identifies the ROM a state belongs to
+#define GB_STATE_CARTRIDGE_HEADER_ADDR (0x134)
+#define GB_STATE_CARTRIDGE_HEADER_SIZE (0x1C)
 
-gb_emulator::gb_emulator()
-    : m_renderer(GB_RENDERER_WIDTH, GB_RENDERER_HEIGHT), m_memory_manager(), m_memory_map(), m_cpu(m_memory_map), m_interrupt_controller(m_memory_manager, m_memory_map, m_cpu), m_dma(), m_cycles(0)
+struct gb_state_header_t {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    uint8_t  cartridge_header[GB_STATE_CARTRIDGE_HEADER_SIZE];
+    uint8_t  reserved[4];
+};
+
+gb_emulator::gb_emulator(gb_renderer_ptr renderer)
+    : m_renderer(renderer), m_logger(), m_memory_manager(), m_memory_map(m_logger), m_cpu(m_memory_map), m_interrupt_controller(m_memory_manager, m_memory_map, m_cpu), m_ppu(), m_dma(), m_serial_io(), m_serial_echo(true),
+      m_oam(), m_state_size(0), m_state_arena_offset(0), m_rewind(), m_rewind_interval(GB_EMULATOR_REWIND_INTERVAL), m_rewind_frames(0), m_rewind_state(),
+      m_run_ahead_frames(0), m_run_ahead_state(), m_run_ahead_count(0), m_run_ahead_time(0),
+      m_movie(), m_movie_playing(false), m_movie_frame(0), m_guest_profiler(), m_tracer(), m_perf_counters_file(), m_perf_counters_interval(1), m_perf_counters_frames(0)
 {
+#ifdef GB_HOST_PROFILER
+    m_host_profile_interval = 0;
+    m_host_profile_json = false;
+    m_interrupt_controller.set_host_profiler(&m_host_profiler);
+#endif
 }
 
 gb_emulator::~gb_emulator() {
@@ -36,45 +56,56 @@ bool gb_emulator::_run_bootrom() {
     // If DMG_ROM.bin doesn't exist in the current directory then just skip it
     if (!dmg_file) return false;
 
-    dmg_file.seekg(0, dmg_file.end);
-    int size = std::min(static_cast<int>(dmg_file.tellg()), 0x100);
-    dmg_file.seekg(0, dmg_file.beg);
+    // Only the first 256 bytes of the file are used
+    std::vector<uint8_t> bootrom ((std::istreambuf_iterator<char>(dmg_file)), std::istreambuf_iterator<char>());
+    bootrom.resize(std::min(bootrom.size(), static_cast<size_t>(0x100)));
 
-    // Get the previous ROM entry
+    // Map the DMG bootrom over the game ROM
     gb_memory_mapped_device_ptr game_rom = m_memory_map.get_readable_device(0x0);
-
-    // Save the first 256 where the bootrom will go
-    std::vector<uint8_t> temp (0x100, 0);
-    memcpy(temp.data(), game_rom->get_mem(), 0x100);
-
-    // Load the DMG bootrom
-    dmg_file.read(reinterpret_cast<char*>(game_rom->get_mem()), size);
+    gb_bootrom_ptr boot = std::make_shared<gb_bootrom>(m_memory_manager, game_rom, bootrom);
+    gb_address_range_t addr_range = boot->get_address_range();
+    m_memory_map.add_readable_device(boot, std::get<0>(addr_range), std::get<1>(addr_range));
 
     // Turn off the LCD & background in the LCDC register
     m_memory_map.write_byte(GB_LCDC_ADDR, 0x0);
 
     // Run the bootrom
-    while (m_cpu.get_pc() < 0x100 && m_renderer.is_open()) {
+    while (m_cpu.get_pc() < 0x100 && m_renderer->is_open()) {
         step(70224);
-        m_renderer.update(((m_memory_map.read_byte(GB_LCDC_ADDR) & 0x80) != 0));
+        m_ppu->flush();
+        m_renderer->update(((m_memory_map.read_byte(GB_LCDC_ADDR) & 0x80) != 0));
     }
 
-    // Restore the game ROM
-    memcpy(game_rom->get_mem(), temp.data(), 0x100);
+    // Map the game ROM back in
+    addr_range = game_rom->get_address_range();
+    m_memory_map.add_readable_device(game_rom, std::get<0>(addr_range), std::get<1>(addr_range));
 
     return true;
 }
 
 void gb_emulator::load_rom(const std::string& rom_filename) {
-    // Initialize the memory bank controller which controls the first 32KB of ROM and the 8KB of external RAM
+    _add_devices(gb_memory_bank_controller::make_mbc(m_memory_manager, m_memory_map, rom_filename));
+}
+
+void gb_emulator::load_rom(const uint8_t* rom_data, size_t rom_data_size) {
+    _add_devices(gb_memory_bank_controller::make_mbc(m_memory_manager, m_memory_map, rom_data, rom_data_size));
+}
+
+void gb_emulator::_add_devices(gb_memory_mapped_device_ptr mbc) {
+    // Snapshots from a previous ROM can't be loaded
+    if (m_rewind != nullptr) m_rewind->clear();
+
+    // The memory bank controller controls the first 32KB of ROM and the 8KB of external RAM
     // The MBC listens to writes to the ROM space (0x0 - 0x8000) and configures the ROM/RAM and other devices
     // mapped to the ROM and external RAM space inside the cartridge
-    gb_memory_mapped_device_ptr mbc = gb_memory_bank_controller::make_mbc(m_memory_manager, m_memory_map, rom_filename);
     if (mbc != nullptr) {
         gb_address_range_t addr_range = mbc->get_address_range();
         m_memory_map.add_writeable_device(mbc, std::get<0>(addr_range), std::get<1>(addr_range));
     }
 
+    m_state_devices.clear();
+    if (mbc != nullptr) m_state_devices.push_back(mbc);
+
     // Add 8KB of work RAM (on the gameboy)
     gb_ram_ptr work_ram = std::make_shared<gb_ram>(m_memory_manager, 0xC000, 0x2000, 0x2000);
     gb_address_range_t addr_range = work_ram->get_address_range();
@@ -82,11 +113,13 @@ void gb_emulator::load_rom(const std::string& rom_filename) {
     m_memory_map.add_writeable_device(work_ram, std::get<0>(addr_range), std::get<1>(addr_range));
 
     // Add Serial IO device for printing to terminal
-    gb_serial_io_ptr sio = std::make_shared<gb_serial_io>(m_memory_manager);
-    addr_range = sio->get_address_range();
-    m_memory_map.add_readable_device(sio, std::get<0>(addr_range), std::get<1>(addr_range));
-    m_memory_map.add_writeable_device(sio, std::get<0>(addr_range), std::get<1>(addr_range));
-    m_interrupt_controller.add_interrupt_source(sio);
+    m_serial_io = std::make_shared<gb_serial_io>(m_memory_manager, m_logger);
+    m_serial_io->set_echo(m_serial_echo);
+    addr_range = m_serial_io->get_address_range();
+    m_memory_map.add_readable_device(m_serial_io, std::get<0>(addr_range), std::get<1>(addr_range));
+    m_memory_map.add_writeable_device(m_serial_io, std::get<0>(addr_range), std::get<1>(addr_range));
+    m_interrupt_controller.add_interrupt_source(m_serial_io);
+    m_state_devices.push_back(m_serial_io);
 
     // Add Timer
     gb_timer_ptr timer = std::make_shared<gb_timer>(m_memory_manager);
@@ -94,9 +127,10 @@ void gb_emulator::load_rom(const std::string& rom_filename) {
     m_memory_map.add_readable_device(timer, std::get<0>(addr_range), std::get<1>(addr_range));
     m_memory_map.add_writeable_device(timer, std::get<0>(addr_range), std::get<1>(addr_range));
     m_interrupt_controller.add_interrupt_source(timer);
+    m_state_devices.push_back(timer);
 
     // Add Joypad
-    gb_joypad_ptr joypad = std::make_shared<gb_joypad>(m_memory_manager, m_renderer.get_input());
+    gb_joypad_ptr joypad = std::make_shared<gb_joypad>(m_memory_manager, m_renderer->get_input());
     addr_range = joypad->get_address_range();
     m_memory_map.add_readable_device(joypad, std::get<0>(addr_range), std::get<1>(addr_range));
     m_memory_map.add_writeable_device(joypad, std::get<0>(addr_range), std::get<1>(addr_range));
@@ -114,41 +148,510 @@ void gb_emulator::load_rom(const std::string& rom_filename) {
     m_memory_map.add_readable_device(lcd, std::get<0>(addr_range), std::get<1>(addr_range));
     m_memory_map.add_writeable_device(lcd, std::get<0>(addr_range), std::get<1>(addr_range));
     m_interrupt_controller.add_interrupt_source(lcd);
+    m_state_devices.push_back(lcd);
 
     // Add the Pixel Processing Unit and it's registers
-    gb_ppu_ptr ppu = std::make_shared<gb_ppu>(m_memory_manager, m_memory_map, m_renderer.get_framebuffer());
-    addr_range = ppu->get_address_range();
-    m_memory_map.add_readable_device(ppu, std::get<0>(addr_range), std::get<1>(addr_range));
-    m_memory_map.add_writeable_device(ppu, std::get<0>(addr_range), std::get<1>(addr_range));
-    m_interrupt_controller.add_interrupt_source(ppu);
+    m_ppu = std::make_shared<gb_ppu>(m_memory_manager, m_memory_map, m_renderer->get_framebuffer());
+    addr_range = m_ppu->get_address_range();
+    m_memory_map.add_readable_device(m_ppu, std::get<0>(addr_range), std::get<1>(addr_range));
+    m_memory_map.add_writeable_device(m_ppu, std::get<0>(addr_range), std::get<1>(addr_range));
+    m_interrupt_controller.add_interrupt_source(m_ppu);
+    m_state_devices.push_back(m_ppu);
 
     // Add the DMA
-    gb_memory_mapped_device_ptr oam = m_memory_map.get_readable_device(GB_PPU_OAM_ADDR);
-    m_dma = std::make_shared<gb_dma>(m_memory_manager, m_memory_map, oam);
+    m_oam = m_memory_map.get_readable_device(GB_PPU_OAM_ADDR);
+    m_dma = std::make_shared<gb_dma>(m_memory_manager, m_memory_map, m_oam);
     addr_range = m_dma->get_address_range();
     m_memory_map.add_readable_device(m_dma, std::get<0>(addr_range), std::get<1>(addr_range));
     m_memory_map.add_writeable_device(m_dma, std::get<0>(addr_range), std::get<1>(addr_range));
+    m_state_devices.push_back(m_dma);
+
+    // Every state of a cartridge is the same size so it's counted once, for the header and for load_state to check
+    gb_state_writer counter (nullptr, 0);
+    m_state_size = 0;
+    _save_state(counter);
+    m_state_size = counter.get_size();
 }
 
 int gb_emulator::step(const int num_cycles) {
     int step_cycles = 0;
+    step(num_cycles, step_cycles);
+    return step_cycles;
+}
+
+gb_stop_reason_t gb_emulator::step(const int num_cycles, int& step_cycles) {
+    step_cycles = 0;
     while (step_cycles < num_cycles) {
-        int cycles = m_cpu.step();
-        m_cycles += static_cast<uint64_t>(cycles);
+        int cycles;
+        {
+            GB_HOST_PROFILE_SCOPE(m_host_profiler, gb_host_profiler::GB_SECTION_CPU);
+            cycles = m_cpu.step();
+        }
+        m_memory_map.add_cycles(cycles);
+        m_memory_map.get_counters().cycles += static_cast<uint64_t>(cycles);
         m_interrupt_controller.update(cycles);
-        m_dma->update(cycles);
+        {
+            GB_HOST_PROFILE_SCOPE(m_host_profiler, gb_host_profiler::GB_SECTION_DMA);
+            m_dma->update(cycles);
+        }
         step_cycles += cycles;
+
+        // Let the devices catch up with the instruction before stopping on a breakpoint or watchpoint
+        gb_stop_reason_t stop_reason = m_cpu.get_stop_reason();
+        if (stop_reason != GB_STOP_NONE) return stop_reason;
     }
 
-    return step_cycles;
+    return GB_STOP_NONE;
 }
 
-void gb_emulator::go() {
+void gb_emulator::boot(bool use_bootrom) {
     // Run DMG bootrom if available, otherwise skip to PC=0x0100
-    if (!_run_bootrom()) m_cpu.set_pc(0x0100);
+    if (!use_bootrom || !_run_bootrom()) m_cpu.set_pc(0x0100);
+}
 
-    while (m_renderer.is_open()) {
+void gb_emulator::go() {
+    boot();
+    run();
+}
+
+void gb_emulator::run() {
+    while (m_renderer->is_open()) {
+        run_frames(1);
+    }
+}
+
+unsigned long gb_emulator::run_frames(unsigned long num_frames) {
+    unsigned long frames = 0;
+
+    for (; frames < num_frames && m_renderer->is_open(); frames++) {
+        if (m_movie != nullptr) _movie_frame();
+        if (m_tracer != nullptr) m_tracer->begin(GB_TRACE_FRAME, m_memory_map.get_cycles(), static_cast<uint32_t>(m_memory_map.get_cycles() / 70224));
+
+        // Step backwards through the rewind ring instead of running while the rewind key is held
+        bool rewinding = (m_rewind != nullptr) && (m_movie == nullptr) && m_renderer->get_input().is_hotkey_pressed(GB_HOTKEY_REWIND);
+        if (rewinding) {
+            rewind();
+        } else {
+            // With run-ahead the real frame is never presented, only the last frame run ahead of it is drawn
+            m_ppu->set_render(m_run_ahead_frames == 0);
+            step(70224);
+            m_ppu->set_render(true);
+            m_memory_map.get_counters().frames++;
+        }
+#ifdef GB_MEMORY_PROFILER
+        m_memory_map.get_profiler().end_frame();
+#endif
+        if (m_tracer != nullptr) m_tracer->end(GB_TRACE_TRACK_FRAME, m_memory_map.get_cycles());
+        m_ppu->flush();
+
+        // Snapshots are taken after the flush so the PPU's copy of the framebuffer is up to date
+        if (!rewinding) _record_rewind();
+
+        if (m_run_ahead_frames != 0 && !rewinding) {
+            _run_ahead();
+        } else {
+            GB_HOST_PROFILE_SCOPE(m_host_profiler, gb_host_profiler::GB_SECTION_RENDERER);
+            m_renderer->update(((m_memory_map.read_byte(GB_LCDC_ADDR) & 0x80) != 0));
+        }
+#ifdef GB_HOST_PROFILER
+        _report_host_profile();
+#endif
+        if (m_perf_counters_file.is_open()) _dump_perf_counters();
+    }
+
+    return frames;
+}
+
+uint8_t* gb_emulator::get_mem(uint16_t addr, size_t& size) {
+    // The LCD takes VRAM and OAM out of the memory map while the PPU is using them, so those are never looked up there
+    gb_memory_mapped_device_ptr device;
+    if (m_ppu != nullptr && addr >= GB_VIDEO_RAM_ADDR && addr < GB_VIDEO_RAM_ADDR + GB_VIDEO_RAM_SIZE) {
+        device = m_ppu;
+    } else if (m_oam != nullptr && addr >= GB_PPU_OAM_ADDR && addr < GB_PPU_OAM_ADDR + GB_PPU_OAM_SIZE) {
+        device = m_oam;
+    } else {
+        device = m_memory_map.get_readable_device(addr);
+    }
+
+    if (device == nullptr) {
+        std::ostringstream sstr;
+        sstr << "gb_emulator::get_mem() - No device mapped at address: 0x" << std::hex << addr;
+        throw std::out_of_range(sstr.str());
+    }
+
+    gb_address_range_t addr_range = device->get_address_range();
+    uint16_t offset = static_cast<uint16_t>(addr - std::get<0>(addr_range));
+
+    size = std::get<1>(addr_range) - offset;
+    return device->get_mem() + offset;
+}
+
+void gb_emulator::invalidate_vram() {
+    if (m_ppu != nullptr) m_ppu->invalidate_tiles();
+}
+
+uint64_t gb_emulator::get_cycle_count() const {
+    return m_memory_map.get_cycles();
+}
+
+gb_logger& gb_emulator::get_logger() {
+    return m_logger;
+}
+
+void gb_emulator::set_serial_echo(bool enabled) {
+    m_serial_echo = enabled;
+    if (m_serial_io != nullptr) m_serial_io->set_echo(enabled);
+}
+
+const std::string& gb_emulator::get_serial_output() const {
+    static const std::string empty;
+    return (m_serial_io != nullptr) ? m_serial_io->get_output() : empty;
+}
+
+void gb_emulator::set_magic_breakpoint(bool enabled) {
+    m_cpu.set_magic_breakpoint(enabled);
+}
+
+gb_cpu::registers_t gb_emulator::get_cpu_registers() const {
+    return m_cpu.get_registers();
+}
+
+void gb_emulator::save_state(std::vector<uint8_t>& state) {
+    if (m_ppu == nullptr) throw std::runtime_error("gb_emulator::save_state() - No ROM loaded");
+
+    state.reserve(state.size() + m_state_size);
+
+    gb_state_writer writer (state);
+    _save_state(writer);
+}
+
+size_t gb_emulator::save_state(uint8_t* state, size_t state_size) {
+    if (m_ppu == nullptr) throw std::runtime_error("gb_emulator::save_state() - No ROM loaded");
+
+    if (state_size < m_state_size) {
+        std::ostringstream sstr;
+        sstr << "gb_emulator::save_state() - Buffer is too small for the state: " << state_size << " bytes (needs " << m_state_size << ")";
+        throw std::runtime_error(sstr.str());
+    }
+
+    gb_state_writer writer (state, state_size);
+    _save_state(writer);
+    return writer.get_size();
+}
+
+size_t gb_emulator::get_state_size() const {
+    return m_state_size;
+}
+
+void gb_emulator::_save_state(gb_state_writer& writer) {
+    gb_state_header_t header = {};
+    header.magic = GB_STATE_MAGIC;
+    header.version = GB_STATE_VERSION;
+    header.size = m_state_size;
+    for (uint16_t i = 0; i < GB_STATE_CARTRIDGE_HEADER_SIZE; i++) {
+        header.cartridge_header[i] = m_memory_manager.read_rom_byte(GB_STATE_CARTRIDGE_HEADER_ADDR + i);
+    }
+
+    writer.write(header);
+    m_cpu.save_state(writer);
+    m_state_arena_offset = writer.get_size();
+    m_memory_manager.save_state(writer);
+    for (const gb_memory_mapped_device_ptr& device : m_state_devices) {
+        device->save_state(writer);
+    }
+    writer.write(m_memory_map.get_cycles());
+}
+
+void gb_emulator::load_state(const uint8_t* state, size_t state_size) {
+    if (m_ppu == nullptr) throw std::runtime_error("gb_emulator::load_state() - No ROM loaded");
+
+    // Check everything that can be checked up front so a bad state doesn't leave the machine half loaded
+    gb_state_reader reader (state, state_size);
+    gb_state_header_t header = reader.read<gb_state_header_t>();
+
+    if (header.magic != GB_STATE_MAGIC) {
+        throw std::runtime_error("gb_emulator::load_state() - Not a save state");
+    }
+
+    if (header.version != GB_STATE_VERSION) {
+        std::ostringstream sstr;
+        sstr << "gb_emulator::load_state() - Unsupported save state version: " << header.version << " (expected " << GB_STATE_VERSION << ")";
+        throw std::runtime_error(sstr.str());
+    }
+
+    if (header.size != state_size || state_size != m_state_size) {
+        std::ostringstream sstr;
+        sstr << "gb_emulator::load_state() - Save state size mismatch: " << state_size << " bytes (expected " << m_state_size << ")";
+        throw std::runtime_error(sstr.str());
+    }
+
+    // The memory manager checks this too but only after the CPU has been loaded
+    gb_state_reader arena_reader (state + m_state_arena_offset, state_size - m_state_arena_offset);
+    uint64_t arena_size = arena_reader.read<uint64_t>();
+    if (arena_size != m_memory_manager.get_size()) {
+        std::ostringstream sstr;
+        sstr << "gb_emulator::load_state() - Save state memory size mismatch: " << arena_size << " bytes (expected " << m_memory_manager.get_size() << ")";
+        throw std::runtime_error(sstr.str());
+    }
+
+    for (uint16_t i = 0; i < GB_STATE_CARTRIDGE_HEADER_SIZE; i++) {
+        if (header.cartridge_header[i] != m_memory_manager.read_rom_byte(GB_STATE_CARTRIDGE_HEADER_ADDR + i)) {
+            throw std::runtime_error("gb_emulator::load_state() - Save state is for a different cartridge");
+        }
+    }
+
+    m_cpu.load_state(reader);
+    m_memory_manager.load_state(reader);
+    for (gb_memory_mapped_device_ptr& device : m_state_devices) {
+        device->load_state(reader);
+    }
+    m_memory_map.set_cycles(reader.read<uint64_t>());
+
+    // The call stack the profiler was following is gone
+    if (m_guest_profiler != nullptr) m_guest_profiler->clear_stack();
+}
+
+void gb_emulator::save_state(const std::string& filename) {
+    std::vector<uint8_t> state;
+    save_state(state);
+
+    std::ofstream file (filename, std::ofstream::binary);
+    if (!file || !file.write(reinterpret_cast<const char*>(state.data()), static_cast<std::streamsize>(state.size()))) {
+        std::ostringstream sstr;
+        sstr << "gb_emulator::save_state() - Can't write file: " << filename;
+        throw std::runtime_error(sstr.str());
+    }
+}
+
+void gb_emulator::load_state(const std::string& filename) {
+    std::ifstream file (filename, std::ifstream::binary);
+    if (!file) {
+        std::ostringstream sstr;
+        sstr << "gb_emulator::load_state() - Can't open file: " << filename;
+        throw std::runtime_error(sstr.str());
+    }
+
+    std::vector<uint8_t> state ((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    load_state(state.data(), state.size());
+}
+
+gb_emulator_ptr gb_emulator::clone(gb_renderer_ptr renderer) {
+    if (m_ppu == nullptr) throw std::runtime_error("gb_emulator::clone() - No ROM loaded");
+    if (renderer == nullptr) renderer = std::make_shared<gb_null_renderer>();
+
+    gb_emulator_ptr emulator = std::make_shared<gb_emulator>(renderer);
+    emulator->m_logger.set_level(m_logger.get_level());
+    emulator->m_logger.enable_tracing(m_logger.is_tracing());
+    emulator->m_serial_echo = m_serial_echo;
+
+    // Rebuild the devices around the shared ROM. They are created in the same order as ours so the memory manager layouts match
+    emulator->m_memory_manager.set_rom(m_memory_manager.get_rom());
+    emulator->_add_devices(gb_memory_bank_controller::make_mbc(emulator->m_memory_manager, emulator->m_memory_map));
+
+    // Everything else (including which devices the MBC has mapped in) is copied over with a save state
+    std::vector<uint8_t> state;
+    save_state(state);
+    emulator->load_state(state.data(), state.size());
+
+    emulator->m_renderer->get_input().set_buttons(m_renderer->get_input().get_buttons());
+
+    return emulator;
+}
+
+void gb_emulator::enable_rewind(size_t capacity, unsigned int interval) {
+    m_rewind = (capacity != 0) ? std::make_shared<gb_rewind>(capacity) : nullptr;
+    m_rewind_interval = std::max(interval, 1u);
+    m_rewind_frames = 0;
+}
+
+bool gb_emulator::rewind() {
+    if (m_rewind == nullptr || !m_rewind->pop(m_rewind_state)) return false;
+
+    load_state(m_rewind_state.data(), m_rewind_state.size());
+    m_rewind_frames = 0;
+
+    return true;
+}
+
+void gb_emulator::_record_rewind() {
+    if (m_rewind == nullptr || ++m_rewind_frames < m_rewind_interval) return;
+
+    m_rewind_frames = 0;
+    m_rewind_state.clear();
+    save_state(m_rewind_state);
+    m_rewind->push(m_rewind_state);
+}
+
+void gb_emulator::set_run_ahead(unsigned int num_frames) {
+    m_run_ahead_frames = num_frames;
+    m_run_ahead_count = 0;
+    m_run_ahead_time = std::chrono::nanoseconds(0);
+}
+
+double gb_emulator::get_run_ahead_cost() const {
+    if (m_run_ahead_count == 0) return 0.0;
+    return std::chrono::duration<double, std::micro>(m_run_ahead_time).count() / static_cast<double>(m_run_ahead_count);
+}
+
+void gb_emulator::_run_ahead() {
+    auto start = std::chrono::steady_clock::now();
+
+    m_run_ahead_state.clear();
+    save_state(m_run_ahead_state);
+
+    // Frames that are thrown away shouldn't show up in the guest profile or the trace and restoring the state mustn't
+    // clear the profiler's call stack or rebase the trace
+    gb_guest_profiler_ptr guest_profiler = m_guest_profiler;
+    gb_tracer_ptr tracer = m_tracer;
+    set_guest_profiler(nullptr);
+    set_tracer(nullptr);
+
+    // Nor in the performance counters, so a counter dump lines up with the trace
+    gb_perf_counters counters = m_memory_map.get_counters();
+
+    // Only the last frame is presented so it's the only one drawn
+    m_serial_io->set_capture(false);
+    for (unsigned int i = 0; i < m_run_ahead_frames; i++) {
+        m_ppu->set_render((i + 1) == m_run_ahead_frames);
         step(70224);
-        m_renderer.update(((m_memory_map.read_byte(GB_LCDC_ADDR) & 0x80) != 0));
     }
+    m_ppu->flush();
+    m_ppu->set_render(true);
+    m_serial_io->set_capture(true);
+
+    bool lcd_on = ((m_memory_map.read_byte(GB_LCDC_ADDR) & 0x80) != 0);
+    auto present = std::chrono::steady_clock::now();
+    {
+        GB_HOST_PROFILE_SCOPE(m_host_profiler, gb_host_profiler::GB_SECTION_RENDERER);
+        m_renderer->update(lcd_on);
+    }
+    auto restore = std::chrono::steady_clock::now();
+
+    // The real frame wasn't drawn so the presented one is kept in the framebuffer rather than what the state holds
+    gb_framebuffer presented = m_renderer->get_framebuffer();
+    load_state(m_run_ahead_state.data(), m_run_ahead_state.size());
+    m_renderer->get_framebuffer() = presented;
+
+    set_guest_profiler(guest_profiler);
+    set_tracer(tracer);
+    m_memory_map.get_counters() = counters;
+
+    // Time spent presenting (including the SFML renderer's frame limiter) isn't part of the cost
+    m_run_ahead_time += std::chrono::duration_cast<std::chrono::nanoseconds>((present - start) + (std::chrono::steady_clock::now() - restore));
+    m_run_ahead_count++;
+}
+
+void gb_emulator::record_movie(gb_movie_ptr movie) {
+    m_movie = movie;
+    m_movie_playing = false;
+    m_movie_frame = 0;
+
+    if (m_movie != nullptr) {
+        std::vector<uint8_t> state;
+        save_state(state);
+        m_movie->start(get_rom_hash(), state);
+    }
+}
+
+void gb_emulator::play_movie(gb_movie_ptr movie) {
+    if (movie->get_rom_hash() != get_rom_hash()) {
+        throw std::runtime_error("gb_emulator::play_movie() - Movie was recorded with a different ROM");
+    }
+
+    const std::vector<uint8_t>& state = movie->get_start_state();
+    load_state(state.data(), state.size());
+
+    m_movie = movie;
+    m_movie_playing = true;
+    m_movie_frame = 0;
+}
+
+uint64_t gb_emulator::get_rom_hash() {
+    gb_memory_manager::gb_rom_data_ptr rom = m_memory_manager.get_rom();
+    return gb_movie::hash(rom->data(), rom->size());
+}
+
+void gb_emulator::_movie_frame() {
+    gb_input& input = m_renderer->get_input();
+
+    if (m_movie_playing) {
+        input.set_buttons(m_movie->get_buttons(m_movie_frame));
+    } else {
+        m_movie->add_frame(input.get_buttons());
+    }
+
+    m_movie_frame++;
+}
+
+void gb_emulator::save_memory_profile(const std::string& filename) {
+#ifdef GB_MEMORY_PROFILER
+    m_memory_map.get_profiler().export_to_file(filename);
+#else
+    throw std::runtime_error("gb_emulator::save_memory_profile() - Memory profiler not enabled, rebuild with -DGOODBOY_MEMORY_PROFILER=ON: " + filename);
+#endif
+}
+
+void gb_emulator::set_guest_profiler(gb_guest_profiler_ptr guest_profiler) {
+    m_guest_profiler = guest_profiler;
+    m_cpu.set_guest_profiler(guest_profiler);
+}
+
+gb_perf_counters& gb_emulator::get_perf_counters() {
+    return m_memory_map.get_counters();
+}
+
+void gb_emulator::set_perf_counters_dump(const std::string& filename, unsigned long num_frames) {
+    if (m_perf_counters_file.is_open()) {
+        if (m_perf_counters_frames != 0) m_memory_map.get_counters().export_json(m_perf_counters_file);
+        m_perf_counters_file.close();
+    }
+    if (filename.empty()) return;
+
+    m_perf_counters_file.open(filename);
+    if (!m_perf_counters_file) {
+        std::ostringstream sstr;
+        sstr << "gb_emulator::set_perf_counters_dump() - Can't open file: " << filename;
+        throw std::runtime_error(sstr.str());
+    }
+    m_perf_counters_interval = std::max(num_frames, 1ul);
+    m_perf_counters_frames = 0;
+}
+
+void gb_emulator::_dump_perf_counters() {
+    if (++m_perf_counters_frames < m_perf_counters_interval) return;
+
+    m_memory_map.get_counters().export_json(m_perf_counters_file);
+    m_perf_counters_frames = 0;
+}
+
+void gb_emulator::set_tracer(gb_tracer_ptr tracer) {
+    m_tracer = tracer;
+    m_memory_map.set_tracer(tracer);
+}
+
+void gb_emulator::set_host_profile_interval(unsigned long num_frames, bool json) {
+#ifdef GB_HOST_PROFILER
+    m_host_profile_interval = num_frames;
+    m_host_profile_json = json;
+    m_host_profiler.reset();
+#else
+    throw std::runtime_error("gb_emulator::set_host_profile_interval() - Host profiler not enabled, rebuild with -DGOODBOY_HOST_PROFILER=ON");
+#endif
+}
+
+#ifdef GB_HOST_PROFILER
+void gb_emulator::_report_host_profile() {
+    m_host_profiler.end_frame();
+    if (m_host_profile_interval == 0 || m_host_profiler.get_frames() < m_host_profile_interval) return;
+
+    if (m_logger.is_enabled(GB_LOG_INFO)) {
+        if (m_host_profile_json) {
+            m_host_profiler.export_json(m_logger);
+        } else {
+            m_host_profiler.report(m_logger);
+        }
+    }
+
+    m_host_profiler.reset();
 }
+#endif
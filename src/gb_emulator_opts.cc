@@ -8,26 +8,73 @@
 #include <stdexcept>
 
 #include <unistd.h>
+#include <getopt.h>
 
 #include "gb_emulator_opts.h"
 
-#define OPT_STR_INIT "hdt"
+// Options that only have a long form use values outside of the character range
+#define OPT_RECORD   (0x100)
+#define OPT_REPLAY   (0x101)
+#define OPT_GPROF    (0x102)
+#define OPT_SYM      (0x103)
+#define OPT_TRACE    (0x104)
+#define OPT_PERF     (0x105)
+
+#define OPT_STR_INIT "hdtp:P:n:l:s:r:a:"
+#define OPT_LONG_INIT \
+{{\
+    {"record", required_argument, nullptr, OPT_RECORD},\
+    {"replay", required_argument, nullptr, OPT_REPLAY},\
+    {"gprof", required_argument, nullptr, OPT_GPROF},\
+    {"sym", required_argument, nullptr, OPT_SYM},\
+    {"trace", required_argument, nullptr, OPT_TRACE},\
+    {"perf", required_argument, nullptr, OPT_PERF},\
+    {nullptr, 0, nullptr, 0}\
+}}
 #define OPT_DOC_INIT \
 {\
-    "-h          : Print this help and exit",\
-    "-d          : Run in debugger mode",\
-    "-t          : Enable tracing",\
-    "rom_file    : Gameboy program to run on the emulator"\
+    "-h            : Print this help and exit",\
+    "-d            : Run in debugger mode",\
+    "-t            : Enable tracing",\
+    "-p file       : Write the memory access profile to a .csv or .json file on exit",\
+    "-P frames     : Log the host time spent in each subsystem every given number of frames",\
+    "-n frames     : Run without a window or frame limiter for the given number of frames (0 runs forever)",\
+    "-l file       : Load a save state before running",\
+    "-s file       : Write a save state on exit",\
+    "-r MB         : Keep the given number of megabytes of snapshots for rewinding, hold Backspace to rewind",\
+    "-a frames     : Run ahead the given number of frames to hide input lag, the extra CPU time is printed on exit",\
+    "--record file : Record the buttons pressed on every frame to a movie file",\
+    "--replay file : Replay a movie without a window or frame limiter and print a hash of the final state",\
+    "--gprof name  : Profile the game's code and write name.txt, name.folded and name.csv on exit",\
+    "--sym file    : Name functions in the profile using an RGBDS .sym file",\
+    "--trace file  : Write a Chrome/Perfetto trace of frames, scanlines, LCD modes, interrupts, DMA, bank switches and HALT",\
+    "--perf file   : Write the performance counters as a line of JSON every 60 frames and on exit",\
+    "rom_file      : Gameboy program to run on the emulator"\
 }
 #define OPT_MAP_INIT \
 {\
     {'h', std::bind(&gb_emulator_opts::_opt_print_doc, this)},\
     {'d', std::bind(&gb_emulator_opts::_opt_set_debugger_flag, this)},\
-    {'t', std::bind(&gb_emulator_opts::_opt_set_tracing_flag, this)}\
+    {'t', std::bind(&gb_emulator_opts::_opt_set_tracing_flag, this)},\
+    {'p', std::bind(&gb_emulator_opts::_opt_set_memory_profile_filename, this)},\
+    {'P', std::bind(&gb_emulator_opts::_opt_set_host_profile_interval, this)},\
+    {'n', std::bind(&gb_emulator_opts::_opt_set_headless_frames, this)},\
+    {'l', std::bind(&gb_emulator_opts::_opt_set_load_state_filename, this)},\
+    {'s', std::bind(&gb_emulator_opts::_opt_set_save_state_filename, this)},\
+    {'r', std::bind(&gb_emulator_opts::_opt_set_rewind_size, this)},\
+    {'a', std::bind(&gb_emulator_opts::_opt_set_run_ahead_frames, this)},\
+    {OPT_RECORD, std::bind(&gb_emulator_opts::_opt_set_record_filename, this)},\
+    {OPT_REPLAY, std::bind(&gb_emulator_opts::_opt_set_replay_filename, this)},\
+    {OPT_GPROF, std::bind(&gb_emulator_opts::_opt_set_guest_profile_name, this)},\
+    {OPT_SYM, std::bind(&gb_emulator_opts::_opt_set_sym_filename, this)},\
+    {OPT_TRACE, std::bind(&gb_emulator_opts::_opt_set_trace_filename, this)},\
+    {OPT_PERF, std::bind(&gb_emulator_opts::_opt_set_perf_counters_filename, this)}\
 }
 
 gb_emulator_opts::gb_emulator_opts(int argc, char **argv)
-    : m_program_name(argv[0]), m_argc(argc), m_argv(argv), m_opt_str(OPT_STR_INIT), m_opt_doc(OPT_DOC_INIT), m_opt_map(OPT_MAP_INIT) {
+    : m_program_name(argv[0]), m_rom_filename(), m_debugger(false), m_tracing(false), m_memory_profile_filename(), m_host_profile_interval(0),
+      m_headless(false), m_max_frames(0), m_load_state_filename(), m_save_state_filename(), m_rewind_size(0), m_run_ahead_frames(0), m_record_filename(), m_replay_filename(), m_guest_profile_name(), m_sym_filename(), m_trace_filename(), m_perf_counters_filename(),
+      m_argc(argc), m_argv(argv), m_opt_str(OPT_STR_INIT), m_long_opts(OPT_LONG_INIT), m_opt_doc(OPT_DOC_INIT), m_opt_map(OPT_MAP_INIT) {
 }
 
 gb_emulator_opts::~gb_emulator_opts() {
@@ -55,8 +102,13 @@ bool gb_emulator_opts::_opt_print_doc() {
 }
 
 bool gb_emulator_opts::_opt_set_debugger_flag() {
+#ifdef GB_HEADLESS
+    std::cout << m_program_name << ": " << "the debugger is not available in headless builds" << std::endl;
+    return false;
+#else
     m_debugger = true;
     return true;
+#endif
 }
 
 bool gb_emulator_opts::_opt_set_tracing_flag() {
@@ -64,8 +116,103 @@ bool gb_emulator_opts::_opt_set_tracing_flag() {
     return true;
 }
 
+bool gb_emulator_opts::_opt_set_memory_profile_filename() {
+    m_memory_profile_filename = std::string(optarg);
+    return true;
+}
+
+bool gb_emulator_opts::_opt_set_host_profile_interval() {
+    try {
+        m_host_profile_interval = std::stoul(std::string(optarg), nullptr, 0);
+    } catch (const std::exception& e) {
+        std::cout << m_program_name << ": " << "invalid number of frames '" << optarg << "'" << std::endl;
+        print_help();
+        return false;
+    }
+
+    return true;
+}
+
+bool gb_emulator_opts::_opt_set_headless_frames() {
+    try {
+        m_max_frames = std::stoull(std::string(optarg), nullptr, 0);
+    } catch (const std::exception& e) {
+        std::cout << m_program_name << ": " << "invalid number of frames '" << optarg << "'" << std::endl;
+        print_help();
+        return false;
+    }
+
+    m_headless = true;
+    return true;
+}
+
+bool gb_emulator_opts::_opt_set_load_state_filename() {
+    m_load_state_filename = std::string(optarg);
+    return true;
+}
+
+bool gb_emulator_opts::_opt_set_save_state_filename() {
+    m_save_state_filename = std::string(optarg);
+    return true;
+}
+
+bool gb_emulator_opts::_opt_set_rewind_size() {
+    try {
+        m_rewind_size = static_cast<size_t>(std::stoull(std::string(optarg), nullptr, 0)) * 1024 * 1024;
+    } catch (const std::exception& e) {
+        std::cout << m_program_name << ": " << "invalid rewind size '" << optarg << "'" << std::endl;
+        print_help();
+        return false;
+    }
+
+    return true;
+}
+
+bool gb_emulator_opts::_opt_set_run_ahead_frames() {
+    try {
+        m_run_ahead_frames = static_cast<unsigned int>(std::stoul(std::string(optarg), nullptr, 0));
+    } catch (const std::exception& e) {
+        std::cout << m_program_name << ": " << "invalid number of run-ahead frames '" << optarg << "'" << std::endl;
+        print_help();
+        return false;
+    }
+
+    return true;
+}
+
+bool gb_emulator_opts::_opt_set_record_filename() {
+    m_record_filename = std::string(optarg);
+    return true;
+}
+
+bool gb_emulator_opts::_opt_set_replay_filename() {
+    m_replay_filename = std::string(optarg);
+    m_headless = true;
+    return true;
+}
+
+bool gb_emulator_opts::_opt_set_guest_profile_name() {
+    m_guest_profile_name = std::string(optarg);
+    return true;
+}
+
+bool gb_emulator_opts::_opt_set_sym_filename() {
+    m_sym_filename = std::string(optarg);
+    return true;
+}
+
+bool gb_emulator_opts::_opt_set_trace_filename() {
+    m_trace_filename = std::string(optarg);
+    return true;
+}
+
+bool gb_emulator_opts::_opt_set_perf_counters_filename() {
+    m_perf_counters_filename = std::string(optarg);
+    return true;
+}
+
 bool gb_emulator_opts::parse_opts() {
-    for (int c = 0; (c = getopt(m_argc, m_argv, m_opt_str.c_str())) != -1; ) {
+    for (int c = 0; (c = getopt_long(m_argc, m_argv, m_opt_str.c_str(), m_long_opts.data(), nullptr)) != -1; ) {
         try {
             opt_handler_t opt_handler = m_opt_map.at(c);
             bool ok = opt_handler();
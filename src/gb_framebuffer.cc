@@ -4,38 +4,72 @@
  * SPDX-License-Identifier: MIT
  */
 
-#include "gb_framebuffer.h"
-
-#define GB_FRAMEBUFFER_WHITE      sf::Color(255, 255, 255)
-#define GB_FRAMEBUFFER_LIGHT_GREY sf::Color(192, 192, 192)
-#define GB_FRAMEBUFFER_DARK_GREY  sf::Color(96, 96, 96)
-#define GB_FRAMEBUFFER_BLACK      sf::Color(0, 0, 0)
+#include <cstring>
 
-#define COLOUR_MAP_INIT \
-{{\
-    GB_FRAMEBUFFER_WHITE,\
-    GB_FRAMEBUFFER_LIGHT_GREY,\
-    GB_FRAMEBUFFER_DARK_GREY,\
-    GB_FRAMEBUFFER_BLACK\
-}}
+#include "gb_framebuffer.h"
 
 gb_framebuffer::gb_framebuffer()
-    : sf::Image(), m_colour_map(COLOUR_MAP_INIT)
+    : m_pixels()
 {
+    m_pixels.fill(GB_COLOUR0);
 }
 
-gb_colour_t gb_framebuffer::get_pixel(unsigned int x, unsigned int y) {
-    sf::Color pixel_colour = sf::Image::getPixel(x, y);
+void gb_framebuffer::set_pixel(unsigned int x, unsigned int y, gb_colour_t colour) {
+    m_pixels[(y * GB_WIDTH) + x] = static_cast<uint8_t>(colour);
+}
 
-    // Reverse map the sf::Colour to a gb_colour_t
-    gb_colour_t gb_colour = GB_COLOUR0;
-    for (unsigned int i = 0; i < m_colour_map.size(); i++) {
-       if (pixel_colour == m_colour_map.at(i)) gb_colour = static_cast<gb_colour_t>(i);
-    }
+gb_colour_t gb_framebuffer::get_pixel(unsigned int x, unsigned int y) const {
+    return static_cast<gb_colour_t>(m_pixels[(y * GB_WIDTH) + x]);
+}
 
-    return gb_colour;
+void gb_framebuffer::set_line(unsigned int y, const uint8_t* colours) {
+    std::memcpy(&m_pixels[y * GB_WIDTH], colours, GB_WIDTH);
 }
 
-void gb_framebuffer::set_pixel(unsigned int x, unsigned int y, gb_colour_t colour) {
-    sf::Image::setPixel(x, y, m_colour_map.at(colour));
+const uint8_t* gb_framebuffer::get_pixels() const {
+    return m_pixels.data();
+}
+
+#define GB_XXH_PRIME1 (0x9E3779B185EBCA87ull)
+#define GB_XXH_PRIME2 (0xC2B2AE3D27D4EB4Full)
+#define GB_XXH_PRIME3 (0x165667B19E3779F9ull)
+#define GB_XXH_PRIME4 (0x85EBCA77C2B2AE63ull)
+
+static inline uint64_t _rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// Lanes are read little-endian so a frame has the same hash on every host
+static inline uint64_t _read_u64_le(const uint8_t* data) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) value = (value << 8) | data[i];
+    return value;
+}
+
+static inline uint64_t _xxh_round(uint64_t acc, uint64_t input) {
+    return _rotl(acc + (input * GB_XXH_PRIME2), 31) * GB_XXH_PRIME1;
+}
+
+uint64_t gb_framebuffer::get_hash() const {
+    // The frame is a whole number of 32 byte stripes so there's no tail to handle
+    static_assert((GB_WIDTH * GB_HEIGHT) % 32 == 0, "framebuffer size must be a multiple of 32 bytes");
+
+    // The four lanes are independent so their multiplies overlap
+    uint64_t lanes[4] = {GB_XXH_PRIME1 + GB_XXH_PRIME2, GB_XXH_PRIME2, 0, 0 - GB_XXH_PRIME1};
+    for (size_t i = 0; i < m_pixels.size(); i += 32) {
+        for (size_t lane = 0; lane < 4; lane++) lanes[lane] = _xxh_round(lanes[lane], _read_u64_le(&m_pixels[i + (lane * 8)]));
+    }
+
+    uint64_t hash = _rotl(lanes[0], 1) + _rotl(lanes[1], 7) + _rotl(lanes[2], 12) + _rotl(lanes[3], 18);
+    for (uint64_t lane : lanes) {
+        hash = ((hash ^ _xxh_round(0, lane)) * GB_XXH_PRIME1) + GB_XXH_PRIME4;
+    }
+    hash += m_pixels.size();
+
+    hash ^= hash >> 33;
+    hash *= GB_XXH_PRIME2;
+    hash ^= hash >> 29;
+    hash *= GB_XXH_PRIME3;
+    hash ^= hash >> 32;
+    return hash;
 }
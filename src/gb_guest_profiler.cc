@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+
+#include "gb_guest_profiler.h"
+#include "gb_io_defs.h"
+
+// Pseudo functions for the bottom of the call stack and for cycles spent halted
+#define GB_GUEST_PROFILER_ROOT (0xFFFFFFFFu)
+#define GB_GUEST_PROFILER_HALT (0xFFFFFFFEu)
+
+#define GB_GUEST_PROFILER_FUNCTION(bank, addr) (static_cast<uint32_t>(((bank) << 16) | (addr)))
+
+gb_guest_profiler::gb_guest_profiler()
+    : m_rom_pcs(), m_ram_pcs(), m_nodes(), m_children(), m_stack(), m_node(0), m_cur_pc(nullptr), m_cur_node(0), m_symbols()
+{
+    reset();
+}
+
+gb_guest_profiler::~gb_guest_profiler() {
+}
+
+void gb_guest_profiler::begin_instruction(uint16_t pc, unsigned long bank) {
+    if (pc < GB_VIDEO_RAM_ADDR) {
+        // Banks are only known once they're executed from so grow the histogram as needed
+        size_t index = bank * GB_ROM_BANK_SIZE + (pc % GB_ROM_BANK_SIZE);
+        if (index >= m_rom_pcs.size()) m_rom_pcs.resize(index - (index % GB_ROM_BANK_SIZE) + GB_ROM_BANK_SIZE, {0, 0});
+        m_cur_pc = &m_rom_pcs[index];
+    } else {
+        m_cur_pc = &m_ram_pcs[pc - GB_VIDEO_RAM_ADDR];
+    }
+
+    m_cur_node = m_node;
+}
+
+void gb_guest_profiler::end_instruction(int cycles) {
+    // The instruction may have called or returned, the cycles belong to the function it started in
+    m_cur_pc->executions++;
+    m_cur_pc->cycles += static_cast<uint64_t>(cycles);
+    m_nodes[m_cur_node].self_cycles += static_cast<uint64_t>(cycles);
+}
+
+void gb_guest_profiler::record_halt(int cycles) {
+    m_nodes[_get_child(m_node, GB_GUEST_PROFILER_HALT)].self_cycles += static_cast<uint64_t>(cycles);
+}
+
+void gb_guest_profiler::record_call(uint16_t addr, unsigned long bank, uint16_t sp) {
+    // Code in fixed ROM and RAM isn't banked, only qualify calls into the switchable bank so they match the .sym file
+    if (addr < GB_ROM_BANK_SIZE || addr >= GB_VIDEO_RAM_ADDR) bank = 0;
+    _push(GB_GUEST_PROFILER_FUNCTION(bank, addr), sp);
+}
+
+void gb_guest_profiler::record_interrupt(uint16_t addr, uint16_t sp) {
+    _push(GB_GUEST_PROFILER_FUNCTION(0, addr), sp);
+}
+
+void gb_guest_profiler::record_return(uint16_t sp) {
+    _pop_to(sp);
+}
+
+void gb_guest_profiler::_push(gb_function_t function, uint16_t sp) {
+    // Any frames at or below the new return address are dead, i.e. the stack pointer was reset or return addresses were dropped
+    _pop_to(sp);
+    if (m_stack.size() >= GB_GUEST_PROFILER_MAX_DEPTH) clear_stack();
+
+    m_node = _get_child(m_node, function);
+    m_nodes[m_node].calls++;
+    m_stack.push_back({m_node, sp});
+}
+
+void gb_guest_profiler::_pop_to(uint16_t sp) {
+    // A return pops every frame whose return address is at or below the stack pointer. A return with the stack pointer
+    // below the top frame is really a jump (i.e. push an address and RET) and leaves the stack alone
+    while (!m_stack.empty() && m_stack.back().sp <= sp) m_stack.pop_back();
+    m_node = m_stack.empty() ? 0 : m_stack.back().node;
+}
+
+uint32_t gb_guest_profiler::_get_child(uint32_t parent, gb_function_t function) {
+    uint64_t key = (static_cast<uint64_t>(parent) << 32) | function;
+
+    auto child = m_children.find(key);
+    if (child != m_children.end()) return child->second;
+
+    uint32_t node = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back({function, parent, 0, 0});
+    m_children.emplace(key, node);
+
+    return node;
+}
+
+void gb_guest_profiler::clear_stack() {
+    m_stack.clear();
+    m_node = 0;
+}
+
+void gb_guest_profiler::reset() {
+    m_rom_pcs.clear();
+    m_ram_pcs.assign(0x10000 - GB_VIDEO_RAM_ADDR, {0, 0});
+    m_nodes.assign(1, {GB_GUEST_PROFILER_ROOT, 0, 0, 0});
+    m_children.clear();
+    m_cur_pc = &m_ram_pcs[0];
+    m_cur_node = 0;
+    clear_stack();
+}
+
+void gb_guest_profiler::load_symbols(const std::string& filename) {
+    std::ifstream sym_file (filename);
+
+    if (!sym_file) {
+        std::ostringstream sstr;
+        sstr << "gb_guest_profiler::load_symbols() - Unable to open file: " << filename;
+        throw std::runtime_error(sstr.str());
+    }
+
+    for (std::string line; std::getline(sym_file, line); ) {
+        line = line.substr(0, line.find(';'));
+
+        std::istringstream sstr (line);
+        std::string location, name;
+        if (!(sstr >> location >> name)) continue;
+
+        size_t colon = location.find(':');
+        if (colon == std::string::npos) continue;
+
+        try {
+            unsigned long bank = std::stoul(location.substr(0, colon), nullptr, 16);
+            unsigned long addr = std::stoul(location.substr(colon + 1), nullptr, 16);
+            if (addr > 0xFFFF) continue;
+
+            // Keep the first label at an address unless it's a local label (i.e. Function.loop) and a global one comes along
+            gb_function_t function = GB_GUEST_PROFILER_FUNCTION(bank, addr);
+            auto symbol = m_symbols.find(function);
+            if (symbol == m_symbols.end()) {
+                m_symbols.emplace(function, name);
+            } else if (symbol->second.find('.') != std::string::npos && name.find('.') == std::string::npos) {
+                symbol->second = name;
+            }
+        } catch (const std::exception& e) {
+            continue;
+        }
+    }
+}
+
+std::string gb_guest_profiler::_get_function_name(gb_function_t function) const {
+    static const char* const interrupt_names[] = {"irq_vblank", "irq_stat", "irq_timer", "irq_serial", "irq_joypad"};
+
+    if (function == GB_GUEST_PROFILER_ROOT) return "[root]";
+    if (function == GB_GUEST_PROFILER_HALT) return "[halt]";
+
+    auto symbol = m_symbols.find(function);
+    if (symbol != m_symbols.end()) return symbol->second;
+
+    // Unlabelled interrupt and RST vectors get descriptive names, everything else is named after its address
+    uint16_t addr = function & 0xFFFF;
+    std::ostringstream sstr;
+    if (function >= 0x40 && function <= 0x60 && (function % 8) == 0) {
+        sstr << interrupt_names[(function - 0x40) / 8];
+    } else if (function <= 0x38 && (function % 8) == 0) {
+        sstr << "rst_" << std::hex << std::setfill('0') << std::setw(2) << addr;
+    } else {
+        sstr << std::hex << std::setfill('0') << std::setw(2) << (function >> 16) << ":" << std::setw(4) << addr;
+    }
+
+    return sstr.str();
+}
+
+std::string gb_guest_profiler::_get_label(gb_function_t function) const {
+    // Labels are sorted by bank then address so the nearest one before an address in the same bank is just before upper_bound
+    auto symbol = m_symbols.upper_bound(function);
+    if (symbol == m_symbols.begin()) return "";
+    --symbol;
+    if ((symbol->first >> 16) != (function >> 16)) return "";
+
+    std::ostringstream sstr;
+    sstr << symbol->second;
+    if (symbol->first != function) sstr << "+0x" << std::hex << (function - symbol->first);
+
+    return sstr.str();
+}
+
+void gb_guest_profiler::export_folded(std::ostream& os) const {
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        if (m_nodes[i].self_cycles == 0) continue;
+
+        // Walk up to the root and then print the names outermost first
+        std::vector<uint32_t> path;
+        for (uint32_t node = static_cast<uint32_t>(i); node != 0; node = m_nodes[node].parent) path.push_back(node);
+
+        os << _get_function_name(GB_GUEST_PROFILER_ROOT);
+        for (auto node = path.rbegin(); node != path.rend(); ++node) os << ";" << _get_function_name(m_nodes[*node].function);
+        os << " " << m_nodes[i].self_cycles << std::endl;
+    }
+}
+
+void gb_guest_profiler::export_functions(std::ostream& os) const {
+    struct gb_function_counts_t {
+        gb_function_t function;
+        uint64_t      self_cycles;
+        uint64_t      total_cycles;
+        uint64_t      calls;
+    };
+
+    // Children are always created after their parents so inclusive cycles can be summed up in a single backwards pass
+    std::vector<uint64_t> inclusive (m_nodes.size(), 0);
+    for (size_t i = m_nodes.size(); i-- > 0; ) {
+        inclusive[i] += m_nodes[i].self_cycles;
+        if (i != 0) inclusive[m_nodes[i].parent] += inclusive[i];
+    }
+
+    std::map<gb_function_t, gb_function_counts_t> functions;
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        const gb_node_t& node = m_nodes[i];
+        gb_function_counts_t& counts = functions.emplace(node.function, gb_function_counts_t{node.function, 0, 0, 0}).first->second;
+        counts.self_cycles += node.self_cycles;
+        counts.calls += node.calls;
+
+        // Recursive calls would be counted more than once, only count the outermost one
+        bool recursive = false;
+        for (uint32_t parent = node.parent; i != 0 && !recursive; parent = m_nodes[parent].parent) {
+            recursive = (m_nodes[parent].function == node.function);
+            if (parent == 0) break;
+        }
+        if (!recursive) counts.total_cycles += inclusive[i];
+    }
+
+    std::vector<gb_function_counts_t> sorted;
+    for (const auto& function : functions) sorted.push_back(function.second);
+    std::sort(sorted.begin(), sorted.end(), [](const gb_function_counts_t& a, const gb_function_counts_t& b) -> bool {
+        return a.self_cycles > b.self_cycles;
+    });
+
+    double total = static_cast<double>(std::max(inclusive[0], static_cast<uint64_t>(1)));
+
+    std::ios::fmtflags flags = os.flags();
+    os << std::dec << std::fixed << std::setprecision(2);
+    os << std::left << std::setw(32) << "function" << std::right << std::setw(16) << "self cycles" << std::setw(8) << "self %"
+       << std::setw(16) << "total cycles" << std::setw(9) << "total %" << std::setw(12) << "calls" << std::endl;
+
+    for (const gb_function_counts_t& counts : sorted) {
+        os << std::left << std::setw(32) << _get_function_name(counts.function) << std::right
+           << std::setw(16) << counts.self_cycles << std::setw(8) << 100.0 * static_cast<double>(counts.self_cycles) / total
+           << std::setw(16) << counts.total_cycles << std::setw(9) << 100.0 * static_cast<double>(counts.total_cycles) / total
+           << std::setw(12) << counts.calls << std::endl;
+    }
+
+    os.flags(flags);
+}
+
+void gb_guest_profiler::export_histogram(std::ostream& os) const {
+    auto _export_pc = [this, &os] (unsigned long bank, uint16_t addr, const gb_pc_counts_t& counts) -> void {
+        if (counts.executions == 0) return;
+        os << std::hex << std::setfill('0') << std::setw(2) << bank << ":" << std::setw(4) << addr << std::dec << ","
+           << _get_label(GB_GUEST_PROFILER_FUNCTION(bank, addr)) << "," << counts.executions << "," << counts.cycles << std::endl;
+    };
+
+    std::ios::fmtflags flags = os.flags();
+    char fill = os.fill();
+
+    os << "address,label,executions,cycles" << std::endl;
+    for (size_t i = 0; i < m_rom_pcs.size(); i++) {
+        unsigned long bank = i / GB_ROM_BANK_SIZE;
+        uint16_t addr = static_cast<uint16_t>((bank == 0 ? 0 : GB_ROM_BANK_SIZE) + (i % GB_ROM_BANK_SIZE));
+        _export_pc(bank, addr, m_rom_pcs[i]);
+    }
+    for (size_t i = 0; i < m_ram_pcs.size(); i++) {
+        _export_pc(0, static_cast<uint16_t>(GB_VIDEO_RAM_ADDR + i), m_ram_pcs[i]);
+    }
+
+    os.fill(fill);
+    os.flags(flags);
+}
+
+void gb_guest_profiler::export_to_file(const std::string& filename) const {
+    std::ofstream out_file (filename);
+
+    if (!out_file) {
+        std::ostringstream sstr;
+        sstr << "gb_guest_profiler::export_to_file() - Unable to open file: " << filename;
+        throw std::runtime_error(sstr.str());
+    }
+
+    auto _has_ext = [&filename] (const std::string& ext) -> bool {
+        return filename.size() >= ext.size() && filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0;
+    };
+
+    if (_has_ext(".folded")) {
+        export_folded(out_file);
+    } else if (_has_ext(".csv")) {
+        export_histogram(out_file);
+    } else {
+        export_functions(out_file);
+    }
+}
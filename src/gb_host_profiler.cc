@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <iomanip>
+
+#include "gb_host_profiler.h"
+
+#define GB_HOST_PROFILER_CALIBRATION_RUNS (1000)
+
+static const char* g_section_names[] = {"ppu", "lcd", "timer", "serial", "joypad", "interrupts", "cpu", "dma", "renderer"};
+
+gb_host_profiler::gb_host_profiler()
+    : m_sections(), m_frames(0), m_start_ticks(0), m_start_time(), m_overhead_ticks(0)
+{
+    _calibrate();
+    reset();
+}
+
+gb_host_profiler::~gb_host_profiler() {
+}
+
+void gb_host_profiler::_calibrate() {
+    // The cheapest of a number of back to back clock reads is the cost every section pays for being measured
+    m_overhead_ticks = UINT64_MAX;
+    for (int i = 0; i < GB_HOST_PROFILER_CALIBRATION_RUNS; i++) {
+        uint64_t start = now();
+        m_overhead_ticks = std::min(m_overhead_ticks, now() - start);
+    }
+}
+
+gb_host_profiler::gb_section_t gb_host_profiler::get_interrupt_section(uint8_t flag_mask) {
+    int section = GB_SECTION_PPU;
+    for (; section < GB_SECTION_INTERRUPTS && (flag_mask & (1u << section)) == 0; section++);
+    return static_cast<gb_section_t>(section);
+}
+
+void gb_host_profiler::end_frame() {
+    m_frames++;
+}
+
+unsigned long gb_host_profiler::get_frames() const {
+    return m_frames;
+}
+
+void gb_host_profiler::reset() {
+    m_sections.fill({0, 0});
+    m_frames = 0;
+    m_start_ticks = now();
+    m_start_time = std::chrono::steady_clock::now();
+}
+
+double gb_host_profiler::_get_times(gb_section_times_list_t& times) const {
+    double total_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - m_start_time).count();
+    uint64_t total_ticks = now() - m_start_ticks;
+    double ns_per_tick = (total_ticks != 0) ? total_ns / static_cast<double>(total_ticks) : 0.0;
+
+    for (size_t i = 0; i < m_sections.size(); i++) {
+        const gb_section_counts_t& section = m_sections[i];
+        uint64_t overhead = section.calls * m_overhead_ticks;
+        uint64_t ticks = (section.ticks > overhead) ? (section.ticks - overhead) : 0;
+        times[i] = {static_cast<double>(ticks) * ns_per_tick, section.calls};
+    }
+
+    return total_ns;
+}
+
+void gb_host_profiler::report(std::ostream& os) const {
+    gb_section_times_list_t times;
+    double total_ns = _get_times(times);
+    double frames = static_cast<double>(std::max(m_frames, 1ul));
+
+    auto _report_section = [&os, total_ns, frames] (const char* name, double ns, uint64_t calls) -> void {
+        os << std::left << std::setw(12) << name << std::right
+           << std::setw(12) << ns / frames / 1e6
+           << std::setw(10) << ((total_ns > 0.0) ? 100.0 * ns / total_ns : 0.0)
+           << std::setw(14) << static_cast<double>(calls) / frames
+           << std::setw(10) << ((calls != 0) ? ns / static_cast<double>(calls) : 0.0) << std::endl;
+    };
+
+    std::ios::fmtflags flags = os.flags();
+    os << std::dec << std::fixed << std::setprecision(3);
+
+    os << "Host profile over " << m_frames << " frames, " << total_ns / frames / 1e6 << " ms per frame" << std::endl;
+    os << std::left << std::setw(12) << "section" << std::right << std::setw(12) << "ms/frame" << std::setw(10) << "% time"
+       << std::setw(14) << "calls/frame" << std::setw(10) << "ns/call" << std::endl;
+
+    double other_ns = total_ns;
+    for (size_t i = 0; i < times.size(); i++) {
+        _report_section(g_section_names[i], times[i].ns, times[i].calls);
+        other_ns -= times[i].ns;
+    }
+    _report_section("other", std::max(other_ns, 0.0), 0);
+
+    os.flags(flags);
+}
+
+void gb_host_profiler::export_json(std::ostream& os) const {
+    gb_section_times_list_t times;
+    double total_ns = _get_times(times);
+
+    std::ios::fmtflags flags = os.flags();
+    os << std::dec << "{\"frames\": " << m_frames << ", \"total_ns\": " << static_cast<uint64_t>(total_ns) << ", \"sections\": {";
+    for (size_t i = 0; i < times.size(); i++) {
+        os << ((i != 0) ? ", " : "") << "\"" << g_section_names[i] << "\": {\"ns\": " << static_cast<uint64_t>(times[i].ns)
+           << ", \"calls\": " << times[i].calls << "}";
+    }
+    os << "}}" << std::endl;
+
+    os.flags(flags);
+}
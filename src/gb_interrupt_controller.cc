@@ -37,6 +37,10 @@ gb_interrupt_controller::gb_interrupt_controller(gb_memory_manager& memory_manag
     addr_range = m_ienable->get_address_range();
     memory_map.add_readable_device(m_ienable, std::get<0>(addr_range), std::get<1>(addr_range));
     memory_map.add_writeable_device(m_ienable, std::get<0>(addr_range), std::get<1>(addr_range));
+
+#ifdef GB_HOST_PROFILER
+    m_host_profiler = nullptr;
+#endif
 }
 
 gb_interrupt_controller::~gb_interrupt_controller() {
@@ -59,9 +63,13 @@ void gb_interrupt_controller::update(int cycles) {
     // For each interrupt source, call it's update routine and then depending on it's return value update the interrupt flags register
     // Keep track of the highest priority interrupt source that last raised an interrupt; this is the interrupt we redirect the CPU to handle
     for (gb_interrupt_source_ptr& isource : m_interrupt_sources) {
-        bool interrupt_raised = isource->update(cycles);
-        uint8_t iflags = m_iflags->read_byte(GB_IFLAGS_ADDR);
         uint8_t flag_mask = isource->get_flag_mask();
+        bool interrupt_raised;
+        {
+            GB_HOST_PROFILE_SCOPE(*m_host_profiler, gb_host_profiler::get_interrupt_section(flag_mask));
+            interrupt_raised = isource->update(cycles);
+        }
+        uint8_t iflags = m_iflags->read_byte(GB_IFLAGS_ADDR);
 
         // Also check if the flag bit has been set externally (i.e. by a LD instruction)
         if (interrupt_raised || (iflags & flag_mask)) {
@@ -74,9 +82,16 @@ void gb_interrupt_controller::update(int cycles) {
     // The CPU will return true/false if it handled the interrupt; it may not if it's interrupt flag is disabled
     // Update the iflags based on if the CPU handled the interrupt or not
     if (highest_priority_isource != nullptr) {
+        GB_HOST_PROFILE_SCOPE(*m_host_profiler, gb_host_profiler::GB_SECTION_INTERRUPTS);
         uint8_t flag_mask = highest_priority_isource->get_flag_mask();
         if ((m_ienable->read_byte(GB_IENABLE_ADDR) & flag_mask) && m_cpu.handle_interrupt(highest_priority_isource->get_jump_address())) {
             m_iflags->write_byte(GB_IFLAGS_ADDR, m_iflags->read_byte(GB_IFLAGS_ADDR) & ~flag_mask);
         }
     }
 }
+
+#ifdef GB_HOST_PROFILER
+void gb_interrupt_controller::set_host_profiler(gb_host_profiler* host_profiler) {
+    m_host_profiler = host_profiler;
+}
+#endif
@@ -67,6 +67,7 @@ void gb_lcd::write_byte(uint16_t addr, uint8_t val) {
 bool gb_lcd::update(int cycles) {
     bool interrupt = false;
     uint8_t ly = m_lcd_ly->read_byte(GB_LCD_LY_ADDR);
+    uint8_t prev_ly = ly;
     uint8_t lyc = m_lcd_ly->read_byte(GB_LCD_LYC_ADDR);
     uint8_t lcd_stat = read_byte(GB_LCD_STAT_ADDR);
     uint8_t mode = lcd_stat & 0x3;
@@ -74,6 +75,12 @@ bool gb_lcd::update(int cycles) {
     // Don't do anything if the LCD is off, reset LY and set mode=1 (V-blank)
     uint8_t lcdc = this->read_byte(GB_LCDC_ADDR);
     if ((lcdc & GB_LCDC_ENABLE_MASK) == 0) {
+        gb_tracer* tracer = m_memory_map.get_tracer();
+        if (tracer != nullptr) {
+            tracer->end(GB_TRACE_TRACK_SCANLINE, m_memory_map.get_cycles());
+            tracer->end(GB_TRACE_TRACK_LCD_MODE, m_memory_map.get_cycles());
+        }
+
         m_scanline_counter = 0;
         m_lcd_ly->set_ly(0);
         gb_memory_mapped_device::write_byte(GB_LCD_STAT_ADDR, (lcd_stat & ~0x7) | 0x80);
@@ -106,11 +113,7 @@ bool gb_lcd::update(int cycles) {
     } else if (m_scanline_counter < 80) {
         // The first 80 clocks of a scanline the LCD is in mode 2 (searching OAM, OAM is not accessible)
         // Don't interrupt if LCD_STAT[5] == 0
-        if (m_oam == nullptr) {
-            m_oam = m_memory_map.get_readable_device(GB_PPU_OAM_ADDR);
-            m_memory_map.remove_readable_device(GB_PPU_OAM_ADDR, GB_PPU_OAM_SIZE);
-            m_memory_map.remove_writeable_device(GB_PPU_OAM_ADDR, GB_PPU_OAM_SIZE);
-        }
+        _set_unmapped(m_oam, GB_PPU_OAM_ADDR, GB_PPU_OAM_SIZE, true);
 
         interrupt = (mode != 2 && (lcd_stat & GB_LCD_STAT_MODE2_MASK)) ? true : interrupt;
         lcd_stat = (lcd_stat & ~GB_LCD_STAT_MODE_FLAG_MASK) | 2;
@@ -118,29 +121,14 @@ bool gb_lcd::update(int cycles) {
         // LCD is in mode 3 between 80 - 252 clocks, 172 clocks, (transferring VRAM and OAM data to LCD, VRAM & OAM is not accessible)
         // This period actually varies depending on the number of sprites being rendered
         // No interrupt for mode 3
-        if (m_vram == nullptr) {
-            m_vram = m_memory_map.get_readable_device(GB_VIDEO_RAM_ADDR);
-            m_memory_map.remove_readable_device(GB_VIDEO_RAM_ADDR, GB_VIDEO_RAM_SIZE);
-            m_memory_map.remove_writeable_device(GB_VIDEO_RAM_ADDR, GB_VIDEO_RAM_SIZE);
-        }
+        _set_unmapped(m_vram, GB_VIDEO_RAM_ADDR, GB_VIDEO_RAM_SIZE, true);
 
         lcd_stat = (lcd_stat & ~0x3) | 3;
     } else if (m_scanline_counter < 456) {
         // LCD is in mode 0 between 204 - 456 clocks (H-blank)
         // Don't interrupt if LCD_STAT[3] == 0
-        if (m_oam != nullptr) {
-            gb_address_range_t addr_range = m_oam->get_address_range();
-            m_memory_map.add_readable_device(m_oam, std::get<0>(addr_range), std::get<1>(addr_range));
-            m_memory_map.add_writeable_device(m_oam, std::get<0>(addr_range), std::get<1>(addr_range));
-            m_oam = nullptr;
-        }
-
-        if (m_vram != nullptr) {
-            gb_address_range_t addr_range = m_vram->get_address_range();
-            m_memory_map.add_readable_device(m_vram, std::get<0>(addr_range), std::get<1>(addr_range));
-            m_memory_map.add_writeable_device(m_vram, std::get<0>(addr_range), std::get<1>(addr_range));
-            m_vram = nullptr;
-        }
+        _set_unmapped(m_oam, GB_PPU_OAM_ADDR, GB_PPU_OAM_SIZE, false);
+        _set_unmapped(m_vram, GB_VIDEO_RAM_ADDR, GB_VIDEO_RAM_SIZE, false);
 
         interrupt = (mode != 0 && (lcd_stat & GB_LCD_STAT_MODE0_MASK)) ? true : interrupt;
         lcd_stat = (lcd_stat & ~GB_LCD_STAT_MODE_FLAG_MASK);
@@ -149,5 +137,56 @@ bool gb_lcd::update(int cycles) {
     // Update the LCD STAT register
     gb_memory_mapped_device::write_byte(GB_LCD_STAT_ADDR, lcd_stat | 0x80);
 
+    gb_tracer* tracer = m_memory_map.get_tracer();
+    if (tracer != nullptr) _trace(*tracer, prev_ly, ly, mode, lcd_stat & GB_LCD_STAT_MODE_FLAG_MASK);
+
     return interrupt;
 }
+
+void gb_lcd::_trace(gb_tracer& tracer, uint8_t prev_ly, uint8_t ly, uint8_t prev_mode, uint8_t mode) {
+    static const gb_trace_event_t mode_events[] = {GB_TRACE_MODE_HBLANK, GB_TRACE_MODE_VBLANK, GB_TRACE_MODE_OAM, GB_TRACE_MODE_TRANSFER};
+
+    // Date the events back to when the line and mode actually started, part way through the last instruction
+    uint64_t line_start = m_memory_map.get_cycles() - static_cast<uint64_t>(m_scanline_counter);
+
+    if (ly != prev_ly) tracer.begin(GB_TRACE_SCANLINE, line_start, ly);
+
+    if (mode != prev_mode) {
+        uint64_t mode_start = line_start;
+        if (mode == 3) mode_start += 80;
+        if (mode == 0) mode_start += 252;
+        tracer.begin(mode_events[mode], mode_start, ly);
+    }
+}
+
+void gb_lcd::_set_unmapped(gb_memory_mapped_device_ptr& device, uint16_t addr, uint16_t size, bool unmapped) {
+    if (unmapped && device == nullptr) {
+        device = m_memory_map.get_readable_device(addr);
+        m_memory_map.remove_readable_device(addr, size);
+        m_memory_map.remove_writeable_device(addr, size);
+    } else if (!unmapped && device != nullptr) {
+        gb_address_range_t addr_range = device->get_address_range();
+        m_memory_map.add_readable_device(device, std::get<0>(addr_range), std::get<1>(addr_range));
+        m_memory_map.add_writeable_device(device, std::get<0>(addr_range), std::get<1>(addr_range));
+        device = nullptr;
+    }
+}
+
+void gb_lcd::save_state(gb_state_writer& state) const {
+    state.write(m_scanline_counter);
+
+    // Whether OAM and VRAM are hidden from the CPU (modes 2 and 3), a state saved mid-line has to restore that too
+    state.write(static_cast<uint8_t>(m_oam != nullptr));
+    state.write(static_cast<uint8_t>(m_vram != nullptr));
+}
+
+void gb_lcd::load_state(gb_state_reader& state) {
+    uint8_t oam_unmapped = 0, vram_unmapped = 0;
+
+    state.read(m_scanline_counter);
+    state.read(oam_unmapped);
+    state.read(vram_unmapped);
+
+    _set_unmapped(m_oam, GB_PPU_OAM_ADDR, GB_PPU_OAM_SIZE, oam_unmapped != 0);
+    _set_unmapped(m_vram, GB_VIDEO_RAM_ADDR, GB_VIDEO_RAM_SIZE, vram_unmapped != 0);
+}
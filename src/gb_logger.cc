@@ -4,23 +4,74 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <algorithm>
+#include <chrono>
+
 #include "gb_logger.h"
 
-gb_logger& gb_logger::instance() {
-    static gb_logger gbl;
-    return gbl;
+#define GB_LOGGER_WRITER_IDLE_MS (1)
+
+constexpr size_t gb_logger::GB_LOGGER_QUEUE_SIZE;
+
+gb_logger::gb_logger_buf::gb_logger_buf(gb_logger& logger)
+    : std::streambuf(), m_logger(logger), m_message()
+{
+}
+
+int gb_logger::gb_logger_buf::overflow(int c) {
+    if (c == traits_type::eof()) return traits_type::not_eof(c);
+
+    char ch = static_cast<char>(c);
+    if (m_logger.m_async) {
+        m_message.push_back(ch);
+    } else {
+        m_logger._write(&ch, 1);
+    }
+
+    return c;
+}
+
+std::streamsize gb_logger::gb_logger_buf::xsputn(const char* s, std::streamsize n) {
+    if (m_logger.m_async) {
+        m_message.append(s, static_cast<size_t>(n));
+    } else {
+        m_logger._write(s, static_cast<size_t>(n));
+    }
+
+    return n;
 }
 
-gb_logger::gb_logger()
-    : std::ostream(std::cout.rdbuf()), m_log_level(GB_LOG_FATAL)
+int gb_logger::gb_logger_buf::sync() {
+    if (!m_logger.m_async) {
+        std::lock_guard<std::mutex> lock (m_logger.m_stream_mutex);
+        m_logger.m_stream->flush();
+    } else if (!m_message.empty()) {
+        // A flush completes the message; hand it to the writer thread
+        m_logger._push(m_message.data(), m_message.size());
+        m_message.clear();
+    }
+
+    return 0;
+}
+
+gb_logger::gb_logger(std::ostream& o)
+    : std::ostream(nullptr), m_buf(*this), m_stream(&o), m_stream_mutex(), m_log_level(GB_LOG_FATAL), m_tracing(false), m_async(true),
+      m_queue(), m_head(0), m_tail(0), m_stop(false), m_writer()
 {
+    rdbuf(&m_buf);
 }
 
 gb_logger::~gb_logger() {
+    // Anything that was never flushed is still written out
+    m_buf.pubsync();
+    _stop_writer();
 }
 
 void gb_logger::set_stream(std::ostream& o) {
-    rdbuf(o.rdbuf());
+    drain();
+
+    std::lock_guard<std::mutex> lock (m_stream_mutex);
+    m_stream = &o;
 }
 
 void gb_logger::set_level(gb_logger_level_t log_level) {
@@ -39,3 +90,103 @@ gb_logger_level_t gb_logger::get_level() const {
 bool gb_logger::is_tracing() const {
     return m_tracing;
 }
+
+void gb_logger::set_async(bool async) {
+    if (async == m_async) return;
+
+    m_buf.pubsync();
+    drain();
+    m_async = async;
+}
+
+void gb_logger::drain() {
+    if (!m_writer.joinable()) return;
+
+    while (m_tail.load(std::memory_order_acquire) != m_head.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+    }
+
+    std::lock_guard<std::mutex> lock (m_stream_mutex);
+    m_stream->flush();
+}
+
+void gb_logger::_write(const char* s, size_t n) {
+    std::lock_guard<std::mutex> lock (m_stream_mutex);
+    m_stream->write(s, static_cast<std::streamsize>(n));
+}
+
+void gb_logger::_push(const char* s, size_t n) {
+    // Nothing is allocated until something is actually logged
+    if (!m_writer.joinable()) {
+        m_queue = std::make_unique<char[]>(GB_LOGGER_QUEUE_SIZE);
+        m_writer = std::thread(&gb_logger::_writer, this);
+    }
+
+    size_t head = m_head.load(std::memory_order_relaxed);
+
+    while (n > 0) {
+        size_t space = GB_LOGGER_QUEUE_SIZE - (head - m_tail.load(std::memory_order_acquire));
+
+        // The queue is full, wait for the writer to catch up
+        if (space == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        size_t offset = head & (GB_LOGGER_QUEUE_SIZE - 1);
+        size_t count = std::min(std::min(n, space), GB_LOGGER_QUEUE_SIZE - offset);
+
+        std::copy(s, s + count, m_queue.get() + offset);
+        s += count;
+        n -= count;
+        head += count;
+
+        m_head.store(head, std::memory_order_release);
+    }
+}
+
+void gb_logger::_writer() {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    bool flushed = true;
+
+    for (;;) {
+        size_t head = m_head.load(std::memory_order_acquire);
+
+        if (head == tail) {
+            if (m_stop.load(std::memory_order_acquire) && head == m_head.load(std::memory_order_acquire)) break;
+
+            if (!flushed) {
+                std::lock_guard<std::mutex> lock (m_stream_mutex);
+                m_stream->flush();
+                flushed = true;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(GB_LOGGER_WRITER_IDLE_MS));
+            continue;
+        }
+
+        // Write out everything that's available, in up to two pieces if it wraps around the end of the ring
+        {
+            std::lock_guard<std::mutex> lock (m_stream_mutex);
+            while (tail != head) {
+                size_t offset = tail & (GB_LOGGER_QUEUE_SIZE - 1);
+                size_t count = std::min(head - tail, GB_LOGGER_QUEUE_SIZE - offset);
+                m_stream->write(m_queue.get() + offset, static_cast<std::streamsize>(count));
+                tail += count;
+            }
+        }
+
+        m_tail.store(tail, std::memory_order_release);
+        flushed = false;
+    }
+
+    std::lock_guard<std::mutex> lock (m_stream_mutex);
+    m_stream->flush();
+}
+
+void gb_logger::_stop_writer() {
+    if (!m_writer.joinable()) return;
+
+    m_stop.store(true, std::memory_order_release);
+    m_writer.join();
+}
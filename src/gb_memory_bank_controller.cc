@@ -8,6 +8,9 @@
 #include <fstream>
 #include <sstream>
 #include <unordered_map>
+#include <vector>
+#include <iterator>
+#include <cstring>
 
 #include "gb_memory_bank_controller.h"
 #include "gb_io_defs.h"
@@ -26,6 +29,13 @@ enum gb_mbc_type_t {
     GB_MBC_UNKNOWN
 };
 
+// Device mapped at the external RAM address, saved as part of the MBC state
+enum gb_mbc_ram_mapping_t {
+    GB_MBC_RAM_UNMAPPED,
+    GB_MBC_RAM_MAPPED,
+    GB_MBC_RTC_MAPPED
+};
+
 struct gb_cartridge_attributes_t {
     std::string   mbc_str;
     gb_mbc_type_t mbc_type;
@@ -59,6 +69,9 @@ static gb_cartridge_attributes_map_t cartridge_attr_map =
     {0x1E, {"MBC+RUMBLE+RAM+BATTERY", GB_MBC_TYPE5, true, true, false}}
 };
 
+// Creates the ROM, RAM, RTC and MBC devices for the ROM that's been set in the memory manager
+static gb_memory_mapped_device_ptr _make_mbc(gb_memory_manager& memory_manager, gb_memory_map& memory_map, bool print_info);
+
 gb_memory_mapped_device_ptr gb_memory_bank_controller::make_mbc(gb_memory_manager& memory_manager, gb_memory_map& memory_map, const std::string& rom_filename) {
     // Read cartridge header and create appropriate RAM/ROM devices and add to the memory map
     std::ifstream rom_file (rom_filename, std::ifstream::binary);
@@ -69,21 +82,18 @@ gb_memory_mapped_device_ptr gb_memory_bank_controller::make_mbc(gb_memory_manage
         throw std::runtime_error(sstr.str());
     }
 
-    rom_file.seekg(0, rom_file.end);
-    int binsize = static_cast<int>(rom_file.tellg());
-    rom_file.seekg(0, rom_file.beg);
+    std::vector<uint8_t> rom_data ((std::istreambuf_iterator<char>(rom_file)), std::istreambuf_iterator<char>());
 
-    // Add ROM as readable device but not writeable...of course
-    gb_rom_ptr rom0 = std::make_shared<gb_rom>(memory_manager, GB_ROM_ADDR, GB_ROM_BANK_SIZE, GB_ROM_BANK_SIZE);
-    gb_address_range_t addr_range = rom0->get_address_range();
-    memory_map.add_readable_device(rom0, std::get<0>(addr_range), std::get<1>(addr_range));
+    return make_mbc(memory_manager, memory_map, rom_data.data(), rom_data.size());
+}
 
-    // Load first 16KB of ROM with ROM file data
-    rom_file.read(reinterpret_cast<char*>(rom0->get_mem()), std::min(GB_ROM_BANK_SIZE, binsize));
+gb_memory_mapped_device_ptr gb_memory_bank_controller::make_mbc(gb_memory_manager& memory_manager, gb_memory_map& memory_map, const uint8_t* rom_data, size_t rom_data_size) {
+    if (rom_data == nullptr || rom_data_size == 0) {
+        throw std::runtime_error("gb_memory_bank_controller::make_mbc() - Empty ROM image");
+    }
 
-    size_t ram_size = 0;
-    uint8_t rom_size_code = memory_map.read_byte(0x148);
-    int rom_size = 0x8000 << rom_size_code;
+    // The ROM size in the cartridge header decides the size of the ROM buffer, smaller images are padded with zeros
+    uint8_t rom_size_code = (rom_data_size > 0x148) ? rom_data[0x148] : 0;
 
     if (rom_size_code > 0x8) {
         std::ostringstream sstr;
@@ -91,6 +101,28 @@ gb_memory_mapped_device_ptr gb_memory_bank_controller::make_mbc(gb_memory_manage
         throw std::runtime_error(sstr.str());
     }
 
+    size_t rom_size = static_cast<size_t>(0x8000) << rom_size_code;
+    gb_memory_manager::gb_rom_data_ptr rom = std::make_shared<gb_memory_manager::gb_rom_data_t>(rom_size, 0);
+    memcpy(rom->data(), rom_data, std::min(rom_size, rom_data_size));
+    memory_manager.set_rom(rom);
+
+    return _make_mbc(memory_manager, memory_map, true);
+}
+
+gb_memory_mapped_device_ptr gb_memory_bank_controller::make_mbc(gb_memory_manager& memory_manager, gb_memory_map& memory_map) {
+    return _make_mbc(memory_manager, memory_map, false);
+}
+
+static gb_memory_mapped_device_ptr _make_mbc(gb_memory_manager& memory_manager, gb_memory_map& memory_map, bool print_info) {
+    size_t rom_size = memory_manager.get_rom_size();
+
+    // Add ROM as readable device but not writeable...of course
+    gb_rom_ptr rom0 = std::make_shared<gb_rom>(memory_manager, memory_map.get_logger(), GB_ROM_ADDR, GB_ROM_BANK_SIZE, 0, GB_ROM_BANK_SIZE);
+    gb_address_range_t addr_range = rom0->get_address_range();
+    memory_map.add_readable_device(rom0, std::get<0>(addr_range), std::get<1>(addr_range));
+
+    size_t ram_size = 0;
+
     gb_cartridge_attributes_t cartridge_attr;
     try {
         cartridge_attr = cartridge_attr_map.at(memory_map.read_byte(0x147));
@@ -110,17 +142,12 @@ gb_memory_mapped_device_ptr gb_memory_bank_controller::make_mbc(gb_memory_manage
         throw std::runtime_error(sstr.str());
     }
 
-    binsize -= rom_file.tellg();
-
     // Add the 2nd ROM which can be switched to multiple banks
     // rom_size is the size of the entire ROM including bank 0 (i.e. rom0). Subtract 16KB since that's taken care of by rom0
-    gb_rom_ptr rom1 = std::make_shared<gb_rom>(memory_manager, GB_ROM_BANK_SIZE, GB_ROM_BANK_SIZE, rom_size - 0x4000);
+    gb_rom_ptr rom1 = std::make_shared<gb_rom>(memory_manager, memory_map.get_logger(), GB_ROM_BANK_SIZE, GB_ROM_BANK_SIZE, GB_ROM_BANK_SIZE, rom_size - GB_ROM_BANK_SIZE);
     addr_range = rom1->get_address_range();
     memory_map.add_readable_device(rom1, std::get<0>(addr_range), std::get<1>(addr_range));
 
-    // Load the next 16KB+ of ROM into the switchable ROM banks
-    if (binsize > 0) rom_file.read(reinterpret_cast<char*>(rom1->get_mem()), std::min(rom_size - 0x4000, binsize));
-
     gb_ram_ptr ram;
     if (cartridge_attr.has_ram || (cartridge_attr.mbc_type == GB_MBC_TYPE2)) {
         // Add 8KB of external RAM (on the cartridge)
@@ -132,9 +159,11 @@ gb_memory_mapped_device_ptr gb_memory_bank_controller::make_mbc(gb_memory_manage
 
     // Create the RTC device if the cartridge has one
     gb_rtc_ptr rtc;
-    if (cartridge_attr.has_rtc) rtc = std::make_shared<gb_rtc>(memory_manager, GB_RAM_ADDR, GB_RAM_BANK_SIZE);
+    if (cartridge_attr.has_rtc) rtc = std::make_shared<gb_rtc>(memory_manager, memory_map, GB_RAM_ADDR, GB_RAM_BANK_SIZE);
 
-    GB_LOGGER(GB_LOG_INFO) << "Cartridge: " << cartridge_attr.mbc_str << std::endl << "ROM Size: " << std::hex << rom_size << std::endl << "RAM Size: " << std::hex << ram_size << std::endl;
+    if (print_info) {
+        GB_LOGGER(memory_map.get_logger(), GB_LOG_INFO) << "Cartridge: " << cartridge_attr.mbc_str << std::endl << "ROM Size: " << std::hex << rom_size << std::endl << "RAM Size: " << std::hex << ram_size << std::endl;
+    }
 
     gb_memory_mapped_device_ptr mbc;
     switch (cartridge_attr.mbc_type) {
@@ -154,6 +183,41 @@ gb_memory_mapped_device_ptr gb_memory_bank_controller::make_mbc(gb_memory_manage
     return mbc;
 }
 
+void gb_memory_bank_controller::save_state(gb_state_writer& state, gb_memory_map& memory_map, const gb_rom_ptr& rom, const gb_ram_ptr& ram, const gb_rtc_ptr& rtc) {
+    rom->save_state(state);
+    if (ram != nullptr) ram->save_state(state);
+    if (rtc != nullptr) rtc->save_state(state);
+
+    // Record which device, if any, is mapped at the external RAM address
+    gb_memory_mapped_device_ptr mapped = memory_map.get_readable_device(GB_RAM_ADDR);
+    uint8_t mapping = GB_MBC_RAM_UNMAPPED;
+    if (mapped != nullptr && mapped == ram) mapping = GB_MBC_RAM_MAPPED;
+    else if (mapped != nullptr && mapped == rtc) mapping = GB_MBC_RTC_MAPPED;
+    state.write(mapping);
+}
+
+void gb_memory_bank_controller::load_state(gb_state_reader& state, gb_memory_map& memory_map, const gb_rom_ptr& rom, const gb_ram_ptr& ram, const gb_rtc_ptr& rtc) {
+    rom->load_state(state);
+    if (ram != nullptr) ram->load_state(state);
+    if (rtc != nullptr) rtc->load_state(state);
+
+    gb_memory_mapped_device_ptr mapped;
+    switch (state.read<uint8_t>()) {
+        case GB_MBC_RAM_MAPPED: mapped = ram; break;
+        case GB_MBC_RTC_MAPPED: mapped = rtc; break;
+        default: break;
+    }
+
+    if (mapped != nullptr) {
+        gb_address_range_t addr_range = mapped->get_address_range();
+        memory_map.add_readable_device(mapped, std::get<0>(addr_range), std::get<1>(addr_range));
+        memory_map.add_writeable_device(mapped, std::get<0>(addr_range), std::get<1>(addr_range));
+    } else {
+        memory_map.remove_readable_device(GB_RAM_ADDR, GB_RAM_BANK_SIZE);
+        memory_map.remove_writeable_device(GB_RAM_ADDR, GB_RAM_BANK_SIZE);
+    }
+}
+
 gb_mbc1::gb_mbc1(gb_memory_manager& memory_manager, gb_memory_map& memory_map, gb_rom_ptr rom, gb_ram_ptr ram)
     : gb_memory_mapped_device(memory_manager),
       m_memory_map(memory_map), m_rom(rom), m_ram(ram), m_rom_or_ram_mode(false)
@@ -170,6 +234,20 @@ uint8_t gb_mbc1::read_byte(uint16_t addr) {
     throw std::out_of_range("gb_mbc1::read_byte - read operation not supported");
 }
 
+void gb_mbc1::save_state(gb_state_writer& state) const {
+    gb_memory_bank_controller::save_state(state, m_memory_map, m_rom, m_ram, nullptr);
+    state.write(m_rom_or_ram_mode);
+}
+
+void gb_mbc1::load_state(gb_state_reader& state) {
+    gb_memory_bank_controller::load_state(state, m_memory_map, m_rom, m_ram, nullptr);
+    state.read(m_rom_or_ram_mode);
+}
+
+unsigned long gb_mbc1::get_current_bank() const {
+    return (m_ram != nullptr) ? m_ram->get_current_bank() : 0;
+}
+
 void gb_mbc1::write_byte(uint16_t addr, uint8_t val) {
     uint8_t action = (addr >> 13) & 0x3;
     switch (action) {
@@ -213,7 +291,7 @@ void gb_mbc1::write_byte(uint16_t addr, uint8_t val) {
         }
         break;
         case 3: m_rom_or_ram_mode = (val & 0x1) != 0; break;
-        default: GB_LOGGER(GB_LOG_WARN) << "gb_mbc1::write_byte - Address not implemented: " << std::hex << addr << " -- " << static_cast<uint16_t>(val) << std::endl; break;
+        default: GB_LOGGER(m_memory_map.get_logger(), GB_LOG_WARN) << "gb_mbc1::write_byte - Address not implemented: " << std::hex << addr << " -- " << static_cast<uint16_t>(val) << std::endl; break;
     }
 }
 
@@ -233,6 +311,14 @@ uint8_t gb_mbc2::read_byte(uint16_t addr) {
     throw std::out_of_range("gb_mbc2::read_byte - read operation not supported");
 }
 
+void gb_mbc2::save_state(gb_state_writer& state) const {
+    gb_memory_bank_controller::save_state(state, m_memory_map, m_rom, m_ram, nullptr);
+}
+
+void gb_mbc2::load_state(gb_state_reader& state) {
+    gb_memory_bank_controller::load_state(state, m_memory_map, m_rom, m_ram, nullptr);
+}
+
 void gb_mbc2::write_byte(uint16_t addr, uint8_t val) {
     uint8_t action = (addr >> 13) & 0x3;
     switch (action) {
@@ -259,7 +345,7 @@ void gb_mbc2::write_byte(uint16_t addr, uint8_t val) {
             m_rom->set_current_bank((val & 0xf) - 1);
         }
         break;
-        default: GB_LOGGER(GB_LOG_WARN) << "gb_mbc2::write_byte - Address not implemented: " << std::hex << addr << " -- " << static_cast<uint16_t>(val) << std::endl; break;
+        default: GB_LOGGER(m_memory_map.get_logger(), GB_LOG_WARN) << "gb_mbc2::write_byte - Address not implemented: " << std::hex << addr << " -- " << static_cast<uint16_t>(val) << std::endl; break;
     }
 }
 
@@ -279,6 +365,20 @@ uint8_t gb_mbc3::read_byte(uint16_t addr) {
     throw std::out_of_range("gb_mbc3::read_byte - read operation not supported");
 }
 
+void gb_mbc3::save_state(gb_state_writer& state) const {
+    gb_memory_bank_controller::save_state(state, m_memory_map, m_rom, m_ram, m_rtc);
+    state.write(m_rtc_latch);
+}
+
+void gb_mbc3::load_state(gb_state_reader& state) {
+    gb_memory_bank_controller::load_state(state, m_memory_map, m_rom, m_ram, m_rtc);
+    state.read(m_rtc_latch);
+}
+
+unsigned long gb_mbc3::get_current_bank() const {
+    return (m_ram != nullptr) ? m_ram->get_current_bank() : 0;
+}
+
 void gb_mbc3::write_byte(uint16_t addr, uint8_t val) {
     uint8_t action = (addr >> 13) & 0x3;
     switch (action) {
@@ -328,7 +428,7 @@ void gb_mbc3::write_byte(uint16_t addr, uint8_t val) {
             m_rtc_latch = val;
         }
         break;
-        default: GB_LOGGER(GB_LOG_WARN) << "gb_mbc3::write_byte - Address not implemented: " << std::hex << addr << " -- " << static_cast<uint16_t>(val) << std::endl; break;
+        default: GB_LOGGER(m_memory_map.get_logger(), GB_LOG_WARN) << "gb_mbc3::write_byte - Address not implemented: " << std::hex << addr << " -- " << static_cast<uint16_t>(val) << std::endl; break;
     }
 }
 
@@ -348,6 +448,18 @@ uint8_t gb_mbc5::read_byte(uint16_t addr) {
     throw std::out_of_range("gb_mbc5::read_byte - read operation not supported");
 }
 
+void gb_mbc5::save_state(gb_state_writer& state) const {
+    gb_memory_bank_controller::save_state(state, m_memory_map, m_rom, m_ram, nullptr);
+}
+
+void gb_mbc5::load_state(gb_state_reader& state) {
+    gb_memory_bank_controller::load_state(state, m_memory_map, m_rom, m_ram, nullptr);
+}
+
+unsigned long gb_mbc5::get_current_bank() const {
+    return (m_ram != nullptr) ? m_ram->get_current_bank() : 0;
+}
+
 void gb_mbc5::write_byte(uint16_t addr, uint8_t val) {
     uint8_t action = (addr >> 13) & 0x3;
     switch (action) {
@@ -394,6 +506,6 @@ void gb_mbc5::write_byte(uint16_t addr, uint8_t val) {
             }
         }
         break;
-        default: GB_LOGGER(GB_LOG_WARN) << "gb_mbc5::write_byte - Address not implemented: " << std::hex << addr << " -- " << static_cast<uint16_t>(val) << std::endl; break;
+        default: GB_LOGGER(m_memory_map.get_logger(), GB_LOG_WARN) << "gb_mbc5::write_byte - Address not implemented: " << std::hex << addr << " -- " << static_cast<uint16_t>(val) << std::endl; break;
     }
 }
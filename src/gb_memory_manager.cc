@@ -4,10 +4,13 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <sstream>
+#include <stdexcept>
+
 #include "gb_memory_manager.h"
 
 gb_memory_manager::gb_memory_manager()
-    : m_mem()
+    : m_mem(), m_rom(std::make_shared<gb_rom_data_t>())
 {
 }
 
@@ -31,3 +34,44 @@ uint8_t gb_memory_manager::read_byte(unsigned long addr) {
 void gb_memory_manager::write_byte(unsigned long addr, uint8_t val) {
     m_mem.at(addr) = val;
 }
+
+void gb_memory_manager::set_rom(gb_rom_data_ptr rom) {
+    if (rom == nullptr) throw std::invalid_argument("gb_memory_manager::set_rom() - got nullptr");
+    m_rom = rom;
+}
+
+gb_memory_manager::gb_rom_data_ptr gb_memory_manager::get_rom() const {
+    return m_rom;
+}
+
+size_t gb_memory_manager::get_rom_size() const {
+    return m_rom->size();
+}
+
+uint8_t* gb_memory_manager::get_rom_mem(unsigned long addr) {
+    return (m_rom->data() + addr);
+}
+
+uint8_t gb_memory_manager::read_rom_byte(unsigned long addr) const {
+    return m_rom->at(addr);
+}
+
+size_t gb_memory_manager::get_size() const {
+    return m_mem.size();
+}
+
+void gb_memory_manager::save_state(gb_state_writer& state) const {
+    state.write<uint64_t>(m_mem.size());
+    state.write_bytes(m_mem.data(), m_mem.size());
+}
+
+void gb_memory_manager::load_state(gb_state_reader& state) {
+    uint64_t size = state.read<uint64_t>();
+    if (size != m_mem.size()) {
+        std::ostringstream sstr;
+        sstr << "gb_memory_manager::load_state() - Memory size mismatch, state has " << size << " bytes but " << m_mem.size() << " are allocated";
+        throw std::runtime_error(sstr.str());
+    }
+
+    state.read_bytes(m_mem.data(), m_mem.size());
+}
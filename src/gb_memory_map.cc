@@ -9,9 +9,10 @@
 
 #include "gb_logger.h"
 #include "gb_memory_map.h"
+#include "gb_io_defs.h"
 
-gb_memory_map::gb_memory_map()
-    : m_lomem_readable_devices({}), m_lomem_writeable_devices({}), m_himem_readable_devices({}), m_himem_writeable_devices({})
+gb_memory_map::gb_memory_map(gb_logger& logger)
+    : m_lomem_readable_devices({}), m_lomem_writeable_devices({}), m_himem_readable_devices({}), m_himem_writeable_devices({}), m_logger(logger), m_cycles(0), m_tracer(), m_counters()
 {
 }
 
@@ -114,6 +115,19 @@ void gb_memory_map::remove_writeable_device(uint16_t start_addr, size_t size) {
     }
 }
 
+gb_logger& gb_memory_map::get_logger() {
+    return m_logger;
+}
+
+void gb_memory_map::set_cycles(uint64_t cycles) {
+    if (m_tracer != nullptr) m_tracer->rebase(m_cycles, cycles);
+    m_cycles = cycles;
+}
+
+void gb_memory_map::set_tracer(gb_tracer_ptr tracer) {
+    m_tracer = tracer;
+}
+
 gb_memory_mapped_device_ptr gb_memory_map::get_readable_device(uint16_t addr) {
     gb_device_address_t dev_addr = _get_device_from_map<GB_MEMORY_MAP_LOMEM_NUM_BUCKETS, GB_MEMORY_MAP_HIMEM_NUM_BUCKETS>(m_lomem_readable_devices, m_himem_readable_devices, addr);
 
@@ -134,12 +148,37 @@ uint8_t gb_memory_map::read_byte(uint16_t addr) {
     uint16_t naddr = std::get<1>(dev_addr);
 
     if (device == nullptr) {
-        GB_LOGGER(GB_LOG_WARN) << "read_byte: Address not implemented: " << std::hex << addr << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_WARN) << "read_byte: Address not implemented: " << std::hex << addr << std::endl;
+        return 0xff;
+    }
+
+    uint8_t data = device->read_byte(naddr);
+    m_counters.record_read(addr);
+
+#ifdef GB_MEMORY_PROFILER
+    m_profiler.record_read(naddr, _get_current_bank(device, naddr));
+#endif
+
+    return data;
+}
+
+uint8_t gb_memory_map::read_byte_dma(uint16_t addr) {
+    gb_device_address_t dev_addr = _get_device_from_map<GB_MEMORY_MAP_LOMEM_NUM_BUCKETS, GB_MEMORY_MAP_HIMEM_NUM_BUCKETS>(m_lomem_readable_devices, m_himem_readable_devices, addr);
+
+    gb_memory_mapped_device_ptr device = std::get<0>(dev_addr);
+    uint16_t naddr = std::get<1>(dev_addr);
+
+    if (device == nullptr) {
+        GB_LOGGER(m_logger, GB_LOG_WARN) << "read_byte_dma: Address not implemented: " << std::hex << addr << std::endl;
         return 0xff;
     }
 
     uint8_t data = device->read_byte(naddr);
 
+#ifdef GB_MEMORY_PROFILER
+    m_profiler.record_read(naddr, _get_current_bank(device, naddr));
+#endif
+
     return data;
 }
 
@@ -152,8 +191,78 @@ void gb_memory_map::write_byte(uint16_t addr, uint8_t data) {
 
     // Ensure we actually have a device that can handle this write request
     if (device == nullptr) {
-        GB_LOGGER(GB_LOG_WARN) << "write_byte: Address not implemented: " << std::hex << addr << " -- " << std::hex << static_cast<uint16_t>(data) << std::endl;
+        GB_LOGGER(m_logger, GB_LOG_WARN) << "write_byte: Address not implemented: " << std::hex << addr << " -- " << std::hex << static_cast<uint16_t>(data) << std::endl;
     } else {
+        m_counters.record_write(addr);
+
+        // Writes to the ROM address space go to the MBC, note the banks before the write to see if they change
+        // The RAM bank is asked of the MBC since the RAM isn't in the map while it's disabled or the RTC is selected
+        bool mbc_write = (addr < GB_VIDEO_RAM_ADDR);
+        unsigned long rom_bank = mbc_write ? get_current_bank(GB_ROM_BANKN_ADDR) : 0;
+        unsigned long ram_bank = mbc_write ? device->get_current_bank() : 0;
+
+#ifdef GB_MEMORY_PROFILER
+        _profile_write(device, naddr, data);
+#else
         device->write_byte(naddr, data);
+#endif
+
+        if (mbc_write) _record_bank_switch(device, rom_bank, ram_bank);
+    }
+}
+
+void gb_memory_map::_record_bank_switch(const gb_memory_mapped_device_ptr& mbc, unsigned long rom_bank, unsigned long ram_bank) {
+    unsigned long new_rom_bank = get_current_bank(GB_ROM_BANKN_ADDR);
+    unsigned long new_ram_bank = mbc->get_current_bank();
+
+    if (new_rom_bank != rom_bank) {
+        m_counters.rom_bank_switches++;
+        if (m_tracer != nullptr) m_tracer->instant(GB_TRACE_ROM_BANK, m_cycles, static_cast<uint32_t>(new_rom_bank));
+    }
+
+    if (new_ram_bank != ram_bank) {
+        m_counters.ram_bank_switches++;
+        if (m_tracer != nullptr) m_tracer->instant(GB_TRACE_RAM_BANK, m_cycles, static_cast<uint32_t>(new_ram_bank));
+    }
+}
+
+unsigned long gb_memory_map::_get_current_bank(const gb_memory_mapped_device_ptr& device, uint16_t addr) const {
+    if (device == nullptr) return 0;
+
+    // The switchable ROM device counts it's banks from bank 1 since bank 0 is always mapped at 0x0000
+    if (addr < GB_VIDEO_RAM_ADDR) return device->get_current_bank() + (addr / GB_ROM_BANK_SIZE);
+
+    return device->get_current_bank();
+}
+
+unsigned long gb_memory_map::get_current_bank(uint16_t addr) {
+    gb_device_address_t dev_addr = _get_device_from_map<GB_MEMORY_MAP_LOMEM_NUM_BUCKETS, GB_MEMORY_MAP_HIMEM_NUM_BUCKETS>(m_lomem_readable_devices, m_himem_readable_devices, addr);
+
+    return _get_current_bank(std::get<0>(dev_addr), std::get<1>(dev_addr));
+}
+
+#ifdef GB_MEMORY_PROFILER
+gb_memory_profiler& gb_memory_map::get_profiler() {
+    return m_profiler;
+}
+
+void gb_memory_map::_profile_write(const gb_memory_mapped_device_ptr& device, uint16_t addr, uint8_t val) {
+    // Writes to the ROM address space go to the MBC, so check if the ROM or RAM banks changed
+    if (addr < GB_VIDEO_RAM_ADDR) {
+        unsigned long rom_bank = get_current_bank(GB_ROM_BANKN_ADDR);
+        unsigned long ram_bank = get_current_bank(GB_RAM_ADDR);
+        gb_memory_mapped_device_ptr ram = get_readable_device(GB_RAM_ADDR);
+
+        device->write_byte(addr, val);
+
+        if (rom_bank != get_current_bank(GB_ROM_BANKN_ADDR)) m_profiler.record_bank_switch(gb_memory_profiler::GB_BANK_ROM);
+        // MBC3 maps the RTC registers into the RAM space so switching devices counts as a RAM bank switch
+        if (ram_bank != get_current_bank(GB_RAM_ADDR) || ram != get_readable_device(GB_RAM_ADDR)) m_profiler.record_bank_switch(gb_memory_profiler::GB_BANK_RAM);
+    } else {
+        device->write_byte(addr, val);
     }
+
+    // The MBC's own bank is the RAM bank it selected, which says nothing about the register being written
+    m_profiler.record_write(addr, (addr < GB_VIDEO_RAM_ADDR) ? addr / GB_ROM_BANK_SIZE : _get_current_bank(device, addr));
 }
+#endif
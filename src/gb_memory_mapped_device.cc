@@ -56,3 +56,13 @@ void gb_memory_mapped_device::write_byte(uint16_t addr, uint8_t val) {
 
     m_memory_manager.write_byte(taddr, val);
 }
+
+unsigned long gb_memory_mapped_device::get_current_bank() const {
+    return 0;
+}
+
+void gb_memory_mapped_device::save_state(gb_state_writer& state) const {
+}
+
+void gb_memory_mapped_device::load_state(gb_state_reader& state) {
+}
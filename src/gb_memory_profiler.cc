@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "gb_memory_profiler.h"
+#include "gb_io_defs.h"
+
+gb_memory_profiler::gb_memory_profiler()
+    : m_pages(), m_rom_banks(), m_ram_banks(), m_cur_frame({0, 0}), m_frames()
+{
+    reset();
+}
+
+gb_memory_profiler::~gb_memory_profiler() {
+}
+
+gb_memory_profiler::gb_access_counts_t* gb_memory_profiler::_get_bank_counts(uint16_t addr, unsigned long bank) {
+    gb_bank_counts_t* bank_counts = nullptr;
+
+    if (addr < GB_VIDEO_RAM_ADDR) {
+        bank_counts = &m_rom_banks;
+    } else if (addr >= GB_RAM_ADDR && addr < (GB_RAM_ADDR + GB_RAM_BANK_SIZE)) {
+        bank_counts = &m_ram_banks;
+    } else {
+        return nullptr;
+    }
+
+    // Banks are only known once they are accessed so grow the list as needed
+    if (bank >= bank_counts->size()) bank_counts->resize(bank + 1, {0, 0, 0});
+
+    return &bank_counts->at(bank);
+}
+
+void gb_memory_profiler::record_read(uint16_t addr, unsigned long bank) {
+    m_pages[addr / GB_MEMORY_PROFILER_PAGE_SIZE].reads++;
+
+    gb_access_counts_t* bank_counts = _get_bank_counts(addr, bank);
+    if (bank_counts != nullptr) bank_counts->reads++;
+}
+
+void gb_memory_profiler::record_write(uint16_t addr, unsigned long bank) {
+    m_pages[addr / GB_MEMORY_PROFILER_PAGE_SIZE].writes++;
+
+    // Writes to the ROM space are MBC register writes, they don't belong to a bank
+    if (addr < GB_VIDEO_RAM_ADDR) return;
+
+    gb_access_counts_t* bank_counts = _get_bank_counts(addr, bank);
+    if (bank_counts != nullptr) bank_counts->writes++;
+}
+
+void gb_memory_profiler::record_execute(uint16_t addr, unsigned long bank) {
+    m_pages[addr / GB_MEMORY_PROFILER_PAGE_SIZE].executes++;
+
+    gb_access_counts_t* bank_counts = _get_bank_counts(addr, bank);
+    if (bank_counts != nullptr) bank_counts->executes++;
+}
+
+void gb_memory_profiler::record_bank_switch(gb_bank_type_t bank_type) {
+    if (bank_type == GB_BANK_ROM) {
+        m_cur_frame.rom++;
+    } else {
+        m_cur_frame.ram++;
+    }
+}
+
+void gb_memory_profiler::end_frame() {
+    m_frames.push_back(m_cur_frame);
+    m_cur_frame = {0, 0};
+}
+
+void gb_memory_profiler::reset() {
+    m_pages.fill({0, 0, 0});
+    m_rom_banks.clear();
+    m_ram_banks.clear();
+    m_cur_frame = {0, 0};
+    m_frames.clear();
+}
+
+void gb_memory_profiler::export_csv(std::ostream& os) const {
+    // Each section is a separate table with it's own header row, the first column names the table
+    os << "table,index,reads,writes,executes" << std::endl;
+    for (size_t i = 0; i < m_pages.size(); i++) {
+        const gb_access_counts_t& c = m_pages[i];
+        os << "page," << (i * GB_MEMORY_PROFILER_PAGE_SIZE) << "," << c.reads << "," << c.writes << "," << c.executes << std::endl;
+    }
+    for (size_t i = 0; i < m_rom_banks.size(); i++) {
+        const gb_access_counts_t& c = m_rom_banks[i];
+        os << "rom_bank," << i << "," << c.reads << "," << c.writes << "," << c.executes << std::endl;
+    }
+    for (size_t i = 0; i < m_ram_banks.size(); i++) {
+        const gb_access_counts_t& c = m_ram_banks[i];
+        os << "ram_bank," << i << "," << c.reads << "," << c.writes << "," << c.executes << std::endl;
+    }
+
+    os << std::endl << "table,frame,rom_bank_switches,ram_bank_switches" << std::endl;
+    for (size_t i = 0; i < m_frames.size(); i++) {
+        os << "frame," << i << "," << m_frames[i].rom << "," << m_frames[i].ram << std::endl;
+    }
+}
+
+void gb_memory_profiler::export_json(std::ostream& os) const {
+    auto _export_counts = [&os] (const std::string& name, const gb_access_counts_t* counts, size_t size, size_t scale) -> void {
+        os << "  \"" << name << "\": [" << std::endl;
+        for (size_t i = 0; i < size; i++) {
+            os << "    {\"index\": " << (i * scale) << ", \"reads\": " << counts[i].reads << ", \"writes\": " << counts[i].writes
+               << ", \"executes\": " << counts[i].executes << "}" << ((i + 1 < size) ? "," : "") << std::endl;
+        }
+        os << "  ]," << std::endl;
+    };
+
+    os << "{" << std::endl;
+    _export_counts("pages", m_pages.data(), m_pages.size(), GB_MEMORY_PROFILER_PAGE_SIZE);
+    _export_counts("rom_banks", m_rom_banks.data(), m_rom_banks.size(), 1);
+    _export_counts("ram_banks", m_ram_banks.data(), m_ram_banks.size(), 1);
+
+    os << "  \"bank_switches_per_frame\": [" << std::endl;
+    for (size_t i = 0; i < m_frames.size(); i++) {
+        os << "    {\"rom\": " << m_frames[i].rom << ", \"ram\": " << m_frames[i].ram << "}" << ((i + 1 < m_frames.size()) ? "," : "") << std::endl;
+    }
+    os << "  ]" << std::endl;
+    os << "}" << std::endl;
+}
+
+void gb_memory_profiler::export_to_file(const std::string& filename) const {
+    std::ofstream out_file (filename);
+
+    if (!out_file) {
+        std::ostringstream sstr;
+        sstr << "gb_memory_profiler::export_to_file() - Unable to open file: " << filename;
+        throw std::runtime_error(sstr.str());
+    }
+
+    const std::string json_ext (".json");
+    bool is_json = filename.size() >= json_ext.size() && filename.compare(filename.size() - json_ext.size(), json_ext.size(), json_ext) == 0;
+
+    if (is_json) {
+        export_json(out_file);
+    } else {
+        export_csv(out_file);
+    }
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <sstream>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+#include "gb_movie.h"
+#include "gb_state.h"
+
+struct gb_movie_header_t {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t rom_hash;
+    uint64_t frame_count;
+    uint64_t state_size;
+};
+
+gb_movie::gb_movie()
+    : m_rom_hash(0), m_start_state(), m_runs(), m_frame_count(0)
+{
+}
+
+void gb_movie::start(uint64_t rom_hash, const std::vector<uint8_t>& start_state) {
+    m_rom_hash = rom_hash;
+    m_start_state = start_state;
+    m_runs.clear();
+    m_frame_count = 0;
+}
+
+void gb_movie::add_frame(uint8_t buttons) {
+    if (m_runs.empty() || m_runs.back().buttons != buttons) m_runs.push_back({m_frame_count, buttons});
+    m_frame_count++;
+}
+
+uint8_t gb_movie::get_buttons(uint64_t frame) const {
+    if (frame >= m_frame_count) return 0;
+
+    // Find the last run starting at or before the frame
+    auto run = std::upper_bound(m_runs.begin(), m_runs.end(), frame, [](uint64_t f, const gb_movie_run_t& r) { return f < r.first_frame; });
+    return std::prev(run)->buttons;
+}
+
+uint64_t gb_movie::get_frame_count() const {
+    return m_frame_count;
+}
+
+uint64_t gb_movie::get_rom_hash() const {
+    return m_rom_hash;
+}
+
+const std::vector<uint8_t>& gb_movie::get_start_state() const {
+    return m_start_state;
+}
+
+void gb_movie::save(const std::string& filename) const {
+    std::vector<uint8_t> movie;
+    gb_state_writer writer (movie);
+
+    gb_movie_header_t header = {};
+    header.magic = GB_MOVIE_MAGIC;
+    header.version = GB_MOVIE_VERSION;
+    header.rom_hash = m_rom_hash;
+    header.frame_count = m_frame_count;
+    header.state_size = m_start_state.size();
+
+    writer.write(header);
+    writer.write_bytes(m_start_state.data(), m_start_state.size());
+
+    for (size_t i = 0; i < m_runs.size(); i++) {
+        uint64_t end = (i + 1 < m_runs.size()) ? m_runs[i + 1].first_frame : m_frame_count;
+
+        // Runs longer than a uint32 are split up
+        for (uint64_t frames = end - m_runs[i].first_frame; frames > 0; ) {
+            uint32_t length = static_cast<uint32_t>(std::min<uint64_t>(frames, std::numeric_limits<uint32_t>::max()));
+            writer.write(length);
+            writer.write(m_runs[i].buttons);
+            frames -= length;
+        }
+    }
+
+    std::ofstream file (filename, std::ofstream::binary);
+    if (!file || !file.write(reinterpret_cast<const char*>(movie.data()), static_cast<std::streamsize>(movie.size()))) {
+        std::ostringstream sstr;
+        sstr << "gb_movie::save() - Can't write file: " << filename;
+        throw std::runtime_error(sstr.str());
+    }
+}
+
+void gb_movie::load(const std::string& filename) {
+    std::ifstream file (filename, std::ifstream::binary);
+    if (!file) {
+        std::ostringstream sstr;
+        sstr << "gb_movie::load() - Can't open file: " << filename;
+        throw std::runtime_error(sstr.str());
+    }
+
+    std::vector<uint8_t> movie ((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    gb_state_reader reader (movie.data(), movie.size());
+    gb_movie_header_t header = reader.read<gb_movie_header_t>();
+
+    if (header.magic != GB_MOVIE_MAGIC) {
+        throw std::runtime_error("gb_movie::load() - Not a movie: " + filename);
+    }
+
+    if (header.version != GB_MOVIE_VERSION) {
+        std::ostringstream sstr;
+        sstr << "gb_movie::load() - Unsupported movie version: " << header.version << " (expected " << GB_MOVIE_VERSION << ")";
+        throw std::runtime_error(sstr.str());
+    }
+
+    std::vector<uint8_t> start_state (static_cast<size_t>(std::min<uint64_t>(header.state_size, reader.remaining())));
+    if (start_state.size() != header.state_size) {
+        throw std::runtime_error("gb_movie::load() - Movie is truncated: " + filename);
+    }
+    reader.read_bytes(start_state.data(), start_state.size());
+
+    start(header.rom_hash, start_state);
+    while (reader.remaining() != 0) {
+        uint32_t length = reader.read<uint32_t>();
+        uint8_t buttons = reader.read<uint8_t>();
+        if (length == 0) continue;
+        if (m_runs.empty() || m_runs.back().buttons != buttons) m_runs.push_back({m_frame_count, buttons});
+        m_frame_count += length;
+    }
+
+    if (m_frame_count != header.frame_count) {
+        std::ostringstream sstr;
+        sstr << "gb_movie::load() - Movie has " << m_frame_count << " frames (expected " << header.frame_count << ")";
+        throw std::runtime_error(sstr.str());
+    }
+}
+
+uint64_t gb_movie::hash(const uint8_t* data, size_t size) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ data[i]) * 0x100000001b3ull;
+    }
+    return h;
+}
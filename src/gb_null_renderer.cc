@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "gb_null_renderer.h"
+
+gb_null_renderer::gb_null_renderer(uint64_t max_frames)
+    : gb_renderer(), m_open(true), m_max_frames(max_frames), m_frame_count(0)
+{
+}
+
+gb_null_renderer::~gb_null_renderer() {
+}
+
+bool gb_null_renderer::is_open() {
+    return m_open;
+}
+
+void gb_null_renderer::close() {
+    m_open = false;
+}
+
+void gb_null_renderer::update(bool draw_framebuffer) {
+    m_frame_count++;
+    if (m_max_frames != 0 && m_frame_count >= m_max_frames) close();
+}
+
+uint64_t gb_null_renderer::get_frame_count() const {
+    return m_frame_count;
+}
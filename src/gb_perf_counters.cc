@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string>
+#include <iomanip>
+
+#include "gb_perf_counters.h"
+
+static const char* const g_region_names[GB_PERF_REGION_COUNT] = {"rom0", "romx", "vram", "cart_ram", "wram", "oam", "io", "hram"};
+static const char* const g_interrupt_names[GB_PERF_NUM_INTERRUPTS] = {"vblank", "stat", "timer", "serial", "joypad"};
+
+gb_perf_counters::gb_perf_counters()
+    : instructions(0), cycles(0), halt_cycles(0), reads(), writes(), rom_bank_switches(0), ram_bank_switches(0), interrupts(),
+      dma_bytes(0), frames(0)
+{
+}
+
+void gb_perf_counters::reset() {
+    instructions = 0;
+    cycles = 0;
+    halt_cycles = 0;
+    reads.fill(0);
+    writes.fill(0);
+    rom_bank_switches = 0;
+    ram_bank_switches = 0;
+    interrupts.fill(0);
+    dma_bytes = 0;
+    frames = 0;
+}
+
+void gb_perf_counters::report(std::ostream& os) const {
+    auto _report_counter = [&os] (const std::string& name, uint64_t count) -> void {
+        os << std::left << std::setw(20) << name << std::right << std::setw(16) << count << std::endl;
+    };
+
+    std::ios::fmtflags flags = os.flags();
+    char fill = os.fill(' ');
+    os << std::dec;
+
+    _report_counter("instructions", instructions);
+    _report_counter("cycles", cycles);
+    _report_counter("halt_cycles", halt_cycles);
+    for (int i = 0; i < GB_PERF_REGION_COUNT; i++) _report_counter(std::string("reads.") + g_region_names[i], reads[i]);
+    for (int i = 0; i < GB_PERF_REGION_COUNT; i++) _report_counter(std::string("writes.") + g_region_names[i], writes[i]);
+    _report_counter("rom_bank_switches", rom_bank_switches);
+    _report_counter("ram_bank_switches", ram_bank_switches);
+    for (int i = 0; i < GB_PERF_NUM_INTERRUPTS; i++) _report_counter(std::string("interrupts.") + g_interrupt_names[i], interrupts[i]);
+    _report_counter("dma_bytes", dma_bytes);
+    _report_counter("frames", frames);
+
+    os.fill(fill);
+    os.flags(flags);
+}
+
+void gb_perf_counters::export_json(std::ostream& os) const {
+    auto _export_counts = [&os] (const char* name, const uint64_t* counts, const char* const* names, int num_counts) -> void {
+        os << ", \"" << name << "\": {";
+        for (int i = 0; i < num_counts; i++) os << ((i != 0) ? ", " : "") << "\"" << names[i] << "\": " << counts[i];
+        os << "}";
+    };
+
+    std::ios::fmtflags flags = os.flags();
+    os << std::dec;
+
+    os << "{\"instructions\": " << instructions << ", \"cycles\": " << cycles << ", \"halt_cycles\": " << halt_cycles;
+    _export_counts("reads", reads.data(), g_region_names, GB_PERF_REGION_COUNT);
+    _export_counts("writes", writes.data(), g_region_names, GB_PERF_REGION_COUNT);
+    os << ", \"rom_bank_switches\": " << rom_bank_switches << ", \"ram_bank_switches\": " << ram_bank_switches;
+    _export_counts("interrupts", interrupts.data(), g_interrupt_names, GB_PERF_NUM_INTERRUPTS);
+    os << ", \"dma_bytes\": " << dma_bytes << ", \"frames\": " << frames << "}" << std::endl;
+
+    os.flags(flags);
+}
@@ -4,6 +4,9 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <algorithm>
+#include <stdexcept>
+
 #include "gb_ppu.h"
 #include "gb_io_defs.h"
 #include "gb_logger.h"
@@ -15,6 +18,7 @@
 #define GB_PPU_BG_TILE_MAP1_ADDR      (0x9c00)
 #define GB_PPU_TILE_DATA0_BASE_ADDR   (0x9000)
 #define GB_PPU_TILE_DATA1_BASE_ADDR   (0x8000)
+#define GB_PPU_TILE_DATA_END_ADDR     (0x9800)
 
 struct gb_ppu_sprite_t {
     uint8_t  entry_num; // Entry # in the OAM, used for priority calculation
@@ -27,14 +31,50 @@ struct gb_ppu_sprite_t {
     bool     use_obp1;
 };
 
+gb_ppu::gb_ppu_register::gb_ppu_register(gb_memory_manager& memory_manager, gb_ppu& ppu, uint16_t start_addr, size_t size)
+    : gb_memory_mapped_device(memory_manager, start_addr, size), m_ppu(ppu)
+{
+}
+
+gb_ppu::gb_ppu_register::~gb_ppu_register() {
+}
+
+void gb_ppu::gb_ppu_register::write_byte(uint16_t addr, uint8_t val) {
+    m_ppu._catch_up();
+    gb_memory_mapped_device::write_byte(addr, val);
+}
+
+gb_ppu::gb_ppu_lcdc_register::gb_ppu_lcdc_register(gb_memory_manager& memory_manager, gb_ppu& ppu, gb_memory_mapped_device_ptr lcd)
+    : gb_memory_mapped_device(memory_manager), m_ppu(ppu), m_lcd(lcd)
+{
+    m_start_addr = GB_LCDC_ADDR;
+    m_size = 1;
+}
+
+gb_ppu::gb_ppu_lcdc_register::~gb_ppu_lcdc_register() {
+}
+
+void gb_ppu::gb_ppu_lcdc_register::write_byte(uint16_t addr, uint8_t val) {
+    m_ppu._catch_up();
+
+    // LY was held at 0 while the LCD was off so line 0 was skipped, turning it back on starts a new frame from line 0
+    if ((m_lcd->read_byte(addr) & GB_LCDC_ENABLE_MASK) == 0 && (val & GB_LCDC_ENABLE_MASK) != 0) m_ppu.m_next_line = 0;
+
+    m_lcd->write_byte(addr, val);
+}
+
 gb_ppu::gb_ppu(gb_memory_manager& memory_manager, gb_memory_map& memory_map, gb_framebuffer& framebuffer)
     : gb_memory_mapped_device(memory_manager, GB_VIDEO_RAM_ADDR, GB_VIDEO_RAM_SIZE),
       gb_interrupt_source(GB_PPU_VBLANK_JUMP_ADDR, GB_PPU_VBLANK_FLAG_BIT),
-      m_ppu_bg_scroll(std::make_shared<gb_memory_mapped_device>(memory_manager, GB_PPU_BG_SCROLL_Y_ADDR, 2)),
-      m_ppu_palette(std::make_shared<gb_memory_mapped_device>(memory_manager, GB_PPU_BGP_ADDR, 3)),
-      m_ppu_win_scroll(std::make_shared<gb_memory_mapped_device>(memory_manager, GB_PPU_WIN_SCROLL_Y_ADDR, 2)),
-      m_ppu_oam(std::make_shared<gb_memory_mapped_device>(memory_manager, GB_PPU_OAM_ADDR, GB_PPU_OAM_SIZE)),
-      m_memory_map(memory_map), m_framebuffer(framebuffer), m_linebuffer(), m_next_line(0)
+      m_ppu_bg_scroll(std::make_shared<gb_ppu_register>(memory_manager, *this, GB_PPU_BG_SCROLL_Y_ADDR, 2)),
+      m_ppu_palette(std::make_shared<gb_ppu_register>(memory_manager, *this, GB_PPU_BGP_ADDR, 3)),
+      m_ppu_win_scroll(std::make_shared<gb_ppu_register>(memory_manager, *this, GB_PPU_WIN_SCROLL_Y_ADDR, 2)),
+      m_ppu_oam(std::make_shared<gb_ppu_register>(memory_manager, *this, GB_PPU_OAM_ADDR, GB_PPU_OAM_SIZE)),
+      m_ppu_lcdc(std::make_shared<gb_ppu_lcdc_register>(memory_manager, *this, memory_map.get_writeable_device(GB_LCDC_ADDR))),
+      m_lcd_ly(memory_map.get_readable_device(GB_LCD_LY_ADDR)),
+      m_memory_map(memory_map), m_framebuffer(framebuffer), m_tile_cache(), m_tile_cache_flipped(), m_tile_dirty(),
+      m_line_bg(), m_line_shade(), m_line_sprite(), m_apply_palette(gb_ppu_simd::get_apply_palette()), m_render(true),
+      m_next_line(0), m_last_ly(-1)
 {
     // Add the OAM memory to the memory map
     gb_address_range_t addr_range = m_ppu_oam->get_address_range();
@@ -53,58 +93,29 @@ gb_ppu::gb_ppu(gb_memory_manager& memory_manager, gb_memory_map& memory_map, gb_
     addr_range = m_ppu_win_scroll->get_address_range();
     memory_map.add_readable_device(m_ppu_win_scroll, std::get<0>(addr_range), std::get<1>(addr_range));
     memory_map.add_writeable_device(m_ppu_win_scroll, std::get<0>(addr_range), std::get<1>(addr_range));
+
+    // Intercept writes to LCDC; the LCD controller must be added to the memory map before the PPU
+    if (m_lcd_ly == nullptr) throw std::logic_error("gb_ppu::gb_ppu - LCD controller must be added to the memory map first");
+    addr_range = m_ppu_lcdc->get_address_range();
+    memory_map.add_writeable_device(m_ppu_lcdc, std::get<0>(addr_range), std::get<1>(addr_range));
+
+    // Nothing has been decoded yet
+    m_tile_dirty.set();
 }
 
 gb_ppu::~gb_ppu() {
 }
 
-void gb_ppu::_draw_background(uint8_t ly) {
-    uint8_t lcdc = m_memory_map.read_byte(GB_LCDC_ADDR);
-    uint8_t scx = m_ppu_bg_scroll->read_byte(GB_PPU_BG_SCROLL_X_ADDR);
-    uint8_t scy = m_ppu_bg_scroll->read_byte(GB_PPU_BG_SCROLL_Y_ADDR);
-
-    uint8_t background_palette = m_ppu_palette->read_byte(GB_PPU_BGP_ADDR);
-    uint16_t background_tile_map_addr = (lcdc & GB_LCDC_TILE_MAP_SEL_MASK) ? GB_PPU_BG_TILE_MAP1_ADDR : GB_PPU_BG_TILE_MAP0_ADDR;
-    uint16_t background_tile_data_sel_addr = (lcdc & GB_LCDC_TILE_DATA_SEL_MASK) ? GB_PPU_TILE_DATA1_BASE_ADDR : GB_PPU_TILE_DATA0_BASE_ADDR;
-
-    uint8_t pixel_y = (scy + ly) & 0xff;
-    uint8_t tile_y = pixel_y >> 3;
-    uint8_t tile_pixel_y_offset = (pixel_y & 0x7) * 2;
-
-    // The background tile map makes up 256x256 pixels (only 160x144 are shown on the screen depending on SCX and SCY)
-    // The background tile map is laid out as 32x32 tiles. Each byte refers to a tile number.
-    // First convert the pixel x & y coordinates to tile coordinates tx, ty
-    // The background tile map start either at 0x9c00 or 0x9800 depending on LCDC[3]
-    auto get_tile_num = [this](uint16_t bgtm, uint8_t tx, uint8_t ty) -> uint8_t {
-        return this->read_byte(bgtm + ((ty * 32) + tx));
-    };
-
-    // The tile number is used to index into the background tile data select array
-    // There's two of them, but one of the used at a time depending on LCDC[4]
-    // Starting at 0x8000, the tile number is used as an unsigned index between 0-255
-    // Starting at 0x9000, the tile number is used as a signed index between -127-127
-    // Each tile is 8x8 pixels, composed of 16 bytes, 2 bytes per line of 8 pixels.
-    auto get_tile_data_addr = [lcdc](uint16_t bgtds, uint8_t tile_num) -> uint16_t {
-        if (lcdc & GB_LCDC_TILE_DATA_SEL_MASK) return (bgtds + (tile_num * 16));
-        else return static_cast<uint16_t>(static_cast<int>(bgtds) + (static_cast<int8_t>(tile_num) * 16));
-    };
+void gb_ppu::_decode_tile(unsigned int tile) {
+    const uint8_t* tile_data = get_mem() + (tile * 16);
+    uint8_t* decoded = m_tile_cache.data() + (tile * 64);
+    uint8_t* decoded_flipped = m_tile_cache_flipped.data() + (tile * 64);
 
     // A tiles pixel colour is composed of two bits, one from the upper byte and the other from the lower byte of the line
     // Suppos if tile# == 0, the 16 bytes of the tile 0 data may look something like this:
     // 0x8000: 01101001
     // 0x8001: 10010110
-    // 0x8002: 01101001
-    // 0x8003: 10010110
-    // 0x8004: 01101001
-    // 0x8005: 10010110
-    // 0x8006: 01101001
-    // 0x8007: 10010110
-    // 0x8008: 01101001
-    // 0x8009: 10010110
-    // 0x800a: 01101001
-    // 0x800b: 10010110
-    // 0x800c: 01101001
-    // 0x800d: 10010110
+    // ...
     // 0x800e: 01101001
     // 0x800f: 10010110
     // Then pixel data for line 0 of the tile:
@@ -122,31 +133,73 @@ void gb_ppu::_draw_background(uint8_t ly) {
     // pixel[5] = 10
     // pixel[6] = 10
     // pixel[7] = 01
-    auto get_tile_pixel_colour_idx = [this, tile_pixel_y_offset](uint16_t tile_data_addr, uint8_t tile_pixel_x) -> uint8_t {
-        uint8_t tile_line_lo = this->read_byte(tile_data_addr + tile_pixel_y_offset);
-        uint8_t tile_line_hi = this->read_byte(tile_data_addr + tile_pixel_y_offset+ 1);
-        uint8_t x = 7 - tile_pixel_x;
-        return static_cast<uint8_t>(((tile_line_lo >> x) & 0x1) | (((tile_line_hi >> x) & 0x1) << 1));
+    // The decoded tile stores the colour index of each pixel from left to right (i.e. bit 7 first)
+    for (unsigned int row = 0; row < 8; row++) {
+        gb_ppu_simd::expand_tile_row(tile_data[row * 2], tile_data[(row * 2) + 1], decoded + (row * 8), decoded_flipped + (row * 8));
+    }
+
+    m_tile_dirty.reset(tile);
+}
+
+const uint8_t* gb_ppu::_get_tile_row(unsigned int tile, unsigned int row, bool flip_x) {
+    if (m_tile_dirty.test(tile)) _decode_tile(tile);
+
+    const gb_ppu_tile_cache_t& tile_cache = flip_x ? m_tile_cache_flipped : m_tile_cache;
+    return tile_cache.data() + (tile * 64) + (row * 8);
+}
+
+void gb_ppu::_draw_background(const gb_ppu_registers_t& regs, const uint8_t* vram, uint8_t ly) {
+    uint8_t lcdc = regs.lcdc;
+    uint8_t scx = regs.scx;
+    uint8_t scy = regs.scy;
+
+    // If the background is disabled it's drawn as colour 0
+    if ((lcdc & GB_LCDC_BG_WIN_ENABLE_MASK) == 0) {
+        m_line_bg.fill(0);
+        return;
+    }
+
+    uint16_t background_tile_map_addr = (lcdc & GB_LCDC_TILE_MAP_SEL_MASK) ? GB_PPU_BG_TILE_MAP1_ADDR : GB_PPU_BG_TILE_MAP0_ADDR;
+
+    uint8_t pixel_y = (scy + ly) & 0xff;
+    uint8_t tile_y = pixel_y >> 3;
+    uint8_t tile_pixel_y = pixel_y & 0x7;
+
+    // The background tile map makes up 256x256 pixels (only 160x144 are shown on the screen depending on SCX and SCY)
+    // The background tile map is laid out as 32x32 tiles. Each byte refers to a tile number.
+    // The background tile map start either at 0x9c00 or 0x9800 depending on LCDC[3]
+    const uint8_t* tile_map_row = vram + (background_tile_map_addr - GB_VIDEO_RAM_ADDR) + (tile_y * 32);
+
+    // The tile number is used to index into the background tile data select array
+    // There's two of them, but one of the used at a time depending on LCDC[4]
+    // Starting at 0x8000, the tile number is used as an unsigned index between 0-255
+    // Starting at 0x9000, the tile number is used as a signed index between -127-127
+    // Convert it to an index into the tile cache which covers all 384 tiles starting from 0x8000
+    auto get_tile_index = [lcdc](uint8_t tile_num) -> unsigned int {
+        if (lcdc & GB_LCDC_TILE_DATA_SEL_MASK) return tile_num;
+        else return static_cast<unsigned int>(256 + static_cast<int8_t>(tile_num));
     };
 
-    for (uint8_t lx = 0; lx < 160; lx++) {
-        uint8_t pixel_x = (scx + lx) & 0xff;
-        uint8_t tile_x = pixel_x >> 3;
-        uint8_t tile_pixel_x = pixel_x & 0x7;
-        uint16_t tile_data_addr = get_tile_data_addr(background_tile_data_sel_addr, get_tile_num(background_tile_map_addr, tile_x, tile_y));
+    // Copy a row of 8 pixels from each tile along the scanline. The first tile may be partially scrolled off the left edge
+    // and the last tile may spill over the right edge into the slack at the end of the linebuffer
+    uint8_t tile_x = scx >> 3;
+    uint8_t tile_pixel_x = scx & 0x7;
+
+    const uint8_t* tile_row = _get_tile_row(get_tile_index(tile_map_row[tile_x]), tile_pixel_y, false);
+    std::copy(tile_row + tile_pixel_x, tile_row + 8, m_line_bg.begin());
 
-        // Get the colour index and put it in the linebuffer along with the palette
-        // This will be used by the sprite rendering logic to determine background priority
-        uint8_t col_idx = get_tile_pixel_colour_idx(tile_data_addr, tile_pixel_x);
-        m_linebuffer.at(lx) = {GB_PPU_BG_PIXEL, static_cast<uint8_t>((lcdc & GB_LCDC_BG_WIN_ENABLE_MASK) ? col_idx : 0), background_palette};
+    for (unsigned int lx = 8u - tile_pixel_x; lx < 160; lx += 8) {
+        tile_x = (tile_x + 1) & 0x1f;
+        tile_row = _get_tile_row(get_tile_index(tile_map_row[tile_x]), tile_pixel_y, false);
+        std::copy(tile_row, tile_row + 8, m_line_bg.begin() + lx);
     }
 }
 
-void gb_ppu::_draw_window(uint8_t ly) {
-    uint8_t lcdc = m_memory_map.read_byte(GB_LCDC_ADDR);
+void gb_ppu::_draw_window(const gb_ppu_registers_t& regs, const uint8_t* vram, uint8_t ly) {
+    uint8_t lcdc = regs.lcdc;
 
-    int wx = static_cast<int>(m_ppu_win_scroll->read_byte(GB_PPU_WIN_SCROLL_X_ADDR));
-    int wy = static_cast<int>(m_ppu_win_scroll->read_byte(GB_PPU_WIN_SCROLL_Y_ADDR));
+    int wx = static_cast<int>(regs.wx);
+    int wy = static_cast<int>(regs.wy);
 
     // The window isn't visible if the background/window isn't enabled, the window isn't enabled,
     // wx < 0 or wx >= 167, or wy < 0 or wy >= 144
@@ -155,54 +208,39 @@ void gb_ppu::_draw_window(uint8_t ly) {
     // Check the scanline counter against the window scroll Y position. Don't start drawing until LY reaches WY
     if (ly < wy) return;
 
-    uint8_t window_palette = m_ppu_palette->read_byte(GB_PPU_BGP_ADDR);
     uint16_t window_tile_map_addr = (lcdc & GB_LCDC_WIN_TILE_MAP_SEL_MASK) ? GB_PPU_BG_TILE_MAP1_ADDR : GB_PPU_BG_TILE_MAP0_ADDR;
-    uint16_t window_tile_data_sel_addr = (lcdc & GB_LCDC_TILE_DATA_SEL_MASK) ? GB_PPU_TILE_DATA1_BASE_ADDR : GB_PPU_TILE_DATA0_BASE_ADDR;
 
     uint8_t pixel_y = static_cast<uint8_t>((wy + ly) & 0xff);
     uint8_t tile_y = pixel_y >> 3;
-    uint8_t tile_pixel_y_offset = (pixel_y & 0x7) * 2;
+    uint8_t tile_pixel_y = pixel_y & 0x7;
 
     // The window tile map is overlaid on top of the background. The WX and WY registers hold the starting position of the
     // window that will be shown on top of the background (stretching all the way to the right and to the bottom of the screen)
-    auto get_tile_num = [this](uint16_t wtm, uint8_t tx, uint8_t ty) -> uint8_t {
-        return this->read_byte(wtm + ((ty * 32) + tx));
-    };
+    const uint8_t* tile_map_row = vram + (window_tile_map_addr - GB_VIDEO_RAM_ADDR) + (tile_y * 32);
 
     // The tile number in the window tile map is used to index into one of the two tile data arrays in video RAM
     // This is pretty much similar to how the background tile data array works
-    auto get_tile_data_addr = [lcdc](uint16_t wtds, uint8_t tile_num) -> uint16_t {
-        if (lcdc & GB_LCDC_TILE_DATA_SEL_MASK) return (wtds + (tile_num * 16));
-        else return static_cast<uint16_t>(static_cast<int>(wtds) + (static_cast<int8_t>(tile_num) * 16));
-    };
-
-    // This is again similar to how the background pixel colours work
-    auto get_tile_pixel_colour_idx = [this, tile_pixel_y_offset](uint16_t tile_data_addr, uint8_t tile_pixel_x) -> uint8_t {
-        uint8_t tile_line_lo = this->read_byte(tile_data_addr + tile_pixel_y_offset);
-        uint8_t tile_line_hi = this->read_byte(tile_data_addr + tile_pixel_y_offset+ 1);
-        uint8_t x = 7 - tile_pixel_x;
-        return static_cast<uint8_t>(((tile_line_lo >> x) & 0x1) | (((tile_line_hi >> x) & 0x1) << 1));
+    auto get_tile_index = [lcdc](uint8_t tile_num) -> unsigned int {
+        if (lcdc & GB_LCDC_TILE_DATA_SEL_MASK) return tile_num;
+        else return static_cast<unsigned int>(256 + static_cast<int8_t>(tile_num));
     };
 
     // Start drawing the window from WX (minus 7)
     // The WIN_SCROLL_X register needs to be offset by 7
+    // The tile is picked based on the screen X position while the pixel within the tile is relative to WX
     wx -= 7;
-    for (int lx = wx; lx < 160; lx++) {
-        // If the pixel location is negative then skip it
-        if (lx < 0) continue;
-
+    for (int lx = std::max(wx, 0); lx < 160; ) {
         uint8_t tile_x = static_cast<uint8_t>(lx >> 3);
-        uint8_t tile_pixel_x = static_cast<uint8_t>((lx - wx) & 0x7);
-        uint16_t tile_data_addr = get_tile_data_addr(window_tile_data_sel_addr, get_tile_num(window_tile_map_addr, tile_x, tile_y));
-        uint8_t col_idx = get_tile_pixel_colour_idx(tile_data_addr, tile_pixel_x);
+        const uint8_t* tile_row = _get_tile_row(get_tile_index(tile_map_row[tile_x]), tile_pixel_y, false);
 
-        // Push the pixel into the linebuffer
-        m_linebuffer.at(static_cast<uint8_t>(lx)) = {GB_PPU_BG_PIXEL, col_idx, window_palette};
+        for (int end = (tile_x + 1) * 8; lx < end && lx < 160; lx++) {
+            m_line_bg[static_cast<size_t>(lx)] = tile_row[(lx - wx) & 0x7];
+        }
     }
 }
 
-void gb_ppu::_draw_sprites(uint8_t ly) {
-    uint8_t lcdc = m_memory_map.read_byte(GB_LCDC_ADDR);
+void gb_ppu::_draw_sprites(const gb_ppu_registers_t& regs, const uint8_t* oam, uint8_t ly) {
+    uint8_t lcdc = regs.lcdc;
 
     // Don't draw sprites if LCDC[1] == 0
     if ((lcdc & GB_LCDC_SPRITE_ENABLE_MASK) == 0) return;
@@ -210,9 +248,8 @@ void gb_ppu::_draw_sprites(uint8_t ly) {
     // Sprites can either 8x8 pixels or 8x16 pixels depending on LCDC[2]
     bool double_size = (lcdc & GB_LCDC_SPRITE_SIZE_MASK) ? true : false;
     uint8_t sprite_size = double_size ? 16 : 8;
-    uint16_t sprite_tile_data_addr = GB_VIDEO_RAM_ADDR;
-    uint8_t obp0 = m_ppu_palette->read_byte(GB_PPU_OBP0_ADDR);
-    uint8_t obp1 = m_ppu_palette->read_byte(GB_PPU_OBP1_ADDR);
+    uint8_t obp0 = regs.obp0;
+    uint8_t obp1 = regs.obp1;
 
     // Search the Object Attribute Memory and Accumulate a list of of Sprites
     // that are visible in general and are visible in the current scanline
@@ -231,12 +268,12 @@ void gb_ppu::_draw_sprites(uint8_t ly) {
     std::vector<gb_ppu_sprite_t> visible_sprites;
     visible_sprites.reserve(40);
     for (unsigned int i = 0; i < 40; i++) {
-        uint16_t oam_entry_addr = static_cast<uint16_t>(GB_PPU_OAM_ADDR + (i * 4));
+        const uint8_t* oam_entry = oam + (i * 4);
 
-        uint8_t y = m_ppu_oam->read_byte(oam_entry_addr);
-        uint8_t x = m_ppu_oam->read_byte(oam_entry_addr + 1);
-        uint8_t tile_num = m_ppu_oam->read_byte(oam_entry_addr + 2);
-        uint8_t flags = m_ppu_oam->read_byte(oam_entry_addr + 3);
+        uint8_t y = oam_entry[0];
+        uint8_t x = oam_entry[1];
+        uint8_t tile_num = oam_entry[2];
+        uint8_t flags = oam_entry[3];
 
         // Check if sprite is visible at all
         if (y == 0 || y >= 160 || x == 0 || x >= 168) continue;
@@ -271,15 +308,11 @@ void gb_ppu::_draw_sprites(uint8_t ly) {
         int sx = sprite.x - 8;
         int sy = sprite.y - 16;
 
-        // Get the pointer to the Sprite tile data
-        // Then calculate the offset to the 2 bytes for the current scanline (depending on flip_y)
+        // Get the decoded tile row for the current scanline (depending on flip_y), 8x16 sprites span two consecutive tiles
+        // The tile cache has X flipped copies of every tile so flip_x is just a matter of picking the right copy
         uint8_t y = static_cast<uint8_t>(ly - sy);
-        uint16_t sprite_addr = sprite_tile_data_addr + (sprite.tile_num * 16);
-        uint8_t line_offset = (sprite.flip_y ? (sprite_size - 1) - y : y) * 2;
-
-        // Read the pixel data for the line
-        uint8_t sprite_line_lo = this->read_byte(sprite_addr + line_offset);
-        uint8_t sprite_line_hi = this->read_byte(sprite_addr + (line_offset + 1));
+        uint8_t line = sprite.flip_y ? static_cast<uint8_t>((sprite_size - 1) - y) : y;
+        const uint8_t* sprite_row = _get_tile_row(static_cast<unsigned int>(sprite.tile_num + (line >> 3)), line & 0x7, sprite.flip_x);
 
         // Which palette is this sprite using?
         uint8_t obj_palette = sprite.use_obp1 ? obp1 : obp0;
@@ -288,52 +321,130 @@ void gb_ppu::_draw_sprites(uint8_t ly) {
             // Check if lx is out of bounds
             if (lx < 0 || lx >= 160) continue;
 
-            // Get colour index from the tile line; works the same way as the background tile data
-            uint8_t x = static_cast<uint8_t>(lx - sx);
-            x = sprite.flip_x ? x : 7 - x;
-            uint8_t colour_idx = static_cast<uint8_t>(((sprite_line_lo >> x) & 0x1) | (((sprite_line_hi >> x) & 0x1) << 1));
-
             // For sprites, a colour index of 0 in the tile data means transparent. Don't even draw it.
+            uint8_t colour_idx = sprite_row[lx - sx];
             if (colour_idx == 0) continue;
 
-            // Get the colour from the object palette
-            //gb_colour_t colour = static_cast<gb_colour_t>((obj_palette >> (colour_idx * 2)) & 0x3);
-
             // If BG priority is enabled then don't draw the pixel if the current background pixel colour is not colour 0
             // The background has priority for all other colours except colour 0 in which case the sprite pixel can be drawn
-            if (sprite.bg_priority && m_linebuffer.at(static_cast<size_t>(lx)).pixel_type == GB_PPU_BG_PIXEL && m_linebuffer.at(static_cast<size_t>(lx)).colour_idx != 0) continue;
+            size_t idx = static_cast<size_t>(lx);
+            if (sprite.bg_priority && m_line_sprite[idx] == 0 && m_line_bg[idx] != 0) continue;
 
-            // Push the pixel into the linebuffer
-            m_linebuffer.at(static_cast<size_t>(lx)) = {GB_PPU_SPRITE_PIXEL, colour_idx, obj_palette};
+            // Get the colour from the object palette
+            m_line_shade[idx] = static_cast<uint8_t>((obj_palette >> (colour_idx * 2)) & 0x3);
+            m_line_sprite[idx] = 1;
         }
     }
 }
 
-bool gb_ppu::update(int cycles) {
-    bool interrupt = false;
-    uint8_t ly = m_memory_map.read_byte(GB_LCD_LY_ADDR);
+gb_ppu::gb_ppu_registers_t gb_ppu::_get_registers() {
+    gb_ppu_registers_t regs;
+    regs.lcdc = m_memory_map.read_byte(GB_LCDC_ADDR);
+    regs.scy = m_ppu_bg_scroll->read_byte(GB_PPU_BG_SCROLL_Y_ADDR);
+    regs.scx = m_ppu_bg_scroll->read_byte(GB_PPU_BG_SCROLL_X_ADDR);
+    regs.bgp = m_ppu_palette->read_byte(GB_PPU_BGP_ADDR);
+    regs.obp0 = m_ppu_palette->read_byte(GB_PPU_OBP0_ADDR);
+    regs.obp1 = m_ppu_palette->read_byte(GB_PPU_OBP1_ADDR);
+    regs.wy = m_ppu_win_scroll->read_byte(GB_PPU_WIN_SCROLL_Y_ADDR);
+    regs.wx = m_ppu_win_scroll->read_byte(GB_PPU_WIN_SCROLL_X_ADDR);
+    return regs;
+}
 
-    // Assert the V-blank interrupt if ly == 144
-    if (ly == 144 && m_next_line == ly) interrupt = true;
+void gb_ppu::_draw_lines(int first_line, int last_line) {
+    // None of the registers can change in between these lines otherwise the PPU would have been asked to catch up
+    // So read them, and get pointers to VRAM and OAM, once for the whole batch
+    gb_ppu_registers_t regs = _get_registers();
 
-    // Draw the next scan line of the background; 160 pixels per scanline
-    // Draw the window & finally draw the sprites
-    if (m_next_line == ly && ly < 144) {
-        _draw_background(ly);
-        _draw_window(ly);
-        _draw_sprites(ly);
+    const uint8_t* vram = get_mem();
+    const uint8_t* oam = m_ppu_oam->get_mem();
+
+    for (int line = first_line; line <= last_line; line++) {
+        uint8_t ly = static_cast<uint8_t>(line);
+
+        // Draw the next scan line of the background; 160 pixels per scanline
+        // Then draw the window on top, both use the background palette
+        _draw_background(regs, vram, ly);
+        _draw_window(regs, vram, ly);
+
+        m_apply_palette(m_line_bg.data(), regs.bgp, m_line_shade.data(), m_line_shade.size());
+
+        // Finally draw the sprites. The background colour indices are kept around to determine background priority
+        m_line_sprite.fill(0);
+        _draw_sprites(regs, oam, ly);
 
         // Draw linebuffer to framebuffer
-        for (const gb_ppu_pixel_t& p : m_linebuffer) {
-            uint8_t lx = static_cast<uint8_t>(&p - &m_linebuffer[0]);
-            gb_colour_t colour = static_cast<gb_colour_t>((p.palette >> (p.colour_idx *2)) & 0x3);
-            m_framebuffer.set_pixel(lx, ly, colour);
-        }
+        m_framebuffer.set_line(ly, m_line_shade.data());
+    }
+}
+
+void gb_ppu::_catch_up() {
+    // A scanline is rendered with the state at the time LY reached it so draw everything up to the current LY
+    int last_line = std::min(m_last_ly, 143);
+    if (m_next_line > last_line) return;
+
+    if (m_render) _draw_lines(m_next_line, last_line);
+    m_next_line = last_line + 1;
+}
+
+void gb_ppu::flush() {
+    _catch_up();
+}
+
+void gb_ppu::write_byte(uint16_t addr, uint8_t val) {
+    _catch_up();
+
+    // Invalidate the decoded copy of any tile that is written to
+    if (addr < GB_PPU_TILE_DATA_END_ADDR) m_tile_dirty.set((addr - GB_VIDEO_RAM_ADDR) >> 4);
+
+    gb_memory_mapped_device::write_byte(addr, val);
+}
+
+bool gb_ppu::update(int cycles) {
+    // This is called after every instruction so keep the common case (LY hasn't changed) cheap
+    int ly = static_cast<int>(m_lcd_ly->read_byte(GB_LCD_LY_ADDR));
+    if (ly == m_last_ly) return false;
+
+    bool interrupt = false;
+
+    if (ly < m_last_ly) {
+        // Either a new frame has started or the LCD was turned off. Finish off any pending lines from the previous frame.
+        // If the LCD was turned off nothing is drawn until it's turned back on, otherwise start from line 0
+        _catch_up();
+        m_next_line = (m_last_ly == 153) ? 0 : ly + 1;
+    } else if (ly == 144 && m_last_ly == 143) {
+        // Reached the end of the frame, render the rest of the lines and assert the V-blank interrupt
+        _catch_up();
+        interrupt = true;
     }
 
-    // Update next scan line
-    m_next_line = ly + 1;
-    m_next_line = (m_next_line > 153) ? 0 : m_next_line;
+    m_last_ly = ly;
 
     return interrupt;
 }
+
+void gb_ppu::save_state(gb_state_writer& state) const {
+    state.write(m_next_line);
+    state.write(m_last_ly);
+    state.write_bytes(m_framebuffer.get_pixels(), GB_WIDTH * GB_HEIGHT);
+}
+
+void gb_ppu::invalidate_tiles() {
+    m_tile_dirty.set();
+}
+
+void gb_ppu::set_render(bool enabled) {
+    m_render = enabled;
+}
+
+void gb_ppu::load_state(gb_state_reader& state) {
+    state.read(m_next_line);
+    state.read(m_last_ly);
+
+    std::array<uint8_t, GB_WIDTH> line;
+    for (unsigned int y = 0; y < GB_HEIGHT; y++) {
+        state.read_bytes(line.data(), line.size());
+        m_framebuffer.set_line(y, line.data());
+    }
+
+    m_tile_dirty.set();
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <array>
+#include <algorithm>
+
+#include "gb_ppu_simd.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GB_PPU_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// Lookup tables that spread the 8 bits of a bitplane byte into bit 0 of 8 bytes (i.e. a software bit-deposit)
+// The first table keeps the pixel order of the tile (bit 7 is the left most pixel), the second is flipped in X
+// The bytes are kept in pixel order rather than packed into an integer so the result doesn't depend on endianness
+using gb_ppu_spread_lut_t = std::array<std::array<uint8_t, 8>, 256>;
+
+static gb_ppu_spread_lut_t _make_spread_lut(bool flip_x) {
+    gb_ppu_spread_lut_t lut;
+
+    for (unsigned int val = 0; val < 256; val++) {
+        for (unsigned int x = 0; x < 8; x++) {
+            unsigned int bit = flip_x ? x : 7 - x;
+            lut[val][x] = static_cast<uint8_t>((val >> bit) & 0x1);
+        }
+    }
+
+    return lut;
+}
+
+static const gb_ppu_spread_lut_t spread_lut = _make_spread_lut(false);
+static const gb_ppu_spread_lut_t spread_flipped_lut = _make_spread_lut(true);
+
+static void _apply_palette_scalar(const uint8_t* colour_indices, uint8_t palette, uint8_t* shades, size_t size) {
+    const uint8_t lut[4] = {
+        static_cast<uint8_t>(palette & 0x3), static_cast<uint8_t>((palette >> 2) & 0x3),
+        static_cast<uint8_t>((palette >> 4) & 0x3), static_cast<uint8_t>((palette >> 6) & 0x3)
+    };
+
+    for (size_t i = 0; i < size; i++) {
+        shades[i] = lut[colour_indices[i] & 0x3];
+    }
+}
+
+#ifdef GB_PPU_SIMD_X86
+// SSE2 doesn't have a byte shuffle so build the shades by comparing against each of the four colour indices
+__attribute__((target("sse2")))
+static void _apply_palette_sse2(const uint8_t* colour_indices, uint8_t palette, uint8_t* shades, size_t size) {
+    __m128i shade[4];
+    for (int c = 0; c < 4; c++) {
+        shade[c] = _mm_set1_epi8(static_cast<char>((palette >> (c * 2)) & 0x3));
+    }
+
+    size_t i = 0;
+    for (; (i + 16) <= size; i += 16) {
+        __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colour_indices + i));
+        __m128i out = _mm_and_si128(_mm_cmpeq_epi8(idx, _mm_setzero_si128()), shade[0]);
+        out = _mm_or_si128(out, _mm_and_si128(_mm_cmpeq_epi8(idx, _mm_set1_epi8(1)), shade[1]));
+        out = _mm_or_si128(out, _mm_and_si128(_mm_cmpeq_epi8(idx, _mm_set1_epi8(2)), shade[2]));
+        out = _mm_or_si128(out, _mm_and_si128(_mm_cmpeq_epi8(idx, _mm_set1_epi8(3)), shade[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(shades + i), out);
+    }
+
+    _apply_palette_scalar(colour_indices + i, palette, shades + i, size - i);
+}
+
+// The palette is only four entries so it fits in a single byte shuffle lookup table
+__attribute__((target("ssse3")))
+static void _apply_palette_ssse3(const uint8_t* colour_indices, uint8_t palette, uint8_t* shades, size_t size) {
+    __m128i lut = _mm_setr_epi8(static_cast<char>(palette & 0x3), static_cast<char>((palette >> 2) & 0x3),
+                                static_cast<char>((palette >> 4) & 0x3), static_cast<char>((palette >> 6) & 0x3),
+                                0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    size_t i = 0;
+    for (; (i + 16) <= size; i += 16) {
+        __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colour_indices + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(shades + i), _mm_shuffle_epi8(lut, idx));
+    }
+
+    _apply_palette_scalar(colour_indices + i, palette, shades + i, size - i);
+}
+
+// Same as SSSE3 but 32 pixels at a time; the shuffle works within each 128-bit lane so the LUT is copied into both lanes
+__attribute__((target("avx2")))
+static void _apply_palette_avx2(const uint8_t* colour_indices, uint8_t palette, uint8_t* shades, size_t size) {
+    __m128i lut128 = _mm_setr_epi8(static_cast<char>(palette & 0x3), static_cast<char>((palette >> 2) & 0x3),
+                                   static_cast<char>((palette >> 4) & 0x3), static_cast<char>((palette >> 6) & 0x3),
+                                   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i lut = _mm256_broadcastsi128_si256(lut128);
+
+    size_t i = 0;
+    for (; (i + 32) <= size; i += 32) {
+        __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(colour_indices + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(shades + i), _mm256_shuffle_epi8(lut, idx));
+    }
+
+    _apply_palette_scalar(colour_indices + i, palette, shades + i, size - i);
+}
+#endif
+
+gb_ppu_simd::gb_simd_level_t gb_ppu_simd::get_simd_level() {
+#ifdef GB_PPU_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return GB_SIMD_AVX2;
+    if (__builtin_cpu_supports("ssse3")) return GB_SIMD_SSSE3;
+    if (__builtin_cpu_supports("sse2")) return GB_SIMD_SSE2;
+#endif
+    return GB_SIMD_SCALAR;
+}
+
+gb_ppu_simd::apply_palette_fn gb_ppu_simd::get_apply_palette(gb_simd_level_t simd_level) {
+    simd_level = std::min(simd_level, get_simd_level());
+
+    switch (simd_level) {
+#ifdef GB_PPU_SIMD_X86
+        case GB_SIMD_AVX2:  return _apply_palette_avx2;
+        case GB_SIMD_SSSE3: return _apply_palette_ssse3;
+        case GB_SIMD_SSE2:  return _apply_palette_sse2;
+#endif
+        default:            return _apply_palette_scalar;
+    }
+}
+
+gb_ppu_simd::apply_palette_fn gb_ppu_simd::get_apply_palette() {
+    return get_apply_palette(get_simd_level());
+}
+
+void gb_ppu_simd::expand_tile_row(uint8_t tile_line_lo, uint8_t tile_line_hi, uint8_t* colour_indices, uint8_t* colour_indices_flipped) {
+    const std::array<uint8_t, 8>& lo = spread_lut[tile_line_lo];
+    const std::array<uint8_t, 8>& hi = spread_lut[tile_line_hi];
+    const std::array<uint8_t, 8>& lo_flipped = spread_flipped_lut[tile_line_lo];
+    const std::array<uint8_t, 8>& hi_flipped = spread_flipped_lut[tile_line_hi];
+
+    // The low bitplane is bit 0 of the colour index and the high bitplane is bit 1
+    for (unsigned int x = 0; x < 8; x++) {
+        colour_indices[x] = static_cast<uint8_t>(lo[x] | (hi[x] << 1));
+        colour_indices_flipped[x] = static_cast<uint8_t>(lo_flipped[x] | (hi_flipped[x] << 1));
+    }
+}
@@ -51,3 +51,11 @@ void gb_ram::set_current_bank(unsigned long bank) {
     // Wrap the bank number so it's within the actual supported number of banks for the RAM
     m_cur_bank = bank % m_num_banks;
 }
+
+void gb_ram::save_state(gb_state_writer& state) const {
+    state.write<uint64_t>(m_cur_bank);
+}
+
+void gb_ram::load_state(gb_state_reader& state) {
+    set_current_bank(static_cast<unsigned long>(state.read<uint64_t>()));
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+#include "gb_rewind.h"
+
+static void _write_varint(std::vector<uint8_t>& out, size_t val) {
+    while (val >= 0x80) {
+        out.push_back(static_cast<uint8_t>(val | 0x80));
+        val >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(val));
+}
+
+static size_t _read_varint(const uint8_t* src, size_t src_size, size_t& pos) {
+    size_t val = 0;
+    for (unsigned int shift = 0; pos < src_size; shift += 7) {
+        uint8_t byte = src[pos++];
+        val |= static_cast<size_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return val;
+    }
+
+    throw std::runtime_error("gb_rewind::_decode() - Corrupt snapshot");
+}
+
+gb_rewind::gb_rewind(size_t capacity, unsigned int keyframe_interval)
+    : m_ring(capacity, 0), m_entries(), m_keyframe_interval(std::max(keyframe_interval, 1u)), m_since_keyframe(0), m_size(0), m_keyframe(), m_scratch()
+{
+}
+
+void gb_rewind::push(const std::vector<uint8_t>& state) {
+    // Start a new keyframe periodically, or if the last one has been dropped or popped
+    bool keyframe = (m_since_keyframe == 0) || (m_keyframe.size() != state.size());
+
+    if (!keyframe) {
+        _encode(state.data(), m_keyframe.data(), state.size(), m_scratch);
+
+        // Making room for the delta may have dropped the keyframe it refers to, in which case this becomes a keyframe
+        keyframe = !_store(m_scratch, state.size(), false);
+    }
+
+    if (keyframe) {
+        _encode(state.data(), nullptr, state.size(), m_scratch);
+        if (!_store(m_scratch, state.size(), true)) return;
+        m_keyframe = state;
+        m_since_keyframe = 0;
+    }
+
+    m_since_keyframe = (m_since_keyframe + 1) % m_keyframe_interval;
+}
+
+bool gb_rewind::pop(std::vector<uint8_t>& state) {
+    if (m_entries.empty()) return false;
+
+    const gb_rewind_entry_t& entry = m_entries.back();
+    state.assign(entry.state_size, 0);
+
+    if (!entry.keyframe) {
+        // The ring never holds deltas without their keyframe
+        auto keyframe = std::find_if(m_entries.rbegin(), m_entries.rend(), [](const gb_rewind_entry_t& e) { return e.keyframe; });
+        if (keyframe == m_entries.rend()) throw std::logic_error("gb_rewind::pop() - Delta without a keyframe");
+        _decode(m_ring.data() + keyframe->offset, keyframe->size, state.data(), state.size());
+    }
+
+    _decode(m_ring.data() + entry.offset, entry.size, state.data(), state.size());
+
+    // Deltas can't be encoded against a keyframe that's no longer in the ring
+    if (entry.keyframe) {
+        m_keyframe.clear();
+        m_since_keyframe = 0;
+    }
+
+    m_size -= entry.size;
+    m_entries.pop_back();
+
+    return true;
+}
+
+void gb_rewind::clear() {
+    m_entries.clear();
+    m_keyframe.clear();
+    m_since_keyframe = 0;
+    m_size = 0;
+}
+
+size_t gb_rewind::get_count() const {
+    return m_entries.size();
+}
+
+size_t gb_rewind::get_size() const {
+    return m_size;
+}
+
+size_t gb_rewind::get_capacity() const {
+    return m_ring.size();
+}
+
+void gb_rewind::_encode(const uint8_t* src, const uint8_t* ref, size_t size, std::vector<uint8_t>& out) {
+    auto changed = [src, ref](size_t pos) -> uint8_t {
+        return (ref != nullptr) ? (src[pos] ^ ref[pos]) : src[pos];
+    };
+
+    out.clear();
+
+    for (size_t pos = 0; pos < size; ) {
+        // Skip over unchanged bytes, 8 at a time where possible
+        size_t start = pos;
+        for (; pos + 8 <= size; pos += 8) {
+            uint64_t a = 0, b = 0;
+            memcpy(&a, src + pos, 8);
+            if (ref != nullptr) memcpy(&b, ref + pos, 8);
+            if (a != b) break;
+        }
+        while (pos < size && changed(pos) == 0) pos++;
+        size_t zeros = pos - start;
+
+        // Changed bytes up to the next pair of unchanged bytes, a single unchanged byte is cheaper to keep in the literal
+        start = pos;
+        while (pos < size && (changed(pos) != 0 || (pos + 1 < size && changed(pos + 1) != 0))) pos++;
+        size_t literals = pos - start;
+
+        _write_varint(out, zeros);
+        _write_varint(out, literals);
+        for (size_t i = start; i < pos; i++) out.push_back(changed(i));
+    }
+}
+
+void gb_rewind::_decode(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_size) {
+    for (size_t in = 0, pos = 0; in < src_size; ) {
+        size_t zeros = _read_varint(src, src_size, in);
+        size_t literals = _read_varint(src, src_size, in);
+        pos += zeros;
+
+        if (pos + literals > dst_size || in + literals > src_size) {
+            throw std::runtime_error("gb_rewind::_decode() - Corrupt snapshot");
+        }
+
+        for (size_t i = 0; i < literals; i++) dst[pos + i] ^= src[in + i];
+        pos += literals;
+        in += literals;
+    }
+}
+
+bool gb_rewind::_store(const std::vector<uint8_t>& encoded, size_t state_size, bool keyframe) {
+    if (encoded.size() > m_ring.size()) return false;
+
+    // Place the snapshot right after the newest one, wrapping around to the start of the ring if it doesn't fit at the end
+    size_t head = m_entries.empty() ? 0 : m_entries.back().offset + m_entries.back().size;
+    if (head + encoded.size() > m_ring.size()) {
+        // Anything left between the head and the end of the ring is older than everything at the start
+        while (!m_entries.empty() && m_entries.front().offset >= head) _drop_oldest();
+        head = 0;
+    }
+
+    // Then drop the oldest snapshots until there's room
+    while (!m_entries.empty() && m_entries.front().offset < head + encoded.size() && head < m_entries.front().offset + m_entries.front().size) {
+        _drop_oldest();
+    }
+
+    // The oldest snapshot is always a keyframe and the newest keyframe is only dropped along with everything after it
+    // so if the ring is now empty the keyframe this delta refers to is gone
+    if (!keyframe && m_entries.empty()) return false;
+
+    memcpy(m_ring.data() + head, encoded.data(), encoded.size());
+    m_entries.push_back({head, encoded.size(), state_size, keyframe});
+    m_size += encoded.size();
+
+    return true;
+}
+
+void gb_rewind::_drop_oldest() {
+    // Dropping a keyframe also drops all of the deltas that depend on it
+    do {
+        m_size -= m_entries.front().size;
+        m_entries.pop_front();
+    } while (!m_entries.empty() && !m_entries.front().keyframe);
+}
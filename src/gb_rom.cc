@@ -11,18 +11,28 @@
 #include "gb_io_defs.h"
 #include "gb_logger.h"
 
-gb_rom::gb_rom(gb_memory_manager& memory_manager, uint16_t start_addr, size_t size, size_t rom_size)
+gb_rom::gb_rom(gb_memory_manager& memory_manager, gb_logger& logger, uint16_t start_addr, size_t size, size_t rom_offset, size_t rom_size)
     :  gb_memory_mapped_device(memory_manager),
-       m_num_banks(rom_size / GB_ROM_BANK_SIZE), m_cur_bank(0)
+       m_logger(logger), m_num_banks(rom_size / GB_ROM_BANK_SIZE), m_cur_bank(0)
 {
     m_start_addr = start_addr;
     m_size = size;
-    m_mm_start_addr = m_memory_manager.allocate(rom_size);
+    m_mm_start_addr = rom_offset;
+
+    if (rom_offset + rom_size > m_memory_manager.get_rom_size()) {
+        std::ostringstream sstr;
+        sstr << "gb_rom::gb_rom() - ROM range " << std::hex << rom_offset << " - " << (rom_offset + rom_size) << " is larger than the ROM: " << m_memory_manager.get_rom_size();
+        throw std::out_of_range(sstr.str());
+    }
 }
 
 gb_rom::~gb_rom() {
 }
 
+uint8_t* gb_rom::get_mem() {
+    return m_memory_manager.get_rom_mem(m_mm_start_addr);
+}
+
 unsigned long gb_rom::translate(uint16_t addr) const {
     if (!in_range(addr) && m_cur_bank >= m_num_banks) {
         std::stringstream sstr;
@@ -33,8 +43,12 @@ unsigned long gb_rom::translate(uint16_t addr) const {
     return ((addr - m_start_addr) + (GB_ROM_BANK_SIZE * m_cur_bank) + m_mm_start_addr);
 }
 
+uint8_t gb_rom::read_byte(uint16_t addr) {
+    return m_memory_manager.read_rom_byte(translate(addr));
+}
+
 void gb_rom::write_byte(uint16_t addr, uint8_t val) {
-    GB_LOGGER(GB_LOG_WARN) << "gb_rom::write_byte - Attempting to write to read-only memory: " << std::hex << addr << " : " << std::hex << static_cast<uint16_t>(val) << std::endl;
+    GB_LOGGER(m_logger, GB_LOG_WARN) << "gb_rom::write_byte - Attempting to write to read-only memory: " << std::hex << addr << " : " << std::hex << static_cast<uint16_t>(val) << std::endl;
 }
 
 unsigned long gb_rom::get_current_bank() const {
@@ -45,3 +59,11 @@ void gb_rom::set_current_bank(unsigned long bank) {
     // Wrap the bank number so it's within the actual supported number of banks for the ROM
     m_cur_bank = bank % m_num_banks;
 }
+
+void gb_rom::save_state(gb_state_writer& state) const {
+    state.write<uint64_t>(m_cur_bank);
+}
+
+void gb_rom::load_state(gb_state_reader& state) {
+    set_current_bank(static_cast<unsigned long>(state.read<uint64_t>()));
+}
@@ -7,9 +7,10 @@
 #include <chrono>
 
 #include "gb_rtc.h"
+#include "gb_io_defs.h"
 
-gb_rtc::gb_rtc(gb_memory_manager& memory_manager, uint16_t start_addr, size_t size)
-    : gb_memory_mapped_device(memory_manager), m_current_register(GB_RTC_SECONDS)
+gb_rtc::gb_rtc(gb_memory_manager& memory_manager, gb_memory_map& memory_map, uint16_t start_addr, size_t size)
+    : gb_memory_mapped_device(memory_manager), m_memory_map(memory_map), m_current_register(GB_RTC_SECONDS), m_base_time(0)
 {
     m_start_addr = start_addr;
     m_size = size;
@@ -17,6 +18,10 @@ gb_rtc::gb_rtc(gb_memory_manager& memory_manager, uint16_t start_addr, size_t si
     // Allocate 5 bytes for the 5 RTC registers
     m_mm_start_addr = m_memory_manager.allocate(5);
 
+    // Only the starting time comes from the host
+    uint64_t now = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch() / std::chrono::seconds(1));
+    m_base_time = now - m_memory_map.get_cycles() / CLOCK_SPEED;
+
     // Update RTC registers
     update();
 }
@@ -43,8 +48,8 @@ void gb_rtc::set_current_register(uint8_t reg) {
 }
 
 void gb_rtc::update() {
-    // Update the RTC registers with the time since epoch
-    unsigned long time = static_cast<unsigned long>(std::chrono::high_resolution_clock::now().time_since_epoch() / std::chrono::seconds(1));
+    // Update the RTC registers with the emulated time since epoch
+    uint64_t time = m_base_time + m_memory_map.get_cycles() / CLOCK_SPEED;
     uint8_t seconds = time % 60;
     uint8_t minutes = (time / 60) % 60;
     uint8_t hours =(time / 3600) % 24;
@@ -56,3 +61,13 @@ void gb_rtc::update() {
     m_memory_manager.write_byte(m_mm_start_addr + GB_RTC_DAY_LO, static_cast<uint8_t>(days & 0xff));
     m_memory_manager.write_byte(m_mm_start_addr + GB_RTC_DAY_HI, static_cast<uint8_t>((days > 8) & 0x1));
 }
+
+void gb_rtc::save_state(gb_state_writer& state) const {
+    state.write(static_cast<uint8_t>(m_current_register));
+    state.write(m_base_time);
+}
+
+void gb_rtc::load_state(gb_state_reader& state) {
+    set_current_register(static_cast<uint8_t>(state.read<uint8_t>() + 0x8));
+    state.read(m_base_time);
+}
@@ -16,10 +16,10 @@
 #define GB_SERIAL_IO_INTERNAL_CLOCK_FREQ  (8192)
 #define GB_SERIAL_IO_CYCLES_TO_IRQ        ((CLOCK_SPEED)/((GB_SERIAL_IO_INTERNAL_CLOCK_FREQ)/8))
 
-gb_serial_io::gb_serial_io(gb_memory_manager& memory_manager)
+gb_serial_io::gb_serial_io(gb_memory_manager& memory_manager, gb_logger& logger)
     : gb_memory_mapped_device(memory_manager, GB_SERIAL_IO_SB_ADDR, 2),
       gb_interrupt_source(GB_SERIAL_IO_JUMP_ADDR, GB_SERIAL_IO_FLAG_BIT),
-      m_irq_counter(0)
+      m_logger(logger), m_str(), m_output(), m_irq_counter(0), m_echo(true), m_capture(true)
 {
 }
 
@@ -39,7 +39,9 @@ void gb_serial_io::write_byte(uint16_t addr, uint8_t val) {
         if ((val & 0x80) && (val & 0x1)) {
             // Append character to the string and set the IRQ down counter
             // = cpu_freq / (serial_io_freq/8) = # of CPU clock cycles to wait before asserting an interrupt (divide by 8 because it needs to shift in/out 8 bits)
-            m_str.push_back(static_cast<char>(gb_memory_mapped_device::read_byte(GB_SERIAL_IO_SB_ADDR)));
+            char c = static_cast<char>(gb_memory_mapped_device::read_byte(GB_SERIAL_IO_SB_ADDR));
+            if (m_capture) m_output.push_back(c);
+            if (m_capture && m_echo) m_str.push_back(c);
             m_irq_counter = GB_SERIAL_IO_CYCLES_TO_IRQ;
         }
     }
@@ -62,8 +64,8 @@ bool gb_serial_io::update(int cycles) {
         gb_memory_mapped_device::write_byte(GB_SERIAL_IO_SB_ADDR, 0xFF);
 
         // If a newline was last appended then print it to the terminal
-        if (m_str.back() == '\n') {
-            GB_LOGGER(GB_LOG_FATAL) << m_str << std::endl;
+        if (!m_str.empty() && m_str.back() == '\n') {
+            GB_LOGGER(m_logger, GB_LOG_FATAL) << m_str << std::endl;
             m_str.clear();
         }
 
@@ -72,3 +74,24 @@ bool gb_serial_io::update(int cycles) {
 
     return false;
 }
+
+const std::string& gb_serial_io::get_output() const {
+    return m_output;
+}
+
+void gb_serial_io::set_echo(bool enabled) {
+    m_echo = enabled;
+    if (!m_echo) m_str.clear();
+}
+
+void gb_serial_io::save_state(gb_state_writer& state) const {
+    state.write(m_irq_counter);
+}
+
+void gb_serial_io::load_state(gb_state_reader& state) {
+    state.read(m_irq_counter);
+}
+
+void gb_serial_io::set_capture(bool enabled) {
+    m_capture = enabled;
+}
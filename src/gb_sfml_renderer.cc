@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "gb_sfml_renderer.h"
+
+#define GB_RENDERER_WHITE      {255, 255, 255, 255}
+#define GB_RENDERER_LIGHT_GREY {192, 192, 192, 255}
+#define GB_RENDERER_DARK_GREY  {96, 96, 96, 255}
+#define GB_RENDERER_BLACK      {0, 0, 0, 255}
+
+// Pack an RGBA colour so that it's laid out R, G, B, A in memory as expected by sf::Texture::update
+static uint32_t _rgba(const std::array<uint8_t, 4>& rgba) {
+    uint32_t pixel;
+    std::memcpy(&pixel, rgba.data(), sizeof(pixel));
+    return pixel;
+}
+
+#define COLOUR_MAP_INIT \
+{{\
+    _rgba(GB_RENDERER_WHITE),\
+    _rgba(GB_RENDERER_LIGHT_GREY),\
+    _rgba(GB_RENDERER_DARK_GREY),\
+    _rgba(GB_RENDERER_BLACK)\
+}}
+
+gb_sfml_renderer::gb_sfml_renderer(unsigned int width, unsigned int height)
+    : gb_renderer(), m_window(sf::VideoMode(std::max(width, static_cast<unsigned int>(GB_WIDTH)), std::max(height, static_cast<unsigned int>(GB_HEIGHT))), "goodboy", sf::Style::Default),
+      m_texture(), m_sprite(), m_colour_map(COLOUR_MAP_INIT), m_rgba_pixels()
+{
+    sf::Vector2f window_size (m_window.getSize());
+
+    // The texture is created once and updated in place every frame
+    m_texture.create(GB_WIDTH, GB_HEIGHT);
+    m_sprite.setTexture(m_texture, true);
+    m_sprite.setScale(window_size.x / static_cast<float>(GB_WIDTH), window_size.y / static_cast<float>(GB_HEIGHT));
+    m_window.setFramerateLimit(60);
+    //m_window.setVerticalSyncEnabled(true);
+    m_window.setKeyRepeatEnabled(false);
+    m_window.display();
+}
+
+gb_sfml_renderer::~gb_sfml_renderer() {
+}
+
+bool gb_sfml_renderer::is_open() {
+    return m_window.isOpen();
+}
+
+void gb_sfml_renderer::close() {
+    m_window.close();
+}
+
+void gb_sfml_renderer::update(bool draw_framebuffer) {
+    sf::Event event;
+
+    while (m_window.pollEvent(event)) {
+        switch (event.type) {
+            case sf::Event::Closed:
+                close();
+                break;
+            case sf::Event::KeyPressed:
+                _set_key_state(event.key.code, true);
+                break;
+            case sf::Event::KeyReleased:
+                _set_key_state(event.key.code, false);
+                break;
+            default: break;
+        }
+    }
+
+    m_window.clear(sf::Color::White);
+
+    if (draw_framebuffer) {
+        const uint8_t* pixels = m_framebuffer.get_pixels();
+        for (size_t i = 0; i < m_rgba_pixels.size(); i++) {
+            m_rgba_pixels[i] = m_colour_map[pixels[i] & 0x3];
+        }
+
+        m_texture.update(reinterpret_cast<const sf::Uint8*>(m_rgba_pixels.data()));
+        m_window.draw(m_sprite);
+    }
+
+    m_window.display();
+}
+
+void gb_sfml_renderer::_set_key_state(sf::Keyboard::Key key, bool pressed) {
+    gb_button_t button;
+
+    if (key == sf::Keyboard::BackSpace) {
+        m_input.set_hotkey(GB_HOTKEY_REWIND, pressed);
+        return;
+    }
+
+    switch (key) {
+        case sf::Keyboard::Down:   button = GB_BUTTON_DOWN;   break;
+        case sf::Keyboard::Up:     button = GB_BUTTON_UP;     break;
+        case sf::Keyboard::Left:   button = GB_BUTTON_LEFT;   break;
+        case sf::Keyboard::Right:  button = GB_BUTTON_RIGHT;  break;
+        case sf::Keyboard::Enter:  button = GB_BUTTON_START;  break;
+        case sf::Keyboard::RShift: button = GB_BUTTON_SELECT; break;
+        case sf::Keyboard::Z:      button = GB_BUTTON_B;      break;
+        case sf::Keyboard::X:      button = GB_BUTTON_A;      break;
+        default: return;
+    }
+
+    if (pressed) {
+        m_input.set_pressed(button);
+    } else {
+        m_input.set_released(button);
+    }
+}
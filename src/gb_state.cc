@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+
+#include "gb_state.h"
+
+gb_state_writer::gb_state_writer(std::vector<uint8_t>& buffer)
+    : m_buffer(&buffer), m_data(nullptr), m_capacity(0), m_size(0)
+{
+}
+
+gb_state_writer::gb_state_writer(uint8_t* data, size_t size)
+    : m_buffer(nullptr), m_data(data), m_capacity(size), m_size(0)
+{
+}
+
+void gb_state_writer::write_bytes(const void* data, size_t size) {
+    if (m_buffer != nullptr) {
+        size_t pos = m_buffer->size();
+        m_buffer->resize(pos + size);
+        memcpy(m_buffer->data() + pos, data, size);
+    } else if (m_data != nullptr) {
+        if (size > m_capacity - m_size) {
+            std::ostringstream sstr;
+            sstr << "gb_state_writer::write_bytes() - Buffer is too small, needed " << size << " bytes at offset " << m_size << " of " << m_capacity;
+            throw std::runtime_error(sstr.str());
+        }
+
+        memcpy(m_data + m_size, data, size);
+    }
+
+    m_size += size;
+}
+
+size_t gb_state_writer::get_size() const {
+    return m_size;
+}
+
+gb_state_reader::gb_state_reader(const uint8_t* data, size_t size)
+    : m_data(data), m_size(size), m_pos(0)
+{
+}
+
+void gb_state_reader::read_bytes(void* data, size_t size) {
+    if (size > m_size - m_pos) {
+        std::ostringstream sstr;
+        sstr << "gb_state_reader::read_bytes() - State is truncated, needed " << size << " bytes at offset " << m_pos << " of " << m_size;
+        throw std::runtime_error(sstr.str());
+    }
+
+    memcpy(data, m_data + m_pos, size);
+    m_pos += size;
+}
+
+size_t gb_state_reader::remaining() const {
+    return m_size - m_pos;
+}
@@ -90,3 +90,18 @@ bool gb_timer::update(int cycles) {
 
     return interrupt;
 }
+
+void gb_timer::save_state(gb_state_writer& state) const {
+    state.write(m_div_counter);
+    state.write(m_timer_counter);
+    state.write(m_timer_start);
+    state.write(m_timer_clk_select);
+}
+
+void gb_timer::load_state(gb_state_reader& state) {
+    state.read(m_div_counter);
+    state.read(m_timer_counter);
+    state.read(m_timer_start);
+    state.read(m_timer_clk_select);
+    m_timer_clk_select &= 0x3;
+}
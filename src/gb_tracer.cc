@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <sstream>
+#include <stdexcept>
+#include <cstdio>
+
+#include "gb_tracer.h"
+#include "gb_io_defs.h"
+
+struct gb_trace_event_info_t {
+    const char*      name;
+    gb_trace_track_t track;
+    const char*      arg_name;
+};
+
+static const char* const g_track_names[GB_TRACE_TRACK_COUNT] = {"Frames", "Scanlines", "LCD mode", "CPU", "Interrupts", "DMA", "MBC"};
+
+static const gb_trace_event_info_t g_event_info[GB_TRACE_EVENT_COUNT] = {
+    {"frame",         GB_TRACE_TRACK_FRAME,     "frame"},
+    {"scanline",      GB_TRACE_TRACK_SCANLINE,  "ly"},
+    {"mode 0 hblank", GB_TRACE_TRACK_LCD_MODE,  "ly"},
+    {"mode 1 vblank", GB_TRACE_TRACK_LCD_MODE,  "ly"},
+    {"mode 2 oam",    GB_TRACE_TRACK_LCD_MODE,  "ly"},
+    {"mode 3 vram",   GB_TRACE_TRACK_LCD_MODE,  "ly"},
+    {"halt",          GB_TRACE_TRACK_CPU,       "pc"},
+    {"vblank",        GB_TRACE_TRACK_INTERRUPT, "pc"},
+    {"stat",          GB_TRACE_TRACK_INTERRUPT, "pc"},
+    {"timer",         GB_TRACE_TRACK_INTERRUPT, "pc"},
+    {"serial",        GB_TRACE_TRACK_INTERRUPT, "pc"},
+    {"joypad",        GB_TRACE_TRACK_INTERRUPT, "pc"},
+    {"oam dma",       GB_TRACE_TRACK_DMA,       "source"},
+    {"rom bank",      GB_TRACE_TRACK_MBC,       "bank"},
+    {"ram bank",      GB_TRACE_TRACK_MBC,       "bank"},
+    {"load state",    GB_TRACE_TRACK_CPU,       nullptr}
+};
+
+gb_tracer::gb_tracer(const std::string& filename)
+    : m_file(filename), m_chunk(), m_offset(0), m_last_cycles(0), m_closed(false), m_open(), m_full(), m_free(), m_mutex(), m_cond(),
+      m_stop(false), m_writer()
+{
+    if (!m_file) {
+        std::ostringstream sstr;
+        sstr << "gb_tracer::gb_tracer() - Unable to open file: " << filename;
+        throw std::runtime_error(sstr.str());
+    }
+
+    m_open.fill(-1);
+    m_chunk.reserve(GB_TRACER_CHUNK_SIZE);
+
+    // Name the tracks and keep them in a fixed order in the viewer
+    m_file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << std::endl;
+    m_file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GoodBoy\"}}";
+    for (int track = 0; track < GB_TRACE_TRACK_COUNT; track++) {
+        m_file << "," << std::endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track << ",\"args\":{\"name\":\"" << g_track_names[track] << "\"}}";
+        m_file << "," << std::endl << "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track << ",\"args\":{\"sort_index\":" << track << "}}";
+    }
+
+    m_writer = std::thread(&gb_tracer::_writer, this);
+}
+
+gb_tracer::~gb_tracer() {
+    close(m_last_cycles - m_offset);
+}
+
+void gb_tracer::begin(gb_trace_event_t event, uint64_t cycles, uint32_t arg) {
+    gb_trace_track_t track = g_event_info[event].track;
+    if (m_open[track] != -1) end(track, cycles);
+
+    m_open[track] = event;
+    _record(event, 'B', cycles, arg);
+}
+
+void gb_tracer::end(gb_trace_track_t track, uint64_t cycles) {
+    if (m_open[track] == -1) return;
+
+    _record(static_cast<gb_trace_event_t>(m_open[track]), 'E', cycles, 0);
+    m_open[track] = -1;
+}
+
+void gb_tracer::instant(gb_trace_event_t event, uint64_t cycles, uint32_t arg) {
+    _record(event, 'i', cycles, arg);
+}
+
+void gb_tracer::rebase(uint64_t old_cycles, uint64_t new_cycles) {
+    m_offset += old_cycles - new_cycles;
+    instant(GB_TRACE_LOAD_STATE, new_cycles);
+}
+
+void gb_tracer::close(uint64_t cycles) {
+    if (m_closed) return;
+
+    for (int track = 0; track < GB_TRACE_TRACK_COUNT; track++) end(static_cast<gb_trace_track_t>(track), cycles);
+    _flush();
+
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_one();
+    m_writer.join();
+
+    m_file << std::endl << "]}" << std::endl;
+    m_file.close();
+    m_closed = true;
+}
+
+void gb_tracer::_flush() {
+    if (m_chunk.empty()) return;
+
+    gb_trace_chunk_t chunk;
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_full.push_back(std::move(m_chunk));
+        if (!m_free.empty()) {
+            chunk = std::move(m_free.back());
+            m_free.pop_back();
+        }
+    }
+    m_cond.notify_one();
+
+    // The writer is normally far ahead, a new chunk is only allocated if it hasn't given one back yet
+    m_chunk = std::move(chunk);
+    m_chunk.clear();
+    m_chunk.reserve(GB_TRACER_CHUNK_SIZE);
+}
+
+void gb_tracer::_writer() {
+    std::string json;
+
+    for (;;) {
+        gb_trace_chunk_t chunk;
+        {
+            std::unique_lock<std::mutex> lock (m_mutex);
+            m_cond.wait(lock, [this] { return m_stop || !m_full.empty(); });
+            if (m_full.empty()) break;
+
+            chunk = std::move(m_full.front());
+            m_full.pop_front();
+        }
+
+        _write_chunk(chunk, json);
+        m_file.write(json.data(), static_cast<std::streamsize>(json.size()));
+
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_free.push_back(std::move(chunk));
+    }
+
+    m_file.flush();
+}
+
+void gb_tracer::_write_chunk(const gb_trace_chunk_t& chunk, std::string& json) {
+    char buf[256];
+    json.clear();
+
+    for (const gb_trace_record_t& record : chunk) {
+        const gb_trace_event_info_t& info = g_event_info[record.event];
+
+        // Trace event timestamps are in microseconds, printed with nanosecond precision without going through floating point
+        uint64_t ns = (record.cycles / CLOCK_SPEED) * 1000000000ull + (record.cycles % CLOCK_SPEED) * 1000000000ull / CLOCK_SPEED;
+        unsigned long long us = ns / 1000;
+        unsigned int frac = static_cast<unsigned int>(ns % 1000);
+        int n;
+
+        if (record.phase == 'E') {
+            n = snprintf(buf, sizeof(buf), ",\n{\"ph\":\"E\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%d}", us, frac, info.track);
+        } else if (info.arg_name == nullptr) {
+            n = snprintf(buf, sizeof(buf), ",\n{\"name\":\"%s\",\"ph\":\"%c\",%s\"ts\":%llu.%03u,\"pid\":1,\"tid\":%d}",
+                info.name, record.phase, (record.phase == 'i') ? "\"s\":\"t\"," : "", us, frac, info.track);
+        } else {
+            n = snprintf(buf, sizeof(buf), ",\n{\"name\":\"%s\",\"ph\":\"%c\",%s\"ts\":%llu.%03u,\"pid\":1,\"tid\":%d,\"args\":{\"%s\":%u}}",
+                info.name, record.phase, (record.phase == 'i') ? "\"s\":\"t\"," : "", us, frac, info.track, info.arg_name, record.arg);
+        }
+
+        json.append(buf, static_cast<size_t>(n));
+    }
+}
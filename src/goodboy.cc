@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <exception>
+#include <cstring>
+
+#include "goodboy.h"
+#include "gb_emulator.h"
+#include "gb_null_renderer.h"
+#include "gb_io_defs.h"
+
+static_assert(GB_FRAMEBUFFER_WIDTH == GB_WIDTH && GB_FRAMEBUFFER_HEIGHT == GB_HEIGHT, "goodboy.h framebuffer size mismatch");
+static_assert(GB_BUTTON_MASK_A == (1u << GB_BUTTON_A) && GB_BUTTON_MASK_DOWN == (1u << GB_BUTTON_DOWN), "goodboy.h button mask mismatch");
+static_assert(GB_PERF_COUNTERS_NUM_REGIONS == GB_PERF_REGION_COUNT && GB_PERF_COUNTERS_NUM_INTERRUPTS == GB_PERF_NUM_INTERRUPTS, "goodboy.h performance counters mismatch");
+
+// Base address of each gb_ram_region_t
+static const std::array<uint16_t, 4> ram_region_addr = {{0xC000, 0xFF80, 0x8000, 0xFE00}};
+
+struct gb_handle {
+    gb_null_renderer_ptr renderer;
+    gb_emulator_ptr      emulator;
+    bool                 rom_loaded;
+    std::string          error;
+
+    // Each gb_ram_region_t, looked up once the ROM is loaded
+    std::array<uint8_t*, 4> ram;
+    std::array<size_t, 4>   ram_size;
+
+    gb_handle()
+        : renderer(std::make_shared<gb_null_renderer>()), emulator(std::make_shared<gb_emulator>(renderer)), rom_loaded(false), error(), ram(),
+          ram_size()
+    {
+        // Embedded instances keep the serial output to themselves instead of logging it to stdout
+        emulator->set_serial_echo(false);
+    }
+
+    gb_handle(const gb_handle& other)
+        : renderer(std::make_shared<gb_null_renderer>()), emulator(other.emulator->clone(renderer)), rom_loaded(true), error(), ram(),
+          ram_size()
+    {
+        get_ram_regions();
+    }
+
+    void get_ram_regions() {
+        for (size_t i = 0; i < ram_region_addr.size(); i++) ram[i] = emulator->get_mem(ram_region_addr[i], ram_size[i]);
+    }
+};
+
+gb_handle_t* gb_create(void) {
+    try {
+        return new gb_handle();
+    } catch (const std::exception& e) {
+        return nullptr;
+    }
+}
+
+gb_handle_t* gb_clone(gb_handle_t* gb) {
+    if (gb == nullptr) return nullptr;
+
+    if (!gb->rom_loaded) {
+        gb->error = "gb_clone() - No ROM loaded";
+        return nullptr;
+    }
+
+    try {
+        return new gb_handle(*gb);
+    } catch (const std::exception& e) {
+        gb->error = e.what();
+        return nullptr;
+    }
+}
+
+void gb_destroy(gb_handle_t* gb) {
+    delete gb;
+}
+
+gb_status_t gb_load_rom_from_memory(gb_handle_t* gb, const uint8_t* rom_data, size_t rom_data_size) {
+    if (gb == nullptr) return GB_STATUS_INVALID_ARGUMENT;
+
+    if (gb->rom_loaded) {
+        gb->error = "gb_load_rom_from_memory() - A ROM has already been loaded";
+        return GB_STATUS_INVALID_ARGUMENT;
+    }
+
+    try {
+        gb->emulator->load_rom(rom_data, rom_data_size);
+        gb->emulator->boot(false);
+        gb->get_ram_regions();
+    } catch (const std::exception& e) {
+        gb->error = e.what();
+        return GB_STATUS_ERROR;
+    }
+
+    gb->rom_loaded = true;
+    return GB_STATUS_OK;
+}
+
+gb_status_t gb_run_frames(gb_handle_t* gb, unsigned int num_frames) {
+    if (gb == nullptr) return GB_STATUS_INVALID_ARGUMENT;
+
+    if (!gb->rom_loaded) {
+        gb->error = "gb_run_frames() - No ROM loaded";
+        return GB_STATUS_INVALID_ARGUMENT;
+    }
+
+    try {
+        gb->emulator->run_frames(num_frames);
+    } catch (const std::exception& e) {
+        gb->error = e.what();
+        return GB_STATUS_ERROR;
+    }
+
+    return GB_STATUS_OK;
+}
+
+void gb_set_buttons(gb_handle_t* gb, uint8_t mask) {
+    if (gb == nullptr) return;
+    gb->renderer->get_input().set_buttons(mask);
+}
+
+void gb_invalidate_vram(gb_handle_t* gb) {
+    if (gb != nullptr && gb->rom_loaded) gb->emulator->invalidate_vram();
+}
+
+const uint8_t* gb_get_framebuffer(gb_handle_t* gb) {
+    if (gb == nullptr) return nullptr;
+    return gb->renderer->get_framebuffer().get_pixels();
+}
+
+uint8_t* gb_get_ram(gb_handle_t* gb, gb_ram_region_t region, size_t* size) {
+    if (gb == nullptr || !gb->rom_loaded || static_cast<size_t>(region) >= ram_region_addr.size()) return nullptr;
+
+    if (size != nullptr) *size = gb->ram_size[region];
+    return gb->ram[region];
+}
+
+gb_status_t gb_save_state(gb_handle_t* gb, uint8_t* buf, size_t buf_size, size_t* state_size) {
+    if (gb == nullptr || state_size == nullptr) return GB_STATUS_INVALID_ARGUMENT;
+
+    if (!gb->rom_loaded) {
+        gb->error = "gb_save_state() - No ROM loaded";
+        return GB_STATUS_INVALID_ARGUMENT;
+    }
+
+    // Every state of a cartridge is the same size so it's known without saving
+    *state_size = gb->emulator->get_state_size();
+    if (buf == nullptr) return GB_STATUS_OK;
+
+    if (buf_size < *state_size) {
+        gb->error = "gb_save_state() - Buffer is too small for the state";
+        return GB_STATUS_INVALID_ARGUMENT;
+    }
+
+    try {
+        gb->emulator->save_state(buf, buf_size);
+    } catch (const std::exception& e) {
+        gb->error = e.what();
+        return GB_STATUS_ERROR;
+    }
+
+    return GB_STATUS_OK;
+}
+
+gb_status_t gb_load_state(gb_handle_t* gb, const uint8_t* buf, size_t buf_size) {
+    if (gb == nullptr || buf == nullptr) return GB_STATUS_INVALID_ARGUMENT;
+
+    if (!gb->rom_loaded) {
+        gb->error = "gb_load_state() - No ROM loaded";
+        return GB_STATUS_INVALID_ARGUMENT;
+    }
+
+    try {
+        gb->emulator->load_state(buf, buf_size);
+    } catch (const std::exception& e) {
+        gb->error = e.what();
+        return GB_STATUS_ERROR;
+    }
+
+    return GB_STATUS_OK;
+}
+
+gb_status_t gb_get_perf_counters(gb_handle_t* gb, gb_perf_counters_t* counters) {
+    if (gb == nullptr || counters == nullptr) return GB_STATUS_INVALID_ARGUMENT;
+
+    const gb_perf_counters& perf_counters = gb->emulator->get_perf_counters();
+    counters->instructions = perf_counters.instructions;
+    counters->cycles = perf_counters.cycles;
+    counters->halt_cycles = perf_counters.halt_cycles;
+    std::copy(perf_counters.reads.begin(), perf_counters.reads.end(), counters->reads);
+    std::copy(perf_counters.writes.begin(), perf_counters.writes.end(), counters->writes);
+    counters->rom_bank_switches = perf_counters.rom_bank_switches;
+    counters->ram_bank_switches = perf_counters.ram_bank_switches;
+    std::copy(perf_counters.interrupts.begin(), perf_counters.interrupts.end(), counters->interrupts);
+    counters->dma_bytes = perf_counters.dma_bytes;
+    counters->frames = perf_counters.frames;
+
+    return GB_STATUS_OK;
+}
+
+void gb_reset_perf_counters(gb_handle_t* gb) {
+    if (gb != nullptr) gb->emulator->get_perf_counters().reset();
+}
+
+const char* gb_get_error(gb_handle_t* gb) {
+    if (gb == nullptr) return "";
+    return gb->error.c_str();
+}
@@ -4,39 +4,217 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <iostream>
+
 #include "gb_logger.h"
 #include "gb_emulator_opts.h"
+#include "gb_emulator.h"
+#include "gb_null_renderer.h"
+#include "gb_movie.h"
+
+#ifndef GB_HEADLESS
+#include "gb_sfml_renderer.h"
 #include "gb_debugger.h"
 
+#define GB_RENDERER_WIDTH  (GB_WIDTH*5)
+#define GB_RENDERER_HEIGHT (GB_HEIGHT*5)
+#endif
+
+// Frames between the lines written to the --perf file
+#define GB_PERF_COUNTERS_INTERVAL (60)
+
 int main(int argc, char **argv) {
     gb_emulator_opts options (argc, argv);
 
     if (!options.parse_opts()) return EXIT_FAILURE;
 
-    gb_logger::instance().enable_tracing(options.m_tracing);
-    gb_logger::instance().set_level(GB_LOG_DEBUG);
+    // Replays run headless for exactly as many frames as the movie has
+    gb_movie_ptr replay;
+    if (!options.m_replay_filename.empty()) {
+        replay = std::make_shared<gb_movie>();
+        try {
+            replay->load(options.m_replay_filename);
+        } catch (const std::exception& e) {
+            std::cout << options.m_program_name << ": " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        options.m_max_frames = replay->get_frame_count();
+    }
+
+    gb_renderer_ptr renderer;
 
-    gb_emulator emulator;
+#ifdef GB_HEADLESS
+    renderer = std::make_shared<gb_null_renderer>(options.m_max_frames);
+#else
+    if (options.m_headless) {
+        renderer = std::make_shared<gb_null_renderer>(options.m_max_frames);
+    } else {
+        renderer = std::make_shared<gb_sfml_renderer>(GB_RENDERER_WIDTH, GB_RENDERER_HEIGHT);
+    }
+#endif
+
+    gb_emulator emulator (renderer);
+    gb_logger& logger = emulator.get_logger();
+
+    logger.enable_tracing(options.m_tracing);
+    logger.set_level(GB_LOG_DEBUG);
 
     try {
         emulator.load_rom(options.m_rom_filename);
     } catch (const std::exception& e) {
-        GB_LOGGER(GB_LOG_FATAL) << e.what() << std::endl;
+        GB_LOGGER(logger, GB_LOG_FATAL) << e.what() << std::endl;
         return EXIT_FAILURE;
     }
 
+    emulator.enable_rewind(options.m_rewind_size);
+    emulator.set_run_ahead(options.m_run_ahead_frames);
+
+    gb_guest_profiler_ptr guest_profiler;
+    if (!options.m_guest_profile_name.empty()) {
+        guest_profiler = std::make_shared<gb_guest_profiler>();
+        try {
+            if (!options.m_sym_filename.empty()) guest_profiler->load_symbols(options.m_sym_filename);
+        } catch (const std::exception& e) {
+            GB_LOGGER(logger, GB_LOG_FATAL) << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        emulator.set_guest_profiler(guest_profiler);
+    }
+
+    if (!options.m_perf_counters_filename.empty()) {
+        try {
+            emulator.set_perf_counters_dump(options.m_perf_counters_filename, GB_PERF_COUNTERS_INTERVAL);
+        } catch (const std::exception& e) {
+            GB_LOGGER(logger, GB_LOG_FATAL) << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (options.m_host_profile_interval != 0) {
+        try {
+            emulator.set_host_profile_interval(options.m_host_profile_interval);
+        } catch (const std::exception& e) {
+            GB_LOGGER(logger, GB_LOG_FATAL) << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // A save state replaces the whole machine state so there's no point in running the bootrom first
+    bool booted = (replay != nullptr) || !options.m_load_state_filename.empty();
+    try {
+        if (replay != nullptr) {
+            emulator.play_movie(replay);
+        } else if (booted) {
+            emulator.boot(false);
+            emulator.load_state(options.m_load_state_filename);
+        }
+    } catch (const std::exception& e) {
+        GB_LOGGER(logger, GB_LOG_FATAL) << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    gb_tracer_ptr tracer;
+    if (!options.m_trace_filename.empty()) {
+        try {
+            tracer = std::make_shared<gb_tracer>(options.m_trace_filename);
+        } catch (const std::exception& e) {
+            GB_LOGGER(logger, GB_LOG_FATAL) << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        emulator.set_tracer(tracer);
+    }
+
+    // Movies start from a save state so the bootrom has to be run before recording starts
+    gb_movie_ptr movie;
+    if (!options.m_record_filename.empty()) {
+        if (!booted) emulator.boot();
+        booted = true;
+
+        movie = std::make_shared<gb_movie>();
+        emulator.record_movie(movie);
+    }
+
+#ifndef GB_HEADLESS
     if (options.m_debugger) {
+        // ncurses isn't thread safe and the debugger echoes input through the logger a character at a time
+        // so everything has to be written out on this thread before the debugger takes over std::cout
+        logger.set_async(false);
+
         gb_debugger debugger (emulator);
 
-        // Need to setup stream with gb_logger again since gb_emulator_debugger modifies the
-        // the reference of the underlying streambuf
-        gb_logger::instance().set_stream(std::cout);
-        gb_logger::instance().enable_tracing(true);
+        // The debugger redirects std::cout into an ncurses window
+        logger.set_stream(std::cout);
+        logger.enable_tracing(true);
 
         debugger.go();
+    } else if (booted) {
+        if (replay == nullptr || replay->get_frame_count() != 0) emulator.run();
+    } else {
+        emulator.go();
+    }
+#else
+    if (booted) {
+        if (replay == nullptr || replay->get_frame_count() != 0) emulator.run();
     } else {
         emulator.go();
     }
+#endif
+
+    if (!options.m_perf_counters_filename.empty()) emulator.set_perf_counters_dump("", 0);
+
+    if (tracer != nullptr) {
+        emulator.set_tracer(nullptr);
+        tracer->close(emulator.get_cycle_count());
+    }
+
+    if (movie != nullptr) {
+        try {
+            emulator.record_movie(nullptr);
+            movie->save(options.m_record_filename);
+        } catch (const std::exception& e) {
+            GB_LOGGER(logger, GB_LOG_FATAL) << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (replay != nullptr) {
+        std::vector<uint8_t> state;
+        emulator.save_state(state);
+        GB_LOGGER(logger, GB_LOG_INFO) << "Replayed " << std::dec << replay->get_frame_count() << " frames, final state hash: 0x" << std::hex << gb_movie::hash(state.data(), state.size()) << std::endl;
+    }
+
+    if (options.m_run_ahead_frames != 0) {
+        GB_LOGGER(logger, GB_LOG_INFO) << "Run-ahead of " << options.m_run_ahead_frames << " frames cost " << emulator.get_run_ahead_cost() << "us per frame" << std::endl;
+    }
+
+    if (!options.m_save_state_filename.empty()) {
+        try {
+            emulator.save_state(options.m_save_state_filename);
+        } catch (const std::exception& e) {
+            GB_LOGGER(logger, GB_LOG_FATAL) << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!options.m_memory_profile_filename.empty()) {
+        try {
+            emulator.save_memory_profile(options.m_memory_profile_filename);
+        } catch (const std::exception& e) {
+            GB_LOGGER(logger, GB_LOG_FATAL) << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (guest_profiler != nullptr) {
+        try {
+            guest_profiler->export_to_file(options.m_guest_profile_name + ".txt");
+            guest_profiler->export_to_file(options.m_guest_profile_name + ".folded");
+            guest_profiler->export_to_file(options.m_guest_profile_name + ".csv");
+        } catch (const std::exception& e) {
+            GB_LOGGER(logger, GB_LOG_FATAL) << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <vector>
+
+#include "gb_microbench_fixture.h"
+#include "gb_io_defs.h"
+
+#define GB_PPU_LCD_TEST_LINE_CYCLES (456)
+
+static std::vector<uint8_t> _get_line(gb_microbench_fixture& fixture, unsigned int y) {
+    const uint8_t* pixels = fixture.get_framebuffer().get_pixels() + (y * GB_WIDTH);
+    return std::vector<uint8_t>(pixels, pixels + GB_WIDTH);
+}
+
+// Turn the LCD off partway through a frame, scroll the background and turn it back on. The first frame after that
+// must draw line 0 with the new scroll, the same as every frame after it
+static bool _test_reenable() {
+    gb_microbench_fixture fixture;
+    fixture.setup_ppu(1);
+    fixture.run_frames(2);
+    std::vector<uint8_t> before = _get_line(fixture, 0);
+
+    fixture.step(GB_PPU_LCD_TEST_LINE_CYCLES * 40);
+    fixture.write_byte(GB_LCDC_ADDR, 0x77);
+    fixture.step(GB_PPU_LCD_TEST_LINE_CYCLES * 3);
+    fixture.write_byte(GB_PPU_BG_SCROLL_X_ADDR, 50);
+    fixture.write_byte(GB_LCDC_ADDR, 0xF7);
+
+    // Writing the palette makes the PPU catch up on the lines drawn since the LCD came back on
+    fixture.step(GB_PPU_LCD_TEST_LINE_CYCLES * 20);
+    fixture.write_byte(GB_PPU_BGP_ADDR, 0xE4);
+    std::vector<uint8_t> reenabled = _get_line(fixture, 0);
+
+    fixture.run_frames(2);
+    std::vector<uint8_t> after = _get_line(fixture, 0);
+
+    bool passed = (after != before) && (reenabled == after);
+    printf("line 0 after re-enabling the LCD: %s\n", passed ? "ok" : "FAILED");
+    return passed;
+}
+
+int main() {
+    bool passed = true;
+
+    try {
+        passed = _test_reenable() && passed;
+    } catch (const std::exception& e) {
+        printf("%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
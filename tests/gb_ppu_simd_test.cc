@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <vector>
+
+#include "gb_ppu_simd.h"
+#include "gb_microbench_fixture.h"
+#include "gb_io_defs.h"
+
+#define GB_PPU_SIMD_TEST_FRAMES (16)
+#define GB_PPU_SIMD_TEST_SEED   (1)
+
+using namespace gb_ppu_simd;
+
+static const char* const g_simd_level_names[] = {"scalar", "sse2", "ssse3", "avx2"};
+
+// Every palette applied to every colour index, with a length that leaves a tail for each SIMD width
+static bool _check_apply_palette(gb_simd_level_t simd_level) {
+    std::vector<uint8_t> colour_indices (GB_WIDTH + 13);
+    for (size_t i = 0; i < colour_indices.size(); i++) colour_indices[i] = static_cast<uint8_t>((i * 7) & 0x3);
+
+    std::vector<uint8_t> expected (colour_indices.size()), shades (colour_indices.size());
+    apply_palette_fn scalar = get_apply_palette(GB_SIMD_SCALAR);
+    apply_palette_fn simd = get_apply_palette(simd_level);
+
+    for (unsigned int palette = 0; palette < 256; palette++) {
+        scalar(colour_indices.data(), static_cast<uint8_t>(palette), expected.data(), expected.size());
+        simd(colour_indices.data(), static_cast<uint8_t>(palette), shades.data(), shades.size());
+
+        if (shades != expected) {
+            printf("%s: apply_palette differs from scalar for palette 0x%02X\n", g_simd_level_names[simd_level], palette);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Every pair of bitplanes against the colour indices worked out one bit at a time
+static bool _check_expand_tile_row() {
+    for (unsigned int lo = 0; lo < 256; lo++) {
+        for (unsigned int hi = 0; hi < 256; hi++) {
+            uint8_t colour_indices[8], colour_indices_flipped[8];
+            expand_tile_row(static_cast<uint8_t>(lo), static_cast<uint8_t>(hi), colour_indices, colour_indices_flipped);
+
+            for (unsigned int x = 0; x < 8; x++) {
+                unsigned int bit = 7 - x;
+                uint8_t expected = static_cast<uint8_t>(((lo >> bit) & 0x1) | (((hi >> bit) & 0x1) << 1));
+                uint8_t expected_flipped = static_cast<uint8_t>(((lo >> x) & 0x1) | (((hi >> x) & 0x1) << 1));
+
+                if (colour_indices[x] != expected || colour_indices_flipped[x] != expected_flipped) {
+                    printf("expand_tile_row: wrong colour index for lo 0x%02X hi 0x%02X pixel %u\n", lo, hi, x);
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// Hash of every frame drawn by the microbench fixture's random tiles, window and sprites, changing BGP each frame
+static std::vector<uint64_t> _render_frames(gb_simd_level_t simd_level) {
+    gb_microbench_fixture fixture;
+    fixture.set_simd_level(simd_level);
+    fixture.setup_ppu(GB_PPU_SIMD_TEST_SEED);
+
+    std::vector<uint64_t> hashes;
+    for (unsigned int frame = 0; frame < GB_PPU_SIMD_TEST_FRAMES; frame++) {
+        fixture.write_byte(GB_PPU_BGP_ADDR, static_cast<uint8_t>(0xE4 + frame * 0x1D));
+        fixture.run_frames(1);
+        hashes.push_back(fixture.get_framebuffer().get_hash());
+    }
+
+    return hashes;
+}
+
+int main() {
+    bool passed = _check_expand_tile_row();
+
+    try {
+        std::vector<uint64_t> expected = _render_frames(GB_SIMD_SCALAR);
+
+        // Only the levels the host can run, get_apply_palette clamps anything above that to the host's best
+        for (int level = GB_SIMD_SCALAR; level <= get_simd_level(); level++) {
+            gb_simd_level_t simd_level = static_cast<gb_simd_level_t>(level);
+            bool level_passed = _check_apply_palette(simd_level);
+
+            std::vector<uint64_t> hashes = _render_frames(simd_level);
+            for (size_t frame = 0; frame < hashes.size(); frame++) {
+                if (hashes[frame] != expected[frame]) {
+                    printf("%s: frame %zu hash %016llx, scalar %016llx\n", g_simd_level_names[level], frame,
+                           static_cast<unsigned long long>(hashes[frame]), static_cast<unsigned long long>(expected[frame]));
+                    level_passed = false;
+                }
+            }
+
+            printf("%s: %s\n", g_simd_level_names[level], level_passed ? "ok" : "FAILED");
+            passed = passed && level_passed;
+        }
+    } catch (const std::exception& e) {
+        printf("%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
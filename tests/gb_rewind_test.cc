@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <vector>
+
+#include "gb_rewind.h"
+
+#define GB_REWIND_TEST_STATE_SIZE (4096)
+
+// Snapshot i is a fixed pseudo-random block followed by zeros, like a mostly unchanged save state, with a handful of
+// bytes that depend on i so every snapshot is different and its delta is small
+static std::vector<uint8_t> _make_state(unsigned int i) {
+    std::vector<uint8_t> state (GB_REWIND_TEST_STATE_SIZE, 0);
+
+    uint32_t seed = 1;
+    for (size_t pos = 0; pos < 512; pos++) {
+        seed = (seed * 1103515245u) + 12345u;
+        state[pos] = static_cast<uint8_t>(seed >> 16);
+    }
+
+    for (unsigned int k = 0; k < 8; k++) state[((i * 7) + (k * 131)) % state.size()] ^= static_cast<uint8_t>(i + k + 1);
+    state[state.size() - 4] = static_cast<uint8_t>(i);
+    state[state.size() - 3] = static_cast<uint8_t>(i >> 8);
+
+    return state;
+}
+
+// Pop every snapshot in the ring and check they come back newest first as snapshots last, last - 1, ...
+static bool _check_pops(gb_rewind& rewind, const char* name, unsigned int last) {
+    size_t count = rewind.get_count();
+    std::vector<uint8_t> state;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!rewind.pop(state)) {
+            printf("%s: ring empty after %zu of %zu pops\n", name, i, count);
+            return false;
+        }
+
+        if (state != _make_state(last - i)) {
+            printf("%s: snapshot %u doesn't match\n", name, static_cast<unsigned int>(last - i));
+            return false;
+        }
+    }
+
+    if (rewind.get_count() != 0 || rewind.get_size() != 0 || rewind.pop(state)) {
+        printf("%s: ring not empty after popping every snapshot\n", name);
+        return false;
+    }
+
+    return true;
+}
+
+static bool _test_empty() {
+    gb_rewind rewind (1 << 20);
+    std::vector<uint8_t> state = {1, 2, 3};
+
+    bool passed = !rewind.pop(state) && (state.size() == 3);
+
+    // And again once the only snapshot has been popped
+    rewind.push(_make_state(0));
+    passed = rewind.pop(state) && (state == _make_state(0)) && passed;
+    passed = !rewind.pop(state) && passed;
+
+    printf("empty: %s\n", passed ? "ok" : "FAILED");
+    return passed;
+}
+
+static bool _test_keyframes() {
+    const char* name = "keyframe boundary";
+    gb_rewind rewind (1 << 20);
+
+    // Three keyframes, at snapshots 0, 120 and 240, and nothing dropped
+    for (unsigned int i = 0; i < 300; i++) rewind.push(_make_state(i));
+    if (rewind.get_count() != 300) {
+        printf("%s: %zu snapshots instead of 300\n", name, rewind.get_count());
+        return false;
+    }
+
+    // Pop back past the last keyframe, then push again so the new snapshots can't be deltas against the popped keyframe
+    std::vector<uint8_t> state;
+    for (unsigned int i = 299; i >= 230; i--) {
+        if (!rewind.pop(state) || state != _make_state(i)) {
+            printf("%s: snapshot %u doesn't match\n", name, i);
+            return false;
+        }
+    }
+
+    for (unsigned int i = 230; i < 260; i++) rewind.push(_make_state(i));
+
+    bool passed = _check_pops(rewind, name, 259);
+    if (passed) printf("%s: ok\n", name);
+    return passed;
+}
+
+static bool _test_wraparound() {
+    const char* name = "wraparound";
+
+    // Room for a couple of keyframes and their deltas, so the ring wraps around and drops snapshots many times over
+    gb_rewind rewind (8192);
+
+    unsigned int evictions = 0;
+    for (unsigned int i = 0; i < 1000; i++) {
+        size_t count = rewind.get_count();
+        rewind.push(_make_state(i));
+
+        if (rewind.get_count() <= count) evictions++;
+        if (rewind.get_size() > rewind.get_capacity()) {
+            printf("%s: %zu bytes in a %zu byte ring\n", name, rewind.get_size(), rewind.get_capacity());
+            return false;
+        }
+    }
+
+    if (evictions < 3 || rewind.get_count() == 0) {
+        printf("%s: ring didn't wrap around, %zu snapshots kept\n", name, rewind.get_count());
+        return false;
+    }
+
+    // Whatever was evicted, what's left is the newest snapshots with no gaps
+    bool passed = _check_pops(rewind, name, 999);
+    if (passed) printf("%s: ok\n", name);
+    return passed;
+}
+
+int main() {
+    bool passed = true;
+
+    try {
+        passed = _test_empty() && passed;
+        passed = _test_keyframes() && passed;
+        passed = _test_wraparound() && passed;
+    } catch (const std::exception& e) {
+        printf("%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
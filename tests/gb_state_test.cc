@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gb_microbench_fixture.h"
+
+// The CPU loop from the perf gate's workloads, so the registers and work RAM change every frame
+static const std::vector<uint8_t> g_state_test_body = {
+    0x41, 0x4A, 0x80, 0x91, 0xA2, 0xB3, 0x06, 0x12, 0x7E, 0x77, 0x04, 0x0D, 0x03, 0xC5, 0xD1, 0xE0, 0x80, 0xF0, 0x81
+};
+
+static std::vector<uint8_t> _save(gb_microbench_fixture& fixture) {
+    std::vector<uint8_t> state;
+    fixture.save_state(state);
+    return state;
+}
+
+// The header starts with the magic and version followed by the size of the whole state
+#define GB_STATE_TEST_SIZE_OFFSET (8)
+
+static void _set_size(std::vector<uint8_t>& state) {
+    uint64_t size = state.size();
+    memcpy(state.data() + GB_STATE_TEST_SIZE_OFFSET, &size, sizeof(size));
+}
+
+// Loading the state must throw and leave the machine exactly as it was. Every check starts from the same machine
+// so one that wrongly loads doesn't hide the next one
+static bool _check_rejected(gb_microbench_fixture& fixture, const char* name, const std::vector<uint8_t>& before,
+                            const std::vector<uint8_t>& state) {
+    fixture.load_state(before.data(), before.size());
+
+    try {
+        fixture.load_state(state.data(), state.size());
+        printf("%s: loaded\n", name);
+        return false;
+    } catch (const std::runtime_error& e) {
+        if (_save(fixture) != before) {
+            printf("%s: machine changed after '%s'\n", name, e.what());
+            return false;
+        }
+    }
+
+    printf("%s: ok\n", name);
+    return true;
+}
+
+int main() {
+    bool passed = true;
+
+    try {
+        gb_microbench_fixture fixture (g_state_test_body);
+        fixture.setup_ppu(1);
+        fixture.run_frames(3);
+        std::vector<uint8_t> state = _save(fixture);
+
+        // Move the machine on so loading any part of the saved state would show up, the loop can come back round to
+        // the same registers after whole frames so stop partway through one
+        fixture.run_frames(5);
+        for (int i = 0; i < 7; i++) fixture.step_cpu();
+        std::vector<uint8_t> current = _save(fixture);
+
+        std::vector<uint8_t> truncated (state.begin(), state.end() - 100);
+        passed = _check_rejected(fixture, "truncated", current, truncated) && passed;
+
+        _set_size(truncated);
+        passed = _check_rejected(fixture, "truncated with matching header", current, truncated) && passed;
+
+        std::vector<uint8_t> padded = state;
+        padded.resize(state.size() + 0x2000);
+        _set_size(padded);
+        passed = _check_rejected(fixture, "wrong size", current, padded) && passed;
+
+        // The arena's size follows the header and the CPU, it's the first 64-bit value after the state's size that matches
+        std::vector<uint8_t> arena = state;
+        uint64_t arena_size = fixture.get_memory_size();
+        for (size_t i = GB_STATE_TEST_SIZE_OFFSET + sizeof(uint64_t); i + sizeof(arena_size) <= arena.size(); i++) {
+            if (memcmp(arena.data() + i, &arena_size, sizeof(arena_size)) == 0) {
+                uint64_t wrong_size = arena_size + 0x2000;
+                memcpy(arena.data() + i, &wrong_size, sizeof(wrong_size));
+                break;
+            }
+        }
+        passed = _check_rejected(fixture, "wrong memory size", current, arena) && passed;
+
+        // And the untouched state still loads
+        fixture.load_state(state.data(), state.size());
+        bool loaded = (_save(fixture) == state);
+        printf("valid state: %s\n", loaded ? "ok" : "FAILED");
+        passed = passed && loaded;
+    } catch (const std::exception& e) {
+        printf("%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
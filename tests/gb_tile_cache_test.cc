@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+#include "gb_microbench_fixture.h"
+#include "gb_io_defs.h"
+
+// INC B; LD A,B; LD (HL+),A; LD A,H; AND 0x07; OR 0x80; LD H,A. Keeps writing tile data from 0x8000 to 0x87FF
+static const std::vector<uint8_t> g_tile_cache_test_vram_body = {0x04, 0x78, 0x22, 0x7C, 0xE6, 0x07, 0xF6, 0x80, 0x67};
+
+#define GB_TILE_CACHE_TEST_FRAME_SIZE (GB_WIDTH * GB_HEIGHT)
+
+static std::vector<uint8_t> _save(gb_microbench_fixture& fixture) {
+    std::vector<uint8_t> state;
+    fixture.save_state(state);
+    return state;
+}
+
+static std::vector<uint8_t> _get_frame(gb_microbench_fixture& fixture) {
+    const uint8_t* pixels = fixture.get_framebuffer().get_pixels();
+    return std::vector<uint8_t>(pixels, pixels + GB_TILE_CACHE_TEST_FRAME_SIZE);
+}
+
+// Flip every bit of the tile data, behind the PPU's back
+static void _flip_tiles(gb_microbench_fixture& fixture) {
+    size_t size = 0;
+    uint8_t* vram = fixture.get_mem(GB_VIDEO_RAM_ADDR, size);
+    for (size_t i = 0; i < 0x1800; i++) vram[i] ^= 0xFF;
+}
+
+// Run a frame on fixture with its tile cache as it is, and the same frame on reference from the same state with no tile
+// cache, and check they draw the same thing. The frame must also differ from previous so a stale one can't pass
+static bool _check_frame(gb_microbench_fixture& fixture, gb_microbench_fixture& reference, const char* name,
+                         const std::vector<uint8_t>& previous) {
+    std::vector<uint8_t> state = _save(fixture);
+    fixture.run_frames(1);
+    std::vector<uint8_t> cached = _get_frame(fixture);
+
+    reference.load_state(state.data(), state.size());
+    reference.run_frame_uncached();
+    std::vector<uint8_t> uncached = _get_frame(reference);
+
+    if (uncached == previous) {
+        printf("%s: frame didn't change\n", name);
+        return false;
+    }
+
+    if (cached != uncached) {
+        size_t pixel = 0;
+        while (cached[pixel] == uncached[pixel]) pixel++;
+        printf("%s: frame differs from the uncached render at %zu,%zu\n", name, pixel % GB_WIDTH, pixel / GB_WIDTH);
+        return false;
+    }
+
+    printf("%s: ok\n", name);
+    return true;
+}
+
+// The program rewrites tiles while they're being drawn
+static bool _test_cpu_writes() {
+    gb_microbench_fixture fixture (g_tile_cache_test_vram_body);
+    gb_microbench_fixture reference (g_tile_cache_test_vram_body);
+    fixture.setup_ppu(1);
+    fixture.run_frames(2);
+
+    bool passed = true;
+    for (int i = 0; i < 3; i++) passed = _check_frame(fixture, reference, "cpu writes", _get_frame(fixture)) && passed;
+    return passed;
+}
+
+static bool _test_get_mem() {
+    gb_microbench_fixture fixture;
+    gb_microbench_fixture reference;
+    fixture.setup_ppu(1);
+    fixture.run_frames(2);
+    std::vector<uint8_t> previous = _get_frame(fixture);
+
+    _flip_tiles(fixture);
+    fixture.invalidate_vram();
+
+    return _check_frame(fixture, reference, "get_mem", previous);
+}
+
+static bool _test_load_state() {
+    gb_microbench_fixture fixture;
+    gb_microbench_fixture reference;
+    fixture.setup_ppu(1);
+    fixture.run_frames(2);
+    std::vector<uint8_t> state = _save(fixture);
+
+    // Decode the flipped tiles, then go back to the state that has the original ones
+    _flip_tiles(fixture);
+    fixture.invalidate_vram();
+    fixture.run_frames(2);
+    std::vector<uint8_t> previous = _get_frame(fixture);
+
+    fixture.load_state(state.data(), state.size());
+
+    return _check_frame(fixture, reference, "load_state", previous);
+}
+
+int main() {
+    bool passed = true;
+
+    try {
+        passed = _test_cpu_writes() && passed;
+        passed = _test_get_mem() && passed;
+        passed = _test_load_state() && passed;
+    } catch (const std::exception& e) {
+        printf("%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include "gb_batch.h"
+#include "gb_input_script.h"
+#include "gb_json.h"
+#include "gb_emulator.h"
+#include "gb_null_renderer.h"
+
+static std::string _resolve_path(const std::string& base_dir, const std::string& path) {
+    if (path.empty() || path[0] == '/' || base_dir.empty()) return path;
+    return base_dir + "/" + path;
+}
+
+std::vector<gb_batch::gb_batch_job_t> gb_batch::load_manifest(const std::string& filename) {
+    std::ifstream manifest_file (filename);
+
+    if (!manifest_file) {
+        throw std::runtime_error("gb_batch::load_manifest() - Invalid manifest: " + filename);
+    }
+
+    size_t slash = filename.rfind('/');
+    std::string base_dir = (slash == std::string::npos) ? std::string() : filename.substr(0, slash);
+
+    std::vector<gb_batch_job_t> jobs;
+    std::string line;
+
+    for (unsigned int line_num = 1; std::getline(manifest_file, line); line_num++) {
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream tokens (line);
+        std::string rom_filename, input_filename, frames_str, extra;
+        if (!(tokens >> rom_filename)) continue;
+
+        size_t pos = 0;
+        uint64_t num_frames = 0;
+        bool ok = (tokens >> input_filename) && (tokens >> frames_str) && !(tokens >> extra);
+
+        try {
+            if (ok) num_frames = std::stoull(frames_str, &pos, 0);
+        } catch (const std::exception& e) {
+            ok = false;
+        }
+
+        if (!ok || pos != frames_str.size()) {
+            std::ostringstream sstr;
+            sstr << "gb_batch::load_manifest() - " << filename << ":" << line_num << ": expected <rom_file> <input_script|-> <frames>";
+            throw std::runtime_error(sstr.str());
+        }
+
+        if (input_filename == "-") input_filename.clear();
+
+        jobs.push_back({_resolve_path(base_dir, rom_filename), _resolve_path(base_dir, input_filename), num_frames});
+    }
+
+    return jobs;
+}
+
+gb_batch::gb_batch_result_t gb_batch::run_job(const gb_batch_job_t& job) {
+    gb_batch_result_t result = {0, 0.0, 0, std::string(), std::string()};
+
+    try {
+        gb_input_script script;
+        if (!job.input_filename.empty()) script.load(job.input_filename);
+
+        std::ifstream rom_file (job.rom_filename, std::ifstream::binary);
+        if (!rom_file) throw std::runtime_error("gb_batch::run_job() - Invalid ROM file: " + job.rom_filename);
+        std::vector<uint8_t> rom_data ((std::istreambuf_iterator<char>(rom_file)), std::istreambuf_iterator<char>());
+
+        gb_null_renderer_ptr renderer = std::make_shared<gb_null_renderer>();
+        gb_emulator emulator (renderer);
+
+        // Serial output is collected per job instead of being printed from every thread
+        emulator.set_serial_echo(false);
+        emulator.load_rom(rom_data.data(), rom_data.size());
+        emulator.boot(false);
+
+        gb_input& input = renderer->get_input();
+        auto start = std::chrono::steady_clock::now();
+
+        for (; result.frames < job.num_frames; result.frames++) {
+            if (!script.empty()) input.set_buttons(script.get_buttons(result.frames));
+            emulator.run_frames(1);
+        }
+
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.frame_hash = renderer->get_framebuffer().get_hash();
+        result.serial_output = emulator.get_serial_output();
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+
+    return result;
+}
+
+void gb_batch::write_json(std::ostream& os, size_t index, const gb_batch_job_t& job, const gb_batch_result_t& result) {
+    char hash[32];
+    snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(result.frame_hash));
+
+    double fps = (result.seconds > 0.0) ? static_cast<double>(result.frames) / result.seconds : 0.0;
+
+    os << "{\"job\": " << index
+       << ", \"rom\": \"" << gb_json::escape(job.rom_filename) << "\""
+       << ", \"input\": \"" << gb_json::escape(job.input_filename) << "\""
+       << ", \"frames\": " << result.frames
+       << ", \"seconds\": " << result.seconds
+       << ", \"fps\": " << fps
+       << ", \"frame_hash\": \"" << hash << "\""
+       << ", \"serial\": \"" << gb_json::escape(result.serial_output) << "\"";
+
+    if (!result.error.empty()) os << ", \"error\": \"" << gb_json::escape(result.error) << "\"";
+
+    os << "}" << std::endl;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_BATCH_H_
+#define GB_BATCH_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+
+// Runs many independent emulator instances, one per job, without a window or frame limiter
+namespace gb_batch {
+    struct gb_batch_job_t {
+        std::string rom_filename;
+        std::string input_filename; // Empty if no input script
+        uint64_t    num_frames;
+    };
+
+    struct gb_batch_result_t {
+        uint64_t    frames;
+        double      seconds;
+        uint64_t    frame_hash;
+        std::string serial_output;
+        std::string error;          // Empty if the job succeeded
+    };
+
+    // Parse a manifest file. Each line describes a job:
+    //   <rom_file> <input_script|-> <frames>
+    // Relative paths are relative to the manifest's directory. Everything after a '#' is a comment
+    // Throws std::runtime_error on errors
+    std::vector<gb_batch_job_t> load_manifest(const std::string& filename);
+
+    // Run a single job to completion on the calling thread. Errors are reported in the result, this never throws
+    gb_batch_result_t run_job(const gb_batch_job_t& job);
+
+    // Write a job and its result as a single line JSON object
+    void write_json(std::ostream& os, size_t index, const gb_batch_job_t& job, const gb_batch_result_t& result);
+}
+
+#endif // GB_BATCH_H_
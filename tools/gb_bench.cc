@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "gb_bench.h"
+#include "gb_json.h"
+#include "gb_emulator.h"
+#include "gb_movie.h"
+#include "gb_null_renderer.h"
+
+// Nearest-rank percentile of a sorted list of frame times
+static uint64_t _percentile(const std::vector<uint64_t>& sorted, unsigned int percent) {
+    if (sorted.empty()) return 0;
+    size_t rank = (sorted.size() * percent + 99) / 100;
+    return sorted[std::max(rank, static_cast<size_t>(1)) - 1];
+}
+
+gb_bench::gb_bench_result_t gb_bench::run(const gb_bench_config_t& config) {
+    gb_bench_result_t result = {0, 0.0, 0, 0, 0, 0, 0, 0};
+
+    std::ifstream rom_file (config.rom_filename, std::ifstream::binary);
+    if (!rom_file) throw std::runtime_error("gb_bench::run() - Invalid ROM file: " + config.rom_filename);
+    std::vector<uint8_t> rom_data ((std::istreambuf_iterator<char>(rom_file)), std::istreambuf_iterator<char>());
+
+    gb_null_renderer_ptr renderer = std::make_shared<gb_null_renderer>();
+    gb_emulator emulator (renderer);
+    emulator.set_serial_echo(false);
+    emulator.load_rom(rom_data.data(), rom_data.size());
+
+    uint64_t num_frames = config.num_frames;
+    if (!config.movie_filename.empty()) {
+        gb_movie_ptr movie = std::make_shared<gb_movie>();
+        movie->load(config.movie_filename);
+        emulator.play_movie(movie);
+        if (num_frames == 0) num_frames = movie->get_frame_count() - std::min(config.warmup_frames, movie->get_frame_count());
+    } else {
+        emulator.boot(false);
+    }
+
+    emulator.run_frames(config.warmup_frames);
+
+    std::vector<uint64_t> frame_ns;
+    frame_ns.reserve(num_frames);
+
+    // Retired instructions only, idle steps while halted waiting for V-blank would inflate the rate
+    uint64_t start_instructions = emulator.get_perf_counters().instructions;
+    uint64_t start_cycles = emulator.get_cycle_count();
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto last = start; result.frames < num_frames; result.frames++) {
+        emulator.run_frames(1);
+
+        auto now = std::chrono::steady_clock::now();
+        frame_ns.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count()));
+        last = now;
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.instructions = emulator.get_perf_counters().instructions - start_instructions;
+    result.cycles = emulator.get_cycle_count() - start_cycles;
+    result.frame_hash = renderer->get_framebuffer().get_hash();
+
+    std::sort(frame_ns.begin(), frame_ns.end());
+    result.frame_ns_p50 = _percentile(frame_ns, 50);
+    result.frame_ns_p99 = _percentile(frame_ns, 99);
+    result.frame_ns_max = frame_ns.empty() ? 0 : frame_ns.back();
+
+    return result;
+}
+
+void gb_bench::write_json(std::ostream& os, const gb_bench_config_t& config, const gb_bench_result_t& result) {
+    char hash[32];
+    snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(result.frame_hash));
+
+    auto per_second = [&result](uint64_t count) {
+        return (result.seconds > 0.0) ? static_cast<double>(count) / result.seconds : 0.0;
+    };
+
+    // Instruction and cycle rates are in the millions, round them instead of printing them in exponent form
+    auto rounded = [](double val) {
+        return static_cast<uint64_t>(val + 0.5);
+    };
+
+    os << "{\"rom\": \"" << gb_json::escape(config.rom_filename) << "\""
+       << ", \"movie\": \"" << gb_json::escape(config.movie_filename) << "\""
+       << ", \"warmup_frames\": " << config.warmup_frames
+       << ", \"frames\": " << result.frames
+       << ", \"seconds\": " << result.seconds
+       << ", \"frames_per_sec\": " << per_second(result.frames)
+       << ", \"instructions_per_sec\": " << rounded(per_second(result.instructions))
+       << ", \"cycles_per_sec\": " << rounded(per_second(result.cycles))
+       << ", \"frame_ns_p50\": " << result.frame_ns_p50
+       << ", \"frame_ns_p99\": " << result.frame_ns_p99
+       << ", \"frame_ns_max\": " << result.frame_ns_max
+       << ", \"frame_hash\": \"" << hash << "\""
+       << "}" << std::endl;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_BENCH_H_
+#define GB_BENCH_H_
+
+#include <cstdint>
+#include <string>
+#include <ostream>
+
+// Measures raw emulator throughput: a single instance without a window or frame limiter, timed frame by frame
+namespace gb_bench {
+    struct gb_bench_config_t {
+        std::string rom_filename;
+        std::string movie_filename; // Empty to run without input from power on
+        uint64_t    num_frames;     // 0 runs the whole movie
+        uint64_t    warmup_frames;  // Run before timing starts, not included in the results
+    };
+
+    struct gb_bench_result_t {
+        uint64_t frames;
+        double   seconds;
+        uint64_t instructions;  // Retired, idle steps while halted aren't counted
+        uint64_t cycles;
+        uint64_t frame_ns_p50;
+        uint64_t frame_ns_p99;
+        uint64_t frame_ns_max;
+        uint64_t frame_hash;
+    };
+
+    // Run the benchmark on the calling thread, throws std::runtime_error if the ROM or movie can't be loaded
+    gb_bench_result_t run(const gb_bench_config_t& config);
+
+    // Write the configuration and results as a single JSON object
+    void write_json(std::ostream& os, const gb_bench_config_t& config, const gb_bench_result_t& result);
+}
+
+#endif // GB_BENCH_H_
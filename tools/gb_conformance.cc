@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "gb_conformance.h"
+#include "gb_json.h"
+#include "gb_emulator.h"
+#include "gb_null_renderer.h"
+
+#define GB_CONFORMANCE_FRAME_CYCLES  (70224)
+
+// Frames to keep running after "Passed" or "Failed" shows up to collect the rest of the line (i.e. "Failed #3")
+#define GB_CONFORMANCE_SERIAL_FRAMES (30)
+
+static const char* g_status_names[] = {"pass", "fail", "hang", "error"};
+
+static bool _has_extension(const std::string& filename, const std::string& extension) {
+    if (filename.size() < extension.size()) return false;
+
+    std::string tail = filename.substr(filename.size() - extension.size());
+    std::transform(tail.begin(), tail.end(), tail.begin(), ::tolower);
+    return tail == extension;
+}
+
+static void _find_roms(const std::string& path, std::vector<std::string>& roms) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) return;
+
+    for (struct dirent* entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+
+        std::string child = path + "/" + name;
+        struct stat st;
+        if (stat(child.c_str(), &st) != 0) continue;
+
+        if (S_ISDIR(st.st_mode)) {
+            _find_roms(child, roms);
+        } else if (_has_extension(name, ".gb") || _has_extension(name, ".gbc")) {
+            roms.push_back(child);
+        }
+    }
+
+    closedir(dir);
+}
+
+std::vector<std::string> gb_conformance::find_roms(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) throw std::runtime_error("gb_conformance::find_roms() - No such file or directory: " + path);
+
+    std::vector<std::string> roms;
+    if (!S_ISDIR(st.st_mode)) {
+        roms.push_back(path);
+        return roms;
+    }
+
+    std::string dir = path;
+    while (dir.size() > 1 && dir.back() == '/') dir.pop_back();
+
+    _find_roms(dir, roms);
+    std::sort(roms.begin(), roms.end());
+    return roms;
+}
+
+static void _check_registers(const gb_cpu::registers_t& registers, gb_conformance::gb_test_result_t& result) {
+    const uint8_t values[] = {registers.b, registers.c, registers.d, registers.e, registers.h, registers.l};
+    const uint8_t pass[] = {3, 5, 8, 13, 21, 34};
+
+    if (std::equal(std::begin(values), std::end(values), std::begin(pass))) {
+        result.status = gb_conformance::GB_STATUS_PASS;
+        result.message = "LD B,B with the pass signature in the registers";
+    } else {
+        bool fail = std::all_of(std::begin(values), std::end(values), [] (uint8_t value) { return value == 0x42; });
+        result.status = gb_conformance::GB_STATUS_FAIL;
+        result.message = fail ? "LD B,B with the fail signature in the registers" : "LD B,B without a known signature in the registers";
+    }
+}
+
+gb_conformance::gb_test_result_t gb_conformance::run_test(const std::string& rom_filename, uint64_t max_frames) {
+    gb_test_result_t result = {GB_STATUS_HANG, 0, 0.0, std::string(), std::string()};
+
+    try {
+        std::ifstream rom_file (rom_filename, std::ifstream::binary);
+        if (!rom_file) throw std::runtime_error("gb_conformance::run_test() - Invalid ROM file: " + rom_filename);
+        std::vector<uint8_t> rom_data ((std::istreambuf_iterator<char>(rom_file)), std::istreambuf_iterator<char>());
+
+        gb_null_renderer_ptr renderer = std::make_shared<gb_null_renderer>();
+        gb_emulator emulator (renderer);
+
+        emulator.set_serial_echo(false);
+        emulator.load_rom(rom_data.data(), rom_data.size());
+        emulator.boot(false);
+        emulator.set_magic_breakpoint(true);
+
+        auto start = std::chrono::steady_clock::now();
+        const std::string& serial = emulator.get_serial_output();
+        size_t searched = 0;
+        size_t result_pos = std::string::npos;
+        uint64_t stop_frame = max_frames;
+
+        // The frame counter only decides when to give up, the emulator is stepped directly so there's nothing to present
+        for (; result.frames < stop_frame; result.frames++) {
+            int cycles = 0;
+            if (emulator.step(GB_CONFORMANCE_FRAME_CYCLES, cycles) == GB_STOP_MAGIC_BREAKPOINT) {
+                _check_registers(emulator.get_cpu_registers(), result);
+                result.frames++;
+                break;
+            }
+
+            if (result_pos == std::string::npos && serial.size() != searched) {
+                // Start a little before the new output in case the word was split across frames
+                size_t from = (searched > 6) ? searched - 6 : 0;
+                size_t pass_pos = serial.find("Passed", from);
+                size_t fail_pos = serial.find("Failed", from);
+                searched = serial.size();
+
+                if (pass_pos != std::string::npos || fail_pos != std::string::npos) {
+                    result.status = (fail_pos != std::string::npos) ? GB_STATUS_FAIL : GB_STATUS_PASS;
+                    result.message = (fail_pos != std::string::npos) ? "\"Failed\" in the serial output" : "\"Passed\" in the serial output";
+                    result_pos = std::min(pass_pos, fail_pos);
+                    stop_frame = std::min(max_frames, result.frames + GB_CONFORMANCE_SERIAL_FRAMES);
+                }
+            }
+
+            if (result_pos != std::string::npos && serial.find('\n', result_pos) != std::string::npos) {
+                result.frames++;
+                break;
+            }
+        }
+
+        if (result.status == GB_STATUS_HANG) result.message = "No result after " + std::to_string(max_frames) + " frames";
+
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.serial_output = serial;
+    } catch (const std::exception& e) {
+        result.status = GB_STATUS_ERROR;
+        result.message = e.what();
+    }
+
+    return result;
+}
+
+const char* gb_conformance::get_status_name(gb_status_t status) {
+    return g_status_names[status];
+}
+
+void gb_conformance::write_json(std::ostream& os, const std::string& rom_filename, const gb_test_result_t& result) {
+    os << "{\"rom\": \"" << gb_json::escape(rom_filename) << "\""
+       << ", \"status\": \"" << get_status_name(result.status) << "\""
+       << ", \"frames\": " << result.frames
+       << ", \"seconds\": " << result.seconds
+       << ", \"message\": \"" << gb_json::escape(result.message) << "\""
+       << ", \"serial\": \"" << gb_json::escape(result.serial_output) << "\"}" << std::endl;
+}
+
+static std::string _xml_escape(const std::string& str) {
+    std::string escaped;
+
+    for (char c : str) {
+        switch (c) {
+            case '&':  escaped += "&amp;"; break;
+            case '<':  escaped += "&lt;"; break;
+            case '>':  escaped += "&gt;"; break;
+            case '"':  escaped += "&quot;"; break;
+            case '\'': escaped += "&apos;"; break;
+            default:
+                // Control characters aren't allowed in XML 1.0 at all and anything above ASCII may not be valid UTF-8
+                if ((static_cast<unsigned char>(c) >= 0x20 && static_cast<unsigned char>(c) < 0x80) || c == '\n' || c == '\t') {
+                    escaped += c;
+                } else {
+                    escaped += '?';
+                }
+                break;
+        }
+    }
+
+    return escaped;
+}
+
+void gb_conformance::write_junit(std::ostream& os, const std::vector<std::string>& rom_filenames, const std::vector<gb_test_result_t>& results, double seconds) {
+    size_t failures = static_cast<size_t>(std::count_if(results.begin(), results.end(), [] (const gb_test_result_t& result) {
+        return result.status == GB_STATUS_FAIL || result.status == GB_STATUS_HANG;
+    }));
+    size_t errors = static_cast<size_t>(std::count_if(results.begin(), results.end(), [] (const gb_test_result_t& result) {
+        return result.status == GB_STATUS_ERROR;
+    }));
+
+    os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+    os << "<testsuite name=\"goodboy-conformance\" tests=\"" << results.size() << "\" failures=\"" << failures
+       << "\" errors=\"" << errors << "\" time=\"" << seconds << "\">" << std::endl;
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const gb_test_result_t& result = results[i];
+
+        // The directory is used as the class name so CI systems group the tests by suite
+        size_t slash = rom_filenames[i].rfind('/');
+        std::string classname = (slash == std::string::npos) ? std::string() : rom_filenames[i].substr(0, slash);
+        std::string name = (slash == std::string::npos) ? rom_filenames[i] : rom_filenames[i].substr(slash + 1);
+
+        os << "  <testcase classname=\"" << _xml_escape(classname) << "\" name=\"" << _xml_escape(name) << "\" time=\"" << result.seconds << "\">" << std::endl;
+
+        if (result.status == GB_STATUS_FAIL || result.status == GB_STATUS_HANG) {
+            os << "    <failure type=\"" << get_status_name(result.status) << "\" message=\"" << _xml_escape(result.message) << "\"/>" << std::endl;
+        } else if (result.status == GB_STATUS_ERROR) {
+            os << "    <error message=\"" << _xml_escape(result.message) << "\"/>" << std::endl;
+        }
+
+        if (!result.serial_output.empty()) os << "    <system-out>" << _xml_escape(result.serial_output) << "</system-out>" << std::endl;
+        os << "  </testcase>" << std::endl;
+    }
+
+    os << "</testsuite>" << std::endl;
+}
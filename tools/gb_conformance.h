@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_CONFORMANCE_H_
+#define GB_CONFORMANCE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+
+// Runs test ROMs (i.e. blargg's and mooneye-gb's) headless and decides whether they passed from what they report:
+// blargg's tests print "Passed" or "Failed" over the serial port, mooneye-gb's tests run LD B,B when they're done and leave
+// the Fibonacci numbers 3, 5, 8, 13, 21, 34 in B, C, D, E, H, L if they passed or 0x42 in every register if they failed
+namespace gb_conformance {
+    enum gb_status_t {
+        GB_STATUS_PASS,
+        GB_STATUS_FAIL,
+        GB_STATUS_HANG,  // Ran out of time without reporting a result
+        GB_STATUS_ERROR  // The ROM couldn't be loaded
+    };
+
+    struct gb_test_result_t {
+        gb_status_t status;
+        uint64_t    frames;
+        double      seconds;
+        std::string serial_output;
+        std::string message;     // How the result was detected or the error
+    };
+
+    // Every .gb and .gbc file under the given path (searched recursively) sorted by name, or the path itself if it's a file
+    // Throws std::runtime_error if the path doesn't exist
+    std::vector<std::string> find_roms(const std::string& path);
+
+    // Run a test ROM on the calling thread until it reports a result or max_frames frames of emulated time have passed
+    // Errors are reported in the result, this never throws
+    gb_test_result_t run_test(const std::string& rom_filename, uint64_t max_frames);
+
+    const char* get_status_name(gb_status_t status);
+
+    // Write a test and its result as a single line JSON object
+    void write_json(std::ostream& os, const std::string& rom_filename, const gb_test_result_t& result);
+
+    // Write all the results as a JUnit XML test suite, which CI systems know how to show
+    void write_junit(std::ostream& os, const std::vector<std::string>& rom_filenames, const std::vector<gb_test_result_t>& results, double seconds);
+}
+
+#endif // GB_CONFORMANCE_H_
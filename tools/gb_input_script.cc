@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "gb_input_script.h"
+#include "gb_input.h"
+
+static const std::unordered_map<std::string, gb_button_t> button_name_map =
+{
+    {"DOWN", GB_BUTTON_DOWN},
+    {"UP", GB_BUTTON_UP},
+    {"LEFT", GB_BUTTON_LEFT},
+    {"RIGHT", GB_BUTTON_RIGHT},
+    {"START", GB_BUTTON_START},
+    {"SELECT", GB_BUTTON_SELECT},
+    {"B", GB_BUTTON_B},
+    {"A", GB_BUTTON_A}
+};
+
+gb_input_script::gb_input_script()
+    : m_events()
+{
+}
+
+void gb_input_script::load(const std::string& filename) {
+    std::ifstream script_file (filename);
+
+    if (!script_file) {
+        throw std::runtime_error("gb_input_script::load() - Invalid input script: " + filename);
+    }
+
+    std::ostringstream sstr;
+    sstr << script_file.rdbuf();
+    parse(sstr.str(), filename);
+}
+
+void gb_input_script::parse(const std::string& script, const std::string& name) {
+    std::istringstream lines (script);
+    std::string line;
+
+    m_events.clear();
+
+    for (unsigned int line_num = 1; std::getline(lines, line); line_num++) {
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream tokens (line);
+        std::string frame_str, buttons_str, extra;
+        if (!(tokens >> frame_str)) continue;
+
+        try {
+            if (!(tokens >> buttons_str) || (tokens >> extra)) throw std::invalid_argument("expected <frame> <buttons>");
+
+            size_t pos = 0;
+            uint64_t frame = std::stoull(frame_str, &pos, 0);
+            if (pos != frame_str.size()) throw std::invalid_argument("invalid frame number " + frame_str);
+
+            m_events.emplace_back(frame, _parse_buttons(buttons_str));
+        } catch (const std::exception& e) {
+            std::ostringstream sstr;
+            sstr << "gb_input_script::parse() - " << name << ":" << line_num << ": " << e.what();
+            throw std::runtime_error(sstr.str());
+        }
+    }
+
+    // Keep the order of events on the same frame so the last one wins
+    std::stable_sort(m_events.begin(), m_events.end(), [](const gb_input_event_t& a, const gb_input_event_t& b) { return a.first < b.first; });
+}
+
+uint8_t gb_input_script::get_buttons(uint64_t frame) const {
+    // Find the last event at or before this frame
+    auto it = std::upper_bound(m_events.begin(), m_events.end(), frame, [](uint64_t f, const gb_input_event_t& e) { return f < e.first; });
+    return (it == m_events.begin()) ? 0 : std::prev(it)->second;
+}
+
+bool gb_input_script::empty() const {
+    return m_events.empty();
+}
+
+uint8_t gb_input_script::_parse_buttons(const std::string& token) const {
+    if (token == "-") return 0;
+
+    if (token.compare(0, 2, "0x") == 0 || token.compare(0, 2, "0X") == 0) {
+        size_t pos = 0;
+        unsigned long mask = std::stoul(token, &pos, 16);
+        if (pos != token.size() || mask > 0xff) throw std::invalid_argument("invalid button mask " + token);
+        return static_cast<uint8_t>(mask);
+    }
+
+    uint8_t mask = 0;
+    std::istringstream names (token);
+    for (std::string button_name; std::getline(names, button_name, '+'); ) {
+        std::transform(button_name.begin(), button_name.end(), button_name.begin(), ::toupper);
+
+        auto it = button_name_map.find(button_name);
+        if (it == button_name_map.end()) throw std::invalid_argument("unknown button " + button_name);
+
+        mask = static_cast<uint8_t>(mask | (1u << it->second));
+    }
+
+    return mask;
+}
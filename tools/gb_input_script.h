@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_INPUT_SCRIPT_H_
+#define GB_INPUT_SCRIPT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+
+// A scripted sequence of button presses. Each line of a script has the form:
+//   <frame> <buttons>
+// and sets the state of every button from that frame on. <buttons> is '-' for no buttons, a mask (i.e. 0x81)
+// where bit N is gb_button_t N, or button names joined with '+' (i.e. A+RIGHT).
+// Button names are UP, DOWN, LEFT, RIGHT, A, B, START and SELECT. Everything after a '#' is a comment
+class gb_input_script {
+public:
+    gb_input_script();
+
+    // Parse a script from a file, throws std::runtime_error on errors
+    void load(const std::string& filename);
+
+    // Parse a script from a string, name is used in error messages
+    void parse(const std::string& script, const std::string& name);
+
+    // Get the button mask to apply at the given frame
+    uint8_t get_buttons(uint64_t frame) const;
+
+    bool empty() const;
+
+private:
+    using gb_input_event_t = std::pair<uint64_t, uint8_t>;
+
+    // Sorted by frame
+    std::vector<gb_input_event_t> m_events;
+
+    uint8_t _parse_buttons(const std::string& token) const;
+};
+
+#endif // GB_INPUT_SCRIPT_H_
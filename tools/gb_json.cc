@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+#include "gb_json.h"
+
+namespace {
+    // A recursive descent parser over the whole document, only numbers are kept
+    struct gb_json_parser_t {
+        const std::string&             text;
+        const std::string&             name;
+        size_t                         pos;
+        std::map<std::string, double>& numbers;
+
+        [[noreturn]] void error(const std::string& msg) {
+            std::ostringstream sstr;
+            sstr << "gb_json::parse_numbers() - " << name << ": " << msg << " at offset " << pos;
+            throw std::runtime_error(sstr.str());
+        }
+
+        void skip_space() {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) pos++;
+        }
+
+        void expect(char c) {
+            skip_space();
+            if (pos >= text.size() || text[pos] != c) error(std::string("expected '") + c + "'");
+            pos++;
+        }
+
+        // Escapes other than \" and \\ are kept as they are, keys only need to match what escape() writes
+        std::string parse_string() {
+            expect('"');
+
+            std::string str;
+            for (; pos < text.size() && text[pos] != '"'; pos++) {
+                if (text[pos] == '\\' && pos + 1 < text.size()) {
+                    pos++;
+                    if (text[pos] != '"' && text[pos] != '\\') str.push_back('\\');
+                }
+                str.push_back(text[pos]);
+            }
+
+            if (pos >= text.size()) error("unterminated string");
+            pos++;
+            return str;
+        }
+
+        // Numbers inside arrays have no key so they are parsed but not kept
+        void parse_value(const std::string& key, bool keep) {
+            skip_space();
+            if (pos >= text.size()) error("expected a value");
+
+            char c = text[pos];
+            if (c == '{') {
+                parse_object(key + ".", keep);
+            } else if (c == '[') {
+                pos++;
+                skip_space();
+                if (pos < text.size() && text[pos] == ']') {
+                    pos++;
+                    return;
+                }
+                do parse_value(std::string(), false); while (accept(','));
+                expect(']');
+            } else if (c == '"') {
+                parse_string();
+            } else if (text.compare(pos, 4, "true") == 0 || text.compare(pos, 4, "null") == 0) {
+                pos += 4;
+            } else if (text.compare(pos, 5, "false") == 0) {
+                pos += 5;
+            } else {
+                const char* start = text.c_str() + pos;
+                char* end = nullptr;
+                double val = std::strtod(start, &end);
+                if (end == start) error("expected a value");
+
+                pos += static_cast<size_t>(end - start);
+                if (keep) numbers[key] = val;
+            }
+        }
+
+        void parse_object(const std::string& prefix, bool keep) {
+            expect('{');
+            skip_space();
+            if (pos < text.size() && text[pos] == '}') {
+                pos++;
+                return;
+            }
+
+            do {
+                std::string key = parse_string();
+                expect(':');
+                parse_value(prefix + key, keep);
+            } while (accept(','));
+
+            expect('}');
+        }
+
+        bool accept(char c) {
+            skip_space();
+            if (pos >= text.size() || text[pos] != c) return false;
+            pos++;
+            return true;
+        }
+    };
+}
+
+std::string gb_json::escape(const std::string& str) {
+    std::string out;
+
+    for (char c : str) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20 || static_cast<unsigned char>(c) >= 0x7f) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                    out += buf;
+                } else {
+                    out.push_back(c);
+                }
+                break;
+        }
+    }
+
+    return out;
+}
+
+std::map<std::string, double> gb_json::parse_numbers(const std::string& text, const std::string& name) {
+    std::map<std::string, double> numbers;
+    gb_json_parser_t parser = {text, name, 0, numbers};
+
+    parser.parse_object(std::string(), true);
+    parser.skip_space();
+    if (parser.pos != text.size()) parser.error("unexpected characters after the document");
+
+    return numbers;
+}
@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_JSON_H_
+#define GB_JSON_H_
+
+#include <string>
+#include <map>
+
+// Helpers shared by the tools that write JSON reports
+namespace gb_json {
+    // Escape a string for use inside a JSON string literal, non-printable and non-ASCII bytes are written as \u00XX
+    std::string escape(const std::string& str);
+
+    // Read the numbers out of a JSON document whose top level is an object. Keys of nested objects are joined with '.'
+    // (i.e. {"a": {"b": 1}} gives "a.b"), strings, booleans, nulls and arrays are skipped
+    // Throws std::runtime_error if the document isn't valid JSON, name is used in the error message
+    std::map<std::string, double> parse_numbers(const std::string& text, const std::string& name);
+}
+
+#endif // GB_JSON_H_
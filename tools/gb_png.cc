@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+
+#include "gb_png.h"
+
+// Deflate's stored blocks hold at most this many bytes
+#define GB_PNG_MAX_STORED_BLOCK (65535)
+
+using gb_png_bytes_t = std::vector<uint8_t>;
+
+static void _put_u32(gb_png_bytes_t& bytes, uint32_t val) {
+    bytes.push_back(static_cast<uint8_t>(val >> 24));
+    bytes.push_back(static_cast<uint8_t>(val >> 16));
+    bytes.push_back(static_cast<uint8_t>(val >> 8));
+    bytes.push_back(static_cast<uint8_t>(val));
+}
+
+static uint32_t _crc32(const uint8_t* data, size_t size) {
+    static std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t;
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            t[n] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static uint32_t _adler32(const gb_png_bytes_t& data) {
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : data) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static void _put_chunk(gb_png_bytes_t& png, const char* type, const gb_png_bytes_t& data) {
+    _put_u32(png, static_cast<uint32_t>(data.size()));
+
+    // The CRC covers the chunk type and data
+    size_t start = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    _put_u32(png, _crc32(&png[start], png.size() - start));
+}
+
+void gb_png::write(const std::string& filename, const gb_framebuffer& framebuffer) {
+    static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    static const uint8_t palette[] = {255, 255, 255, 192, 192, 192, 96, 96, 96, 0, 0, 0};
+
+    // Each row starts with filter type 0 (none) and packs four 2-bit pixels per byte, leftmost in the high bits
+    const uint8_t* pixels = framebuffer.get_pixels();
+    gb_png_bytes_t raw;
+    for (unsigned int y = 0; y < GB_HEIGHT; y++) {
+        raw.push_back(0);
+        for (unsigned int x = 0; x < GB_WIDTH; x += 4) {
+            const uint8_t* p = &pixels[(y * GB_WIDTH) + x];
+            raw.push_back(static_cast<uint8_t>(((p[0] & 0x3) << 6) | ((p[1] & 0x3) << 4) | ((p[2] & 0x3) << 2) | (p[3] & 0x3)));
+        }
+    }
+
+    // zlib stream of stored deflate blocks
+    gb_png_bytes_t idat = {0x78, 0x01};
+    for (size_t pos = 0; pos < raw.size(); pos += GB_PNG_MAX_STORED_BLOCK) {
+        uint16_t len = static_cast<uint16_t>(std::min<size_t>(raw.size() - pos, GB_PNG_MAX_STORED_BLOCK));
+        bool last = (pos + len) == raw.size();
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(static_cast<uint8_t>(len));
+        idat.push_back(static_cast<uint8_t>(len >> 8));
+        idat.push_back(static_cast<uint8_t>(~len));
+        idat.push_back(static_cast<uint8_t>(~len >> 8));
+        idat.insert(idat.end(), raw.begin() + static_cast<std::ptrdiff_t>(pos), raw.begin() + static_cast<std::ptrdiff_t>(pos + len));
+    }
+    _put_u32(idat, _adler32(raw));
+
+    // Width, height, bit depth 2, colour type 3 (palette), default compression, filter and no interlacing
+    gb_png_bytes_t ihdr;
+    _put_u32(ihdr, GB_WIDTH);
+    _put_u32(ihdr, GB_HEIGHT);
+    ihdr.insert(ihdr.end(), {2, 3, 0, 0, 0});
+
+    gb_png_bytes_t png (std::begin(signature), std::end(signature));
+    _put_chunk(png, "IHDR", ihdr);
+    _put_chunk(png, "PLTE", gb_png_bytes_t(std::begin(palette), std::end(palette)));
+    _put_chunk(png, "IDAT", idat);
+    _put_chunk(png, "IEND", gb_png_bytes_t());
+
+    std::ofstream file (filename, std::ofstream::binary);
+    if (!file || !file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()))) {
+        throw std::runtime_error("gb_png::write() - Can't write file: " + filename);
+    }
+}
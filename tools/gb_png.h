@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_PNG_H_
+#define GB_PNG_H_
+
+#include <string>
+
+#include "gb_framebuffer.h"
+
+// Minimal PNG writer for dumping frames from the tools without pulling in zlib or libpng
+namespace gb_png {
+    // Write the framebuffer as a 2-bit palette PNG using the same greys as the SFML renderer. The image data is stored
+    // uncompressed, a frame is only about 6KB that way. Throws std::runtime_error if the file can't be written
+    void write(const std::string& filename, const gb_framebuffer& framebuffer);
+}
+
+#endif // GB_PNG_H_
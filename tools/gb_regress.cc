@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include "gb_regress.h"
+#include "gb_input_script.h"
+#include "gb_json.h"
+#include "gb_png.h"
+#include "gb_emulator.h"
+#include "gb_movie.h"
+#include "gb_null_renderer.h"
+
+#define GB_REGRESS_GOLDEN_FILE "golden.txt"
+
+static std::string _basename(const std::string& path) {
+    size_t slash = path.rfind('/');
+    return (slash == std::string::npos) ? path : path.substr(slash + 1);
+}
+
+static bool _is_movie(const std::string& filename) {
+    return filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".gbm") == 0;
+}
+
+static std::string _frame_filename(const std::string& dir, const std::string& name, uint64_t frame, const char* suffix) {
+    std::ostringstream sstr;
+    sstr << dir << "/" << name << "." << frame << suffix << ".png";
+    return sstr.str();
+}
+
+std::string gb_regress::get_name(const gb_batch::gb_batch_job_t& job) {
+    return _basename(job.rom_filename) + "+" + (job.input_filename.empty() ? std::string("-") : _basename(job.input_filename));
+}
+
+gb_regress::gb_golden_map_t gb_regress::load_golden(const std::string& golden_dir) {
+    gb_golden_map_t golden;
+
+    std::string filename = golden_dir + "/" GB_REGRESS_GOLDEN_FILE;
+    std::ifstream golden_file (filename);
+    if (!golden_file) return golden;
+
+    std::string line;
+    for (unsigned int line_num = 1; std::getline(golden_file, line); line_num++) {
+        std::istringstream tokens (line);
+        std::string name, frame_str, hash_str;
+        if (!(tokens >> name)) continue;
+
+        try {
+            if (!(tokens >> frame_str >> hash_str)) throw std::invalid_argument(line);
+            golden[name][std::stoull(frame_str)] = std::stoull(hash_str, nullptr, 16);
+        } catch (const std::exception& e) {
+            std::ostringstream sstr;
+            sstr << "gb_regress::load_golden() - " << filename << ":" << line_num << ": expected <name> <frame> <hash>";
+            throw std::runtime_error(sstr.str());
+        }
+    }
+
+    return golden;
+}
+
+void gb_regress::save_golden(const std::string& golden_dir, const gb_golden_map_t& golden) {
+    std::string filename = golden_dir + "/" GB_REGRESS_GOLDEN_FILE;
+    std::ofstream golden_file (filename);
+    if (!golden_file) throw std::runtime_error("gb_regress::save_golden() - Can't write file: " + filename);
+
+    char hash[32];
+    for (const auto& job : golden) {
+        for (const auto& frame : job.second) {
+            snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(frame.second));
+            golden_file << job.first << " " << frame.first << " " << hash << std::endl;
+        }
+    }
+}
+
+static void _copy_file(const std::string& from, const std::string& to) {
+    std::ifstream src (from, std::ifstream::binary);
+    if (!src) return;
+
+    std::ofstream dst (to, std::ofstream::binary);
+    dst << src.rdbuf();
+}
+
+gb_regress::gb_regress_result_t gb_regress::run_job(const gb_batch::gb_batch_job_t& job, const gb_golden_frames_t* golden, const gb_regress_config_t& config) {
+    gb_regress_result_t result = {std::vector<gb_checkpoint_t>(), 0, 0, 0, std::string()};
+
+    try {
+        std::ifstream rom_file (job.rom_filename, std::ifstream::binary);
+        if (!rom_file) throw std::runtime_error("gb_regress::run_job() - Invalid ROM file: " + job.rom_filename);
+        std::vector<uint8_t> rom_data ((std::istreambuf_iterator<char>(rom_file)), std::istreambuf_iterator<char>());
+
+        gb_null_renderer_ptr renderer = std::make_shared<gb_null_renderer>();
+        gb_emulator emulator (renderer);
+        emulator.set_serial_echo(false);
+        emulator.load_rom(rom_data.data(), rom_data.size());
+
+        gb_input_script script;
+        if (_is_movie(job.input_filename)) {
+            gb_movie_ptr movie = std::make_shared<gb_movie>();
+            movie->load(job.input_filename);
+            emulator.play_movie(movie);
+        } else {
+            if (!job.input_filename.empty()) script.load(job.input_filename);
+            emulator.boot(false);
+        }
+
+        std::string name = get_name(job);
+        const gb_framebuffer& framebuffer = renderer->get_framebuffer();
+        gb_input& input = renderer->get_input();
+
+        for (uint64_t frame = 1; frame <= job.num_frames; frame++) {
+            if (!script.empty()) input.set_buttons(script.get_buttons(frame - 1));
+            emulator.run_frames(1);
+
+            if ((frame % config.interval) != 0 && frame != job.num_frames) continue;
+
+            uint64_t hash = framebuffer.get_hash();
+            result.checkpoints.push_back({frame, hash});
+
+            if (config.update) {
+                gb_png::write(_frame_filename(config.golden_dir, name, frame, ""), framebuffer);
+                continue;
+            }
+
+            auto golden_frame = (golden != nullptr) ? golden->find(frame) : gb_golden_frames_t::const_iterator();
+            if (golden == nullptr || golden_frame == golden->end()) {
+                result.missing++;
+            } else if (golden_frame->second != hash) {
+                if (result.mismatches++ == 0) result.first_mismatch = frame;
+
+                gb_png::write(_frame_filename(config.diff_dir, name, frame, ".actual"), framebuffer);
+                _copy_file(_frame_filename(config.golden_dir, name, frame, ""), _frame_filename(config.diff_dir, name, frame, ".expected"));
+            }
+        }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+
+    return result;
+}
+
+void gb_regress::write_json(std::ostream& os, const gb_batch::gb_batch_job_t& job, const gb_regress_result_t& result) {
+    os << "{\"name\": \"" << gb_json::escape(get_name(job)) << "\""
+       << ", \"rom\": \"" << gb_json::escape(job.rom_filename) << "\""
+       << ", \"input\": \"" << gb_json::escape(job.input_filename) << "\""
+       << ", \"checkpoints\": " << result.checkpoints.size()
+       << ", \"mismatches\": " << result.mismatches
+       << ", \"missing\": " << result.missing;
+
+    if (result.mismatches != 0) os << ", \"first_mismatch\": " << result.first_mismatch;
+    if (!result.error.empty()) os << ", \"error\": \"" << gb_json::escape(result.error) << "\"";
+
+    os << "}" << std::endl;
+}
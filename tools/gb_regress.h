@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_REGRESS_H_
+#define GB_REGRESS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+#include "gb_batch.h"
+
+// Golden frame regression tests: runs the jobs of a batch manifest, hashes the framebuffer at regular checkpoints and
+// compares the hashes against ones recorded by a known good build. Jobs are named <rom>+<input> after the file names
+// (i.e. tetris.gb+tetris.txt, or tetris.gb+- without input), input files ending in .gbm are played back as movies
+namespace gb_regress {
+    struct gb_regress_config_t {
+        std::string golden_dir;  // Holds golden.txt and, if they were recorded, a PNG of every golden frame
+        std::string diff_dir;    // Where the PNGs of mismatching frames are written
+        uint64_t    interval;    // Frames between checkpoints, the last frame is always a checkpoint
+        bool        update;      // Record new golden frames instead of comparing
+    };
+
+    struct gb_checkpoint_t {
+        uint64_t frame;
+        uint64_t hash;
+    };
+
+    struct gb_regress_result_t {
+        std::vector<gb_checkpoint_t> checkpoints;
+        uint64_t                     mismatches;
+        uint64_t                     missing;        // Checkpoints without a golden hash
+        uint64_t                     first_mismatch; // Frame of the first mismatch, 0 if there were none
+        std::string                  error;          // Empty if the job ran
+    };
+
+    // Golden hashes of each job by frame
+    using gb_golden_frames_t = std::map<uint64_t, uint64_t>;
+    using gb_golden_map_t    = std::map<std::string, gb_golden_frames_t>;
+
+    std::string get_name(const gb_batch::gb_batch_job_t& job);
+
+    // Read or write golden.txt in the golden directory, one "<name> <frame> <hash>" per line. A missing file is read as
+    // having no golden frames. Throws std::runtime_error on errors
+    gb_golden_map_t load_golden(const std::string& golden_dir);
+    void save_golden(const std::string& golden_dir, const gb_golden_map_t& golden);
+
+    // Run a single job to completion on the calling thread. golden is nullptr if there are no golden frames for the job
+    // Errors are reported in the result, this never throws
+    gb_regress_result_t run_job(const gb_batch::gb_batch_job_t& job, const gb_golden_frames_t* golden, const gb_regress_config_t& config);
+
+    // Write a job and its result as a single line JSON object
+    void write_json(std::ostream& os, const gb_batch::gb_batch_job_t& job, const gb_regress_result_t& result);
+}
+
+#endif // GB_REGRESS_H_
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+
+#include "gb_thread_pool.h"
+
+gb_thread_pool::gb_thread_pool(unsigned int num_threads)
+    : m_queues(), m_threads(), m_mutex(), m_work_cv(), m_done_cv(), m_queued(0), m_pending(0), m_next_queue(0), m_stop(false)
+{
+    num_threads = std::max(num_threads, 1u);
+
+    for (unsigned int i = 0; i < num_threads; i++) {
+        m_queues.push_back(std::make_unique<gb_task_queue_t>());
+    }
+
+    for (unsigned int i = 0; i < num_threads; i++) {
+        m_threads.emplace_back(&gb_thread_pool::_worker, this, i);
+    }
+}
+
+gb_thread_pool::~gb_thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_stop = true;
+    }
+
+    m_work_cv.notify_all();
+    for (std::thread& thread : m_threads) thread.join();
+}
+
+void gb_thread_pool::submit(task_t task) {
+    std::lock_guard<std::mutex> lock (m_mutex);
+
+    gb_task_queue_t& queue = *m_queues[m_next_queue];
+    m_next_queue = (m_next_queue + 1) % m_queues.size();
+
+    {
+        std::lock_guard<std::mutex> queue_lock (queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    m_queued++;
+    m_pending++;
+    m_work_cv.notify_one();
+}
+
+void gb_thread_pool::wait() {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_done_cv.wait(lock, [this] { return m_pending == 0; });
+}
+
+unsigned int gb_thread_pool::get_num_threads() const {
+    return static_cast<unsigned int>(m_threads.size());
+}
+
+bool gb_thread_pool::_pop(unsigned int id, task_t& task) {
+    // Own queue first (LIFO), then try to steal from everyone else (FIFO) starting with the next worker
+    for (size_t i = 0; i < m_queues.size(); i++) {
+        gb_task_queue_t& queue = *m_queues[(id + i) % m_queues.size()];
+        std::lock_guard<std::mutex> queue_lock (queue.mutex);
+
+        if (queue.tasks.empty()) continue;
+
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+void gb_thread_pool::_worker(unsigned int id) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock (m_mutex);
+            m_work_cv.wait(lock, [this] { return m_stop || m_queued > 0; });
+            if (m_queued == 0) return;
+            m_queued--;
+        }
+
+        // A task was counted for this worker so one of the queues is guaranteed to hold one
+        task_t task;
+        while (!_pop(id, task)) std::this_thread::yield();
+
+        task();
+
+        std::lock_guard<std::mutex> lock (m_mutex);
+        if (--m_pending == 0) m_done_cv.notify_all();
+    }
+}
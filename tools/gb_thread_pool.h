@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef GB_THREAD_POOL_H_
+#define GB_THREAD_POOL_H_
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// A work-stealing thread pool. Each worker has its own queue; submitted tasks are spread across the queues
+// round-robin. Workers take tasks from the back of their own queue and steal from the front of the other
+// workers' queues when their own runs dry so long running tasks don't leave cores idle
+class gb_thread_pool {
+public:
+    using task_t = std::function<void()>;
+
+    gb_thread_pool(unsigned int num_threads);
+    ~gb_thread_pool();
+
+    // Queue a task. Tasks must not throw
+    void submit(task_t task);
+
+    // Block until every submitted task has completed
+    void wait();
+
+    unsigned int get_num_threads() const;
+
+private:
+    struct gb_task_queue_t {
+        std::mutex         mutex;
+        std::deque<task_t> tasks;
+    };
+
+    using gb_task_queue_ptr = std::unique_ptr<gb_task_queue_t>;
+
+    std::vector<gb_task_queue_ptr> m_queues;
+    std::vector<std::thread>       m_threads;
+
+    // Protects the counters below. m_queued counts tasks sitting in a queue, m_pending counts tasks not yet completed
+    std::mutex                     m_mutex;
+    std::condition_variable        m_work_cv;
+    std::condition_variable        m_done_cv;
+    unsigned long                  m_queued;
+    unsigned long                  m_pending;
+    unsigned long                  m_next_queue;
+    bool                           m_stop;
+
+    void _worker(unsigned int id);
+    bool _pop(unsigned int id, task_t& task);
+};
+
+#endif // GB_THREAD_POOL_H_
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <unistd.h>
+
+#include "gb_batch.h"
+#include "gb_thread_pool.h"
+
+static void _print_usage(const char* program_name) {
+    std::cout << "usage: " << program_name << " [options] manifest" << std::endl
+              << std::endl << "Options and arguments:" << std::endl
+              << "-h          : Print this help and exit" << std::endl
+              << "-j threads  : Number of worker threads (default: number of cores)" << std::endl
+              << "-o file     : Write the JSON lines report to a file instead of stdout" << std::endl
+              << "manifest    : One job per line: <rom_file> <input_script|-> <frames>" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    unsigned int num_threads = std::thread::hardware_concurrency();
+    std::string output_filename;
+
+    for (int c = 0; (c = getopt(argc, argv, "hj:o:")) != -1; ) {
+        switch (c) {
+            case 'j':
+                try {
+                    num_threads = static_cast<unsigned int>(std::stoul(optarg));
+                } catch (const std::exception& e) {
+                    std::cerr << argv[0] << ": invalid number of threads '" << optarg << "'" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'o': output_filename = optarg; break;
+            case 'h': _print_usage(argv[0]); return EXIT_SUCCESS;
+            default: _print_usage(argv[0]); return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc) {
+        std::cerr << argv[0] << ": 'manifest' must be specified" << std::endl;
+        _print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<gb_batch::gb_batch_job_t> jobs;
+    try {
+        jobs = gb_batch::load_manifest(argv[optind]);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Every job writes only to its own result so no locking is needed
+    std::vector<gb_batch::gb_batch_result_t> results (jobs.size());
+    auto start = std::chrono::steady_clock::now();
+
+    {
+        gb_thread_pool pool (num_threads);
+
+        for (size_t i = 0; i < jobs.size(); i++) {
+            pool.submit([&jobs, &results, i] { results[i] = gb_batch::run_job(jobs[i]); });
+        }
+
+        pool.wait();
+        num_threads = pool.get_num_threads();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream output_file;
+    if (!output_filename.empty()) {
+        output_file.open(output_filename);
+        if (!output_file) {
+            std::cerr << argv[0] << ": can't open '" << output_filename << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ostream& os = output_filename.empty() ? std::cout : output_file;
+    uint64_t total_frames = 0;
+    size_t failed = 0;
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+        gb_batch::write_json(os, i, jobs[i], results[i]);
+        total_frames += results[i].frames;
+        if (!results[i].error.empty()) failed++;
+    }
+
+    std::cerr << jobs.size() << " jobs (" << failed << " failed), " << total_frames << " frames in " << seconds << "s on "
+              << num_threads << " threads: " << (seconds > 0.0 ? static_cast<double>(total_frames) / seconds : 0.0) << " frames/s" << std::endl;
+
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
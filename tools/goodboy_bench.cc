@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "gb_bench.h"
+
+#define GB_BENCH_DEFAULT_FRAMES (3600)
+#define GB_BENCH_DEFAULT_WARMUP (60)
+
+static void _print_usage(const char* program_name) {
+    std::cout << "usage: " << program_name << " [options] rom_file" << std::endl
+              << std::endl << "Options and arguments:" << std::endl
+              << "-h          : Print this help and exit" << std::endl
+              << "-n frames   : Number of frames to time (default: " << GB_BENCH_DEFAULT_FRAMES << ", or the rest of the movie with -i)" << std::endl
+              << "-w frames   : Number of frames to run before timing starts (default: " << GB_BENCH_DEFAULT_WARMUP << ")" << std::endl
+              << "-i movie    : Play back a movie recorded with --record, starting from its start state" << std::endl
+              << "-o file     : Write the JSON report to a file instead of stdout" << std::endl
+              << "rom_file    : Gameboy program to run" << std::endl;
+}
+
+static bool _parse_frames(const char* program_name, const char* arg, uint64_t& frames) {
+    try {
+        frames = std::stoull(std::string(arg), nullptr, 0);
+    } catch (const std::exception& e) {
+        std::cerr << program_name << ": invalid number of frames '" << arg << "'" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    gb_bench::gb_bench_config_t config = {std::string(), std::string(), 0, GB_BENCH_DEFAULT_WARMUP};
+    bool frames_set = false;
+    std::string output_filename;
+
+    for (int c = 0; (c = getopt(argc, argv, "hn:w:i:o:")) != -1; ) {
+        switch (c) {
+            case 'n':
+                if (!_parse_frames(argv[0], optarg, config.num_frames)) return EXIT_FAILURE;
+                frames_set = true;
+                break;
+            case 'w':
+                if (!_parse_frames(argv[0], optarg, config.warmup_frames)) return EXIT_FAILURE;
+                break;
+            case 'i': config.movie_filename = optarg; break;
+            case 'o': output_filename = optarg; break;
+            case 'h': _print_usage(argv[0]); return EXIT_SUCCESS;
+            default: _print_usage(argv[0]); return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc) {
+        std::cerr << argv[0] << ": 'rom_file' must be specified" << std::endl;
+        _print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    config.rom_filename = argv[optind];
+    if (!frames_set && config.movie_filename.empty()) config.num_frames = GB_BENCH_DEFAULT_FRAMES;
+
+    gb_bench::gb_bench_result_t result;
+    try {
+        result = gb_bench::run(config);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ofstream output_file;
+    if (!output_filename.empty()) {
+        output_file.open(output_filename);
+        if (!output_file) {
+            std::cerr << argv[0] << ": can't open '" << output_filename << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    gb_bench::write_json(output_filename.empty() ? std::cout : output_file, config, result);
+
+    std::cerr << result.frames << " frames in " << result.seconds << "s: "
+              << (result.seconds > 0.0 ? static_cast<double>(result.frames) / result.seconds : 0.0) << " frames/s, p50 "
+              << result.frame_ns_p50 << "ns, p99 " << result.frame_ns_p99 << "ns per frame" << std::endl;
+
+    return EXIT_SUCCESS;
+}
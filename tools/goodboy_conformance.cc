@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <unistd.h>
+
+#include "gb_conformance.h"
+#include "gb_thread_pool.h"
+#include "gb_io_defs.h"
+
+#define GB_CONFORMANCE_DEFAULT_TIMEOUT (120)
+
+static void _print_usage(const char* program_name) {
+    std::cout << "usage: " << program_name << " [options] path..." << std::endl
+              << std::endl << "Options and arguments:" << std::endl
+              << "-h          : Print this help and exit" << std::endl
+              << "-j threads  : Number of worker threads (default: number of cores)" << std::endl
+              << "-t seconds  : Emulated time after which a test counts as hung (default: " << GB_CONFORMANCE_DEFAULT_TIMEOUT << ")" << std::endl
+              << "-o file     : Write the JSON lines report to a file instead of stdout" << std::endl
+              << "-x file     : Write a JUnit XML report to a file" << std::endl
+              << "path        : Test ROM or a directory to search for .gb and .gbc files" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    unsigned int num_threads = std::thread::hardware_concurrency();
+    unsigned long timeout = GB_CONFORMANCE_DEFAULT_TIMEOUT;
+    std::string output_filename, junit_filename;
+
+    for (int c = 0; (c = getopt(argc, argv, "hj:t:o:x:")) != -1; ) {
+        switch (c) {
+            case 'j':
+                try {
+                    num_threads = static_cast<unsigned int>(std::stoul(optarg));
+                } catch (const std::exception& e) {
+                    std::cerr << argv[0] << ": invalid number of threads '" << optarg << "'" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 't':
+                try {
+                    timeout = std::stoul(optarg);
+                } catch (const std::exception& e) {
+                    std::cerr << argv[0] << ": invalid timeout '" << optarg << "'" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'o': output_filename = optarg; break;
+            case 'x': junit_filename = optarg; break;
+            case 'h': _print_usage(argv[0]); return EXIT_SUCCESS;
+            default: _print_usage(argv[0]); return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc) {
+        std::cerr << argv[0] << ": 'path' must be specified" << std::endl;
+        _print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::string> roms;
+    try {
+        for (int i = optind; i < argc; i++) {
+            std::vector<std::string> found = gb_conformance::find_roms(argv[i]);
+            roms.insert(roms.end(), found.begin(), found.end());
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The timeout is in emulated time so whether a test hangs doesn't depend on how busy the machine is
+    uint64_t max_frames = static_cast<uint64_t>(timeout) * CLOCK_SPEED / 70224;
+
+    // Every test writes only to its own result so no locking is needed
+    std::vector<gb_conformance::gb_test_result_t> results (roms.size());
+    auto start = std::chrono::steady_clock::now();
+
+    {
+        gb_thread_pool pool (num_threads);
+
+        for (size_t i = 0; i < roms.size(); i++) {
+            pool.submit([&roms, &results, i, max_frames] { results[i] = gb_conformance::run_test(roms[i], max_frames); });
+        }
+
+        pool.wait();
+        num_threads = pool.get_num_threads();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream output_file;
+    if (!output_filename.empty()) {
+        output_file.open(output_filename);
+        if (!output_file) {
+            std::cerr << argv[0] << ": can't open '" << output_filename << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ostream& os = output_filename.empty() ? std::cout : output_file;
+    size_t counts[4] = {0, 0, 0, 0};
+
+    for (size_t i = 0; i < roms.size(); i++) {
+        gb_conformance::write_json(os, roms[i], results[i]);
+        counts[results[i].status]++;
+    }
+
+    if (!junit_filename.empty()) {
+        std::ofstream junit_file (junit_filename);
+        if (!junit_file) {
+            std::cerr << argv[0] << ": can't open '" << junit_filename << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+        gb_conformance::write_junit(junit_file, roms, results, seconds);
+    }
+
+    std::cerr << roms.size() << " tests: " << counts[gb_conformance::GB_STATUS_PASS] << " passed, " << counts[gb_conformance::GB_STATUS_FAIL] << " failed, "
+              << counts[gb_conformance::GB_STATUS_HANG] << " hung, " << counts[gb_conformance::GB_STATUS_ERROR] << " errors in " << seconds << "s on "
+              << num_threads << " threads" << std::endl;
+
+    return (counts[gb_conformance::GB_STATUS_PASS] == roms.size()) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2019 Sekhar Bhattacharya
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "gb_regress.h"
+#include "gb_thread_pool.h"
+
+#define GB_REGRESS_DEFAULT_INTERVAL (60)
+#define GB_REGRESS_DEFAULT_DIFF_DIR "regress-diffs"
+
+static void _print_usage(const char* program_name) {
+    std::cout << "usage: " << program_name << " [options] manifest golden_dir" << std::endl
+              << std::endl << "Options and arguments:" << std::endl
+              << "-h          : Print this help and exit" << std::endl
+              << "-j threads  : Number of worker threads (default: number of cores)" << std::endl
+              << "-c frames   : Frames between checkpoints (default: " << GB_REGRESS_DEFAULT_INTERVAL << ")" << std::endl
+              << "-u          : Record new golden frames instead of comparing against them" << std::endl
+              << "-d dir      : Where to write the PNGs of mismatching frames (default: " GB_REGRESS_DEFAULT_DIFF_DIR ")" << std::endl
+              << "-o file     : Write the JSON lines report to a file instead of stdout" << std::endl
+              << "manifest    : One job per line: <rom_file> <input_script|movie.gbm|-> <frames>" << std::endl
+              << "golden_dir  : Directory holding golden.txt and the PNGs of the golden frames" << std::endl;
+}
+
+static bool _make_dir(const std::string& dir) {
+    return mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+int main(int argc, char **argv) {
+    unsigned int num_threads = std::thread::hardware_concurrency();
+    gb_regress::gb_regress_config_t config = {std::string(), GB_REGRESS_DEFAULT_DIFF_DIR, GB_REGRESS_DEFAULT_INTERVAL, false};
+    std::string output_filename;
+
+    for (int c = 0; (c = getopt(argc, argv, "hj:c:ud:o:")) != -1; ) {
+        switch (c) {
+            case 'j':
+                try {
+                    num_threads = static_cast<unsigned int>(std::stoul(optarg));
+                } catch (const std::exception& e) {
+                    std::cerr << argv[0] << ": invalid number of threads '" << optarg << "'" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'c':
+                try {
+                    config.interval = std::stoull(optarg);
+                } catch (const std::exception& e) {
+                    config.interval = 0;
+                }
+
+                if (config.interval == 0) {
+                    std::cerr << argv[0] << ": invalid checkpoint interval '" << optarg << "'" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'u': config.update = true; break;
+            case 'd': config.diff_dir = optarg; break;
+            case 'o': output_filename = optarg; break;
+            case 'h': _print_usage(argv[0]); return EXIT_SUCCESS;
+            default: _print_usage(argv[0]); return EXIT_FAILURE;
+        }
+    }
+
+    if (optind + 1 >= argc) {
+        std::cerr << argv[0] << ": 'manifest' and 'golden_dir' must be specified" << std::endl;
+        _print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    config.golden_dir = argv[optind + 1];
+
+    std::vector<gb_batch::gb_batch_job_t> jobs;
+    gb_regress::gb_golden_map_t golden;
+    try {
+        jobs = gb_batch::load_manifest(argv[optind]);
+        // Updating only records the jobs in this manifest, the other jobs' golden frames are kept
+        golden = gb_regress::load_golden(config.golden_dir);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Golden frames are looked up by name so two jobs with the same ROM and input would overwrite each other's
+    std::set<std::string> names;
+    for (const gb_batch::gb_batch_job_t& job : jobs) {
+        if (!names.insert(gb_regress::get_name(job)).second) {
+            std::cerr << argv[0] << ": more than one job named '" << gb_regress::get_name(job) << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const std::string& dir = config.update ? config.golden_dir : config.diff_dir;
+    if (!_make_dir(dir)) {
+        std::cerr << argv[0] << ": can't create '" << dir << "'" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Every job writes only to its own result so no locking is needed
+    std::vector<gb_regress::gb_regress_result_t> results (jobs.size());
+    auto start = std::chrono::steady_clock::now();
+
+    {
+        gb_thread_pool pool (num_threads);
+
+        for (size_t i = 0; i < jobs.size(); i++) {
+            auto it = golden.find(gb_regress::get_name(jobs[i]));
+            const gb_regress::gb_golden_frames_t* job_golden = (it != golden.end()) ? &it->second : nullptr;
+
+            pool.submit([&jobs, &results, &config, i, job_golden] { results[i] = gb_regress::run_job(jobs[i], job_golden, config); });
+        }
+
+        pool.wait();
+        num_threads = pool.get_num_threads();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream output_file;
+    if (!output_filename.empty()) {
+        output_file.open(output_filename);
+        if (!output_file) {
+            std::cerr << argv[0] << ": can't open '" << output_filename << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ostream& os = output_filename.empty() ? std::cout : output_file;
+    uint64_t checkpoints = 0, mismatches = 0, missing = 0;
+    size_t failed = 0;
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+        gb_regress::write_json(os, jobs[i], results[i]);
+        checkpoints += results[i].checkpoints.size();
+        mismatches += results[i].mismatches;
+        missing += results[i].missing;
+        if (!results[i].error.empty()) failed++;
+    }
+
+    if (config.update) {
+        // A failed job would leave its golden frames incomplete so nothing is recorded unless every job ran
+        if (failed != 0) {
+            std::cerr << argv[0] << ": " << failed << " jobs failed, golden frames not updated" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        for (size_t i = 0; i < jobs.size(); i++) {
+            gb_regress::gb_golden_frames_t& job_golden = golden[gb_regress::get_name(jobs[i])];
+            job_golden.clear();
+            for (const gb_regress::gb_checkpoint_t& checkpoint : results[i].checkpoints) job_golden[checkpoint.frame] = checkpoint.hash;
+        }
+
+        try {
+            gb_regress::save_golden(config.golden_dir, golden);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::cerr << jobs.size() << " jobs, " << checkpoints << " golden frames recorded in " << seconds << "s on " << num_threads << " threads" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::cerr << jobs.size() << " jobs (" << failed << " failed), " << checkpoints << " checkpoints: " << mismatches << " mismatched, "
+              << missing << " missing in " << seconds << "s on " << num_threads << " threads" << std::endl;
+
+    return (failed == 0 && mismatches == 0 && missing == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}